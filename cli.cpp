@@ -0,0 +1,441 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <stdexcept>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include "gear.h"
+#include "gearpair.h"
+#include "gearexport.h"
+#include "meshlib.h"
+#include "interference.h"
+#include "transmission.h"
+#include "trace.h"
+#include "cli.h"
+
+namespace {
+
+const char *usage =
+    "usage: gear                                   run the simulator\n"
+    "       gear --export file.stl|obj|ply --teeth N [--pa degrees] [--approx]\n"
+    "            [--thickness dZ] [--stream] [--helix degrees [--slices K]]\n"
+    "       gear --prebuild-library dir [--teeth N,N,...]\n"
+    "            writes memory mapped meshes for the GUI to load, see GEAR_LIBRARY\n"
+    "       gear --batch N[-M[:step]][,...] [--pa degrees,...] [--approx|--both]\n"
+    "            [--threads n] [--out dir] [--format stl|obj|ply] [--thickness dZ] [--budget MB]\n"
+    "            builds every combination in parallel and prints stats for each gear,\n"
+    "            gears over the budget are built coarse, or skipped if that's still over\n"
+    "       gear --memory --teeth Na,Nb [--pa degrees] [--approx] [--budget MB]\n"
+    "            bytes the pair costs on the CPU and GPU and at the peak of building it\n"
+    "       gear --interference --teeth Na,Nb [--pa degrees] [--approx] [--separation d]\n"
+    "            sweeps the pair through one pitch and reports where the profiles overlap\n"
+    "       gear --transmission --teeth Na,Nb [--pa degrees] [--approx] [--separation d]\n"
+    "            [--samples n] [--threads n]\n"
+    "            transmission error, its spectrum, contact ratio and backlash from the profiles\n"
+    "       gear --record events.log | --replay events.log [--timings frames.csv]\n"
+    "            the simulator, logging its input, or driving a logged session frame by frame\n"
+    "            against a virtual clock, printing the paint times and quitting at the end\n"
+    "       --trace file   with a CONFIG+=trace build, writes a Chrome trace on exit\n";
+
+// more would overflow the meshes' 32 bit indices long before they fitted in memory
+const unsigned long maxTeeth = 1000000;
+
+// one tooth count, std::stoul reads "-1" as ULONG_MAX so the range is checked here
+unsigned int toTeeth(const std::string &s)
+{
+    const unsigned long N = std::stoul(s);
+    if(N > maxTeeth) throw std::out_of_range("tooth count " + s);
+    return static_cast<unsigned int>(N);
+}
+
+// a budget in MB, casting a negative or huge double to size_t is undefined, and a
+// tiny one would round to 0, which is no budget at all
+std::size_t toBytes(const std::string &s)
+{
+    const double bytes = std::stod(s) * 1024.0 * 1024.0;
+    if(!(bytes >= 1.0) || bytes >= (double) SIZE_MAX) throw std::out_of_range("budget " + s);
+    return static_cast<std::size_t>(bytes);
+}
+
+float radians(float deg)
+{
+    return static_cast<float>(deg * 3.14159265358979323846 / 180.0);
+}
+
+// write one gear, streamed a sector at a time when asked or when it's big
+int cliExport(const std::string &fileName, unsigned int N, float paDeg, bool bExact, float dZ, bool bStream,
+              float helixDeg, unsigned int K)
+{
+    meshFormat fmt;
+    if(!formatFromName(fileName, fmt)){
+        std::cerr << "can't tell the format of " << fileName << ", use .stl, .obj or .ply" << std::endl;
+        return 1;
+    }
+    if(N < 6){
+        std::cerr << "need 6 or more teeth" << std::endl;
+        return 1;
+    }
+    bool bOk;
+    if(helixDeg != 0.0f){
+        if(std::fabs(helixDeg) >= 80.0f){
+            std::cerr << "helix angle must be less than 80 degrees" << std::endl;
+            return 1;
+        }
+        bOk = exportHelical(N, radians(paDeg), bExact, dZ, radians(helixDeg), K, fmt, fileName);
+    }
+    else if(bStream || N >= 1000) bOk = exportGearStream(N, radians(paDeg), bExact, dZ, fmt, fileName);
+    else if(bExact){
+        gear g(N, radians(paDeg), dZ);
+        bOk = exportGear(g, fmt, fileName);
+    }
+    else{
+        gearApprox g(N, radians(paDeg), dZ);
+        bOk = exportGear(g, fmt, fileName);
+    }
+    if(!bOk) std::cerr << "failed writing " << fileName << std::endl;
+    return bOk ? 0 : 1;
+}
+
+// the catalogue, or a comma separated list of tooth counts
+int cliPrebuild(const std::string &dir, const std::string &teethList)
+{
+    std::vector<unsigned int> teeth;
+    if(teethList.empty()) teeth = meshLibCatalogue();
+    else{
+        std::istringstream is(teethList);
+        std::string item;
+        try{
+            while(std::getline(is, item, ',')) teeth.push_back(toTeeth(item));
+        }
+        catch(const std::exception &){
+            std::cerr << "bad tooth count list " << teethList << std::endl;
+            return 1;
+        }
+    }
+    for(auto N: teeth){
+        if(N < 6){
+            std::cerr << "need 6 or more teeth" << std::endl;
+            return 1;
+        }
+    }
+    const int count = meshLibPrebuild(dir, teeth, std::cout);
+    return count == static_cast<int>(teeth.size() * 6) ? 0 : 1;
+}
+
+// one gear of a batch, and what building it gave
+struct batchJob
+{
+    unsigned int N;
+    float paDeg;
+    bool bExact;
+    unsigned int nVerts = 0, nTris = 0;
+    float rmaj = 0.0f, rmin = 0.0f;
+    double ms = 0.0;
+    bool bWritten = false;
+    gearDetail detail = gearDetail::fine;
+    bool bOverBudget = false; // not built
+    std::size_t bytes = 0; // gear::GetBytes
+};
+
+// comma separated numbers, each one N, a range N-M or a stepped range N-M:step
+bool parseTeeth(const std::string &spec, std::vector<unsigned int> &teeth)
+{
+    std::istringstream is(spec);
+    std::string item;
+    try{
+        while(std::getline(is, item, ',')){
+            const std::size_t dash = item.find('-'), colon = item.find(':');
+            const unsigned long first = toTeeth(item);
+            unsigned long last = first, step = 1;
+            if(dash != std::string::npos) last = toTeeth(item.substr(dash + 1));
+            if(colon != std::string::npos) step = std::stoul(item.substr(colon + 1));
+            if(last < first || step == 0) return false;
+            for(unsigned long N=first; N<=last; N+=step) teeth.push_back(static_cast<unsigned int>(N));
+        }
+    }
+    catch(const std::exception &){
+        return false;
+    }
+    return !teeth.empty();
+}
+
+bool parseFloats(const std::string &list, std::vector<float> &x)
+{
+    std::istringstream is(list);
+    std::string item;
+    try{
+        while(std::getline(is, item, ',')) x.push_back(std::stof(item));
+    }
+    catch(const std::exception &){
+        return false;
+    }
+    return !x.empty();
+}
+
+void runJob(batchJob &job, float dZ, const std::string &outDir, meshFormat fmt, std::size_t budget)
+{
+    static const char *ext[] = {"stl", "obj", "ply"};
+    if(budget && gearBytes(job.N) > budget){
+        job.detail = gearDetail::coarse;
+        if(gearBytes(job.N, gearBuild::full, job.detail) > budget){
+            job.bOverBudget = true;
+            return;
+        }
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    std::unique_ptr<gear> g;
+
+    if(job.bExact) g = std::make_unique<gear>(job.N, radians(job.paDeg), dZ, gearBuild::full, job.detail);
+    else g = std::make_unique<gearApprox>(job.N, radians(job.paDeg), dZ, gearBuild::full, job.detail);
+    job.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    job.bytes = g -> GetBytes();
+    job.nVerts = g -> GetNverts();
+    job.nTris = g -> GetNInds() / 3;
+    job.rmaj = g -> GetRmaj();
+    job.rmin = g -> GetRmin();
+    if(!outDir.empty()){
+        std::ostringstream os;
+        os << outDir << '/' << (job.bExact ? "exact_" : "approx_") << job.N << '_' << job.paDeg << '.' << ext[static_cast<int>(fmt)];
+        job.bWritten = exportGear(*g, fmt, os.str());
+    }
+}
+
+// every combination of teeth, pressure angle and profile, shared out over the threads
+int cliBatch(const std::string &teethSpec, const std::string &paList, int profiles, unsigned int nThreads,
+             float dZ, const std::string &outDir, const std::string &formatName, std::size_t budget)
+{
+    std::vector<unsigned int> teeth;
+    std::vector<float> pas;
+    if(!parseTeeth(teethSpec, teeth)){
+        std::cerr << "bad tooth count range " << teethSpec << std::endl;
+        return 1;
+    }
+    if(!parseFloats(paList, pas)){
+        std::cerr << "bad pressure angle list " << paList << std::endl;
+        return 1;
+    }
+    meshFormat fmt = meshFormat::stl;
+    if(!outDir.empty() && !formatFromName("." + formatName, fmt)){
+        std::cerr << "unknown format " << formatName << ", use stl, obj or ply" << std::endl;
+        return 1;
+    }
+    std::vector<batchJob> jobs;
+    for(auto N: teeth){
+        if(N < 6){
+            std::cerr << "need 6 or more teeth" << std::endl;
+            return 1;
+        }
+        for(auto paDeg: pas){
+            if(profiles & 1) jobs.push_back(batchJob{N, paDeg, true});
+            if(profiles & 2) jobs.push_back(batchJob{N, paDeg, false});
+        }
+    }
+    if(nThreads == 0) nThreads = std::max(1u, std::thread::hardware_concurrency());
+    nThreads = std::min<unsigned int>(nThreads, jobs.size());
+
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]{
+        for(std::size_t i=next++; i<jobs.size(); i=next++) runJob(jobs[i], dZ, outDir, fmt, budget);
+    };
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for(unsigned int i=1; i<nThreads; ++i) pool.emplace_back(worker);
+    worker();
+    for(auto &t: pool) t.join();
+    const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    int failures = 0, skipped = 0;
+    char line[200];
+    std::printf("%-7s %7s %6s %7s %10s %10s %10s %10s %11s %11s\n", "profile", "N", "pa", "detail", "vertices", "triangles",
+                "rmaj", "rmin", "build ms", "KB");
+    for(const auto &job: jobs){
+        const char *profile = job.bExact ? "exact" : "approx";
+        if(job.bOverBudget){
+            std::snprintf(line, sizeof(line), "%-7s %7u %6.1f    over budget, %.0f KB coarse", profile, job.N, job.paDeg,
+                          gearBytes(job.N, gearBuild::full, gearDetail::coarse) / 1024.0);
+            std::puts(line);
+            ++skipped;
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-7s %7u %6.1f %7s %10u %10u %10.4f %10.4f %11.3f %11.1f", profile, job.N, job.paDeg,
+                      job.detail == gearDetail::coarse ? "coarse" : "fine", job.nVerts, job.nTris, job.rmaj, job.rmin, job.ms,
+                      job.bytes / 1024.0);
+        std::puts(line);
+        if(!outDir.empty() && !job.bWritten) ++failures;
+    }
+    if(skipped) std::printf("%d gears over the budget of %.1f MB weren't built\n", skipped, budget / (1024.0 * 1024.0));
+    std::printf("%zu gears on %u threads in %.1f ms\n", jobs.size(), nThreads, wallMs);
+    if(failures) std::cerr << "failed writing " << failures << " meshes to " << outDir << std::endl;
+    return failures ? 1 : 0;
+}
+
+// tooth templates of a pair given as Na,Nb, all the profile analyses need
+bool templatePair(const char *option, const std::string &teethList, float paDeg, bool bExact,
+                  std::unique_ptr<gear> &ga, std::unique_ptr<gear> &gb)
+{
+    std::vector<unsigned int> teeth;
+    if(!parseTeeth(teethList, teeth) || teeth.size() != 2 || teeth[0] < 6 || teeth[1] < 6){
+        std::cerr << option << " needs --teeth Na,Nb, each 6 or more" << std::endl;
+        return false;
+    }
+    if(bExact){
+        ga = std::make_unique<gear>(teeth[0], radians(paDeg), 5.0f, gearBuild::sectors);
+        gb = std::make_unique<gear>(teeth[1], radians(paDeg), 5.0f, gearBuild::sectors);
+    }
+    else{
+        ga = std::make_unique<gearApprox>(teeth[0], radians(paDeg), 5.0f, gearBuild::sectors);
+        gb = std::make_unique<gearApprox>(teeth[1], radians(paDeg), 5.0f, gearBuild::sectors);
+    }
+    return true;
+}
+
+// the overlap sweep the GUI shows
+int cliInterference(const std::string &teethList, float paDeg, bool bExact, float separation)
+{
+    std::unique_ptr<gear> ga, gb;
+    if(!templatePair("--interference", teethList, paDeg, bExact, ga, gb)) return 1;
+    const interferenceReport r = findInterference(*ga, *gb, 240, separation);
+    std::cout << interferenceSummary(r) << '\n' << interferenceDetail(r) << std::endl;
+    return 0;
+}
+
+// what the GUI's rebuild of the pair costs, worked out then measured, for both mesh densities
+int cliMemory(const std::string &teethList, float paDeg, bool bExact, std::size_t budget)
+{
+    std::vector<unsigned int> teeth;
+    if(!parseTeeth(teethList, teeth) || teeth.size() != 2 || teeth[0] < 6 || teeth[1] < 6){
+        std::cerr << "--memory needs --teeth Na,Nb, each 6 or more" << std::endl;
+        return 1;
+    }
+    const double KB = 1.0 / 1024.0;
+    std::printf("%-7s %12s %12s %12s %12s %12s %12s %12s\n", "detail", "gear a KB", "gear b KB", "pair KB", "GPU KB", "peak KB", "estimate KB",
+                "pick bvhs KB");
+    for(gearDetail detail: {gearDetail::fine, gearDetail::coarse}){
+        const gearPair pair = buildGearPair(teeth[0], teeth[1], radians(paDeg), bExact, detail);
+        const pairMemory m = estimatePairMemory(teeth[0], teeth[1], detail);
+        std::printf("%-7s %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", detail == gearDetail::fine ? "fine" : "coarse",
+                    pair.bytes_a * KB, pair.bytes_b * KB, pair.bytes() * KB, pair.gpuBytes() * KB, pair.peakBytes * KB, m.peak * KB,
+                    m.pick * KB);
+    }
+    if(!budget) return 0;
+    // as the GUI, a rebuild with both profiles' buffers on the GPU and their bvhs, the mesh
+    // cache's quarter share and a speculative build aside, see Widget::budgetHeld()
+    gearDetail detail = gearDetail::fine;
+    const bool bFits = fitMemoryBudget(teeth[0], teeth[1], budget, 2, detail,
+                                       budget / 4 + estimatePairMemory(teeth[0], teeth[1], detail).peak);
+    if(!bFits) std::printf("over the budget of %.1f MB even as coarse meshes\n", budget * KB * KB);
+    else std::printf("fits the budget of %.1f MB as %s meshes\n", budget * KB * KB, detail == gearDetail::fine ? "fine" : "coarse");
+    return bFits ? 0 : 1;
+}
+
+int cliTransmission(const std::string &teethList, float paDeg, bool bExact, const transmissionOptions &opt)
+{
+    std::unique_ptr<gear> ga, gb;
+    if(!templatePair("--transmission", teethList, paDeg, bExact, ga, gb)) return 1;
+    const transmissionReport r = sweepTransmission(*ga, *gb, opt);
+    std::cout << transmissionDetail(r) << std::endl;
+    return r.bJammed ? 1 : 0;
+}
+
+}
+
+bool runCli(int argc, char *argv[], int &exitCode)
+{
+    std::string exportFile, traceFile, libraryDir, teethList, batchSpec, paList = "20", outDir, formatName = "stl";
+    unsigned int N = 0;
+    float paDeg = 20.0f, dZ = 5.0f, helixDeg = 0.0f;
+    unsigned int slices = 0;
+    bool bExact = true, bStream = false, bHelp = false, bInterference = false, bTransmission = false, bMemory = false;
+    std::size_t budget = 0; // bytes, 0 unlimited
+    float separation = 0.0f;
+    transmissionOptions transOpt;
+    int profiles = 1; // bit 0 exact, bit 1 approximation
+    unsigned int nThreads = 0;
+
+    if(argc < 2) return false;
+    try{
+        for(int i=1; i<argc; ++i){
+            const std::string arg = argv[i];
+            const bool bValue = i + 1 < argc;
+            if(arg == "--export" && bValue) exportFile = argv[++i];
+            else if(arg == "--teeth" && bValue){
+                teethList = argv[++i];
+                N = toTeeth(teethList);
+            }
+            else if(arg == "--prebuild-library" && bValue) libraryDir = argv[++i];
+            else if(arg == "--pa" && bValue){
+                paList = argv[++i];
+                paDeg = std::stof(paList);
+            }
+            else if(arg == "--thickness" && bValue) dZ = std::stof(argv[++i]);
+            else if(arg == "--helix" && bValue) helixDeg = std::stof(argv[++i]);
+            else if(arg == "--slices" && bValue) slices = std::stoul(argv[++i]);
+            else if(arg == "--approx"){
+                bExact = false;
+                profiles = 2;
+            }
+            else if(arg == "--both") profiles = 3;
+            else if(arg == "--interference") bInterference = true;
+            else if(arg == "--transmission") bTransmission = true;
+            else if(arg == "--memory") bMemory = true;
+            else if(arg == "--budget" && bValue) budget = toBytes(argv[++i]);
+            else if(arg == "--samples" && bValue) transOpt.samples = std::stoul(argv[++i]);
+            else if(arg == "--separation" && bValue) separation = std::stof(argv[++i]);
+            else if(arg == "--batch" && bValue) batchSpec = argv[++i];
+            else if(arg == "--threads" && bValue) nThreads = std::stoul(argv[++i]);
+            else if(arg == "--out" && bValue) outDir = argv[++i];
+            else if(arg == "--format" && bValue) formatName = argv[++i];
+            else if(arg == "--stream") bStream = true;
+            else if(arg == "--trace" && bValue) traceFile = argv[++i];
+            else if((arg == "--record" || arg == "--replay" || arg == "--timings") && bValue) ++i; // the simulator's, see main.cpp
+            else if(arg == "--help" || arg == "-h") bHelp = true;
+            else if(arg.compare(0, 2, "--") == 0){
+                std::cerr << "unknown option " << arg << '\n' << usage;
+                exitCode = 1;
+                return true;
+            }
+            // anything else is left for Qt, e.g. -platform
+        }
+    }
+    catch(const std::out_of_range &){
+        std::cerr << "number out of range in arguments, tooth counts go up to " << maxTeeth
+                  << " and budgets must be over 0\n" << usage;
+        exitCode = 1;
+        return true;
+    }
+    catch(const std::exception &){
+        std::cerr << "bad number in arguments\n" << usage;
+        exitCode = 1;
+        return true;
+    }
+    if(bHelp){
+        std::cout << usage;
+        exitCode = 0;
+        return true;
+    }
+    if(bTransmission){
+        transOpt.separation = separation;
+        transOpt.threads = nThreads;
+        exitCode = cliTransmission(teethList, paDeg, bExact, transOpt);
+    }
+    else if(bMemory) exitCode = cliMemory(teethList, paDeg, bExact, budget);
+    else if(bInterference) exitCode = cliInterference(teethList, paDeg, bExact, separation);
+    else if(!batchSpec.empty()) exitCode = cliBatch(batchSpec, paList, profiles, nThreads, dZ, outDir, formatName, budget);
+    else if(!libraryDir.empty()) exitCode = cliPrebuild(libraryDir, teethList);
+    else if(!exportFile.empty()) exitCode = cliExport(exportFile, N, paDeg, bExact, dZ, bStream, helixDeg, slices);
+    else return false; // the simulator, it writes the trace itself
+
+    if(!traceFile.empty()) traceWrite(traceFile);
+    return true;
+}
@@ -0,0 +1,13 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef CLI_H
+#define CLI_H
+
+// Command line use which needs no QApplication, widgets or OpenGL.
+// Returns false when the arguments are for the GUI, otherwise does
+// the work and puts the process's exit code in exitCode.
+bool runCli(int argc, char *argv[], int &exitCode);
+
+#endif // CLI_H
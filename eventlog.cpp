@@ -0,0 +1,95 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <numeric>
+#include "eventlog.h"
+
+static const char *logHeader = "# gear event log 1, t kind a b c d value";
+
+void eventLog::startRecording()
+{
+    log.clear();
+    cursor = 0;
+    start = std::chrono::steady_clock::now();
+    bRecording = true;
+}
+
+void eventLog::add(char kind, int a, int b, int c, int d, double value)
+{
+    if(!bRecording) return;
+    inputEvent e;
+    e.t = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    e.kind = kind;
+    e.a = a;
+    e.b = b;
+    e.c = c;
+    e.d = d;
+    e.value = value;
+    log.push_back(e);
+}
+
+bool eventLog::save(const std::string &fileName) const
+{
+    std::ofstream fout(fileName);
+    if(!fout) return false;
+    fout << logHeader << '\n' << std::setprecision(17);
+    for(const auto &e: log) fout << e.t << ' ' << e.kind << ' ' << e.a << ' ' << e.b << ' ' << e.c << ' ' << e.d << ' ' << e.value << '\n';
+    return static_cast<bool>(fout);
+}
+
+bool eventLog::load(const std::string &fileName)
+{
+    std::ifstream fin(fileName);
+    std::string line;
+    if(!fin || !std::getline(fin, line) || line != logHeader) return false;
+    std::vector<inputEvent> in;
+    while(std::getline(fin, line)){
+        if(line.empty()) continue;
+        std::istringstream is(line);
+        inputEvent e;
+        if(!(is >> e.t >> e.kind >> e.a >> e.b >> e.c >> e.d >> e.value)) return false;
+        in.push_back(e);
+    }
+    // recorded in order, but a hand edited log may not be
+    std::stable_sort(in.begin(), in.end(), [](const inputEvent &x, const inputEvent &y){ return x.t < y.t; });
+    log = std::move(in);
+    cursor = 0;
+    bRecording = false;
+    return true;
+}
+
+bool eventLog::next(double t, inputEvent &e)
+{
+    if(cursor >= log.size() || log[cursor].t > t) return false;
+    e = log[cursor++];
+    return true;
+}
+
+bool writeFrameTimes(const std::string &fileName, const std::vector<double> &paintMs, double tickMs)
+{
+    std::ofstream fout(fileName);
+    if(!fout) return false;
+    fout << "frame,virtual ms,paint ms\n";
+    for(std::size_t i=0; i<paintMs.size(); ++i) fout << i << ',' << (i + 1) * tickMs << ',' << paintMs[i] << '\n';
+    return static_cast<bool>(fout);
+}
+
+std::string frameTimeSummary(const std::vector<double> &paintMs)
+{
+    std::ostringstream os;
+    if(paintMs.empty()) return "no frames";
+    std::vector<double> sorted = paintMs;
+    std::sort(sorted.begin(), sorted.end());
+    const double mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+    const std::size_t p95 = std::min(sorted.size() - 1, (sorted.size() * 95) / 100);
+    os << std::fixed << std::setprecision(3) << sorted.size() << " frames, paint ms mean " << mean << ", median "
+       << sorted[sorted.size() / 2] << ", 95% " << sorted[p95] << ", worst " << sorted.back();
+    return os.str();
+}
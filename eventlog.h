@@ -0,0 +1,49 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+
+// One recorded input, t in ms since recording started
+struct inputEvent
+{
+    double t = 0.0;
+    char kind = 0; // 'p' mouse press, 'm' mouse move, 'k' key, 'w' widget action
+    int a = 0, b = 0, c = 0, d = 0; // mouse: x, y, buttons, modifiers; key: the key; widget: the action
+    double value = 0.0; // a widget action's new value
+};
+
+// Timestamped input of a session, kept as text one event a line, so a
+// replay can drive the same gestures against a virtual clock
+class eventLog
+{
+public:
+    void startRecording(); // the clock starts now
+    bool recording() const { return bRecording; }
+    void add(char kind, int a, int b = 0, int c = 0, int d = 0, double value = 0.0);
+    bool save(const std::string &fileName) const;
+    bool load(const std::string &fileName);
+    const std::vector<inputEvent>& events() const { return log; }
+    // replaying, the next event due by virtual time t, false when there are none yet
+    bool next(double t, inputEvent &e);
+    bool finished() const { return cursor >= log.size(); }
+    double duration() const { return log.empty() ? 0.0 : log.back().t; }
+private:
+    std::vector<inputEvent> log;
+    std::chrono::steady_clock::time_point start;
+    bool bRecording = false;
+    std::size_t cursor = 0;
+};
+
+// frame times of a replay as csv, one line a frame: frame, virtual ms, paint ms
+bool writeFrameTimes(const std::string &fileName, const std::vector<double> &paintMs, double tickMs);
+
+// frames, mean, median, 95th percentile and worst
+std::string frameTimeSummary(const std::vector<double> &paintMs);
+
+#endif // EVENTLOG_H
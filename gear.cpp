@@ -8,6 +8,7 @@
 #include <iostream>
 #include <cmath>
 #include "gear.h"
+#include "trace.h"
 
 // cutter depth D+f = 2.157 / DP (inches), or 2.157 M (mm)
 // side clearance on circular pitch (measured around circumferance), tooth 0.48 wide, gap 0.52
@@ -20,82 +21,545 @@
 static const float pi = 3.1415926535897932f;
 static const float Df = 2.157f; // tooth depth
 static float gap = 0.52f; // number less than 0.5: side clearance on circular pitch
-static const unsigned int Ninv = 20; // number of involute vertices on one side of tooth, incuding fillet curve
-static const unsigned int Nfillet = 9; // number of extra points used for tooth root fillet curve, must be 2 or more
+// number of involute vertices on one side of tooth, incuding fillet curve, for each gearDetail
+static constexpr unsigned int NinvFine = 20, NinvCoarse = 8;
+// number of extra points used for tooth root fillet curve, must be 2 or more
+static constexpr unsigned int NfilletFine = 9, NfilletCoarse = 3;
 static const float filletR = 0.3927f; // radius of tooth root fillet
 
-gear::gear(unsigned int Ni, float pai, float dZ):N(Ni), nVertices(8*(1+Ninv)*Ni+2), nIndices(24*Ninv*Ni),
-    n1indices(Ni *(12*Ninv+6)), rp((float) Ni / 2.0f), rbc(rp * cos(pai)), rmaj((float) (Ni+2) / 2.0f),
-    rmin((float) (Ni+2) / 2.0f - Df), delZ(dZ), pa(pai), cospa(cos(pai)), sinpa(sin(pai))
+// the maths functions for scalar T, float makes the calls it always made, through
+// double but for sqrtf, so the float meshes don't change
+template<class T> struct mathsOf
 {
-    verts.resize(6*nVertices);
+    static T cos(T x) { return std::cos(x); }
+    static T sin(T x) { return std::sin(x); }
+    static T tan(T x) { return std::tan(x); }
+    static T atan(T x) { return std::atan(x); }
+    static T sqrt(T x) { return std::sqrt(x); }
+    static T sqrtf(T x) { return std::sqrt(x); }
+};
+
+template<> struct mathsOf<float>
+{
+    static double cos(float x) { return ::cos(x); }
+    static double sin(float x) { return ::sin(x); }
+    static double tan(float x) { return ::tan(x); }
+    static double atan(float x) { return ::atan(x); }
+    static double sqrt(float x) { return ::sqrt(x); }
+    static float sqrtf(float x) { return ::sqrtf(x); }
+};
+
+template<class T> struct toothParams
+{
+    T rp, rbc, rmaj, rmin, pa, cospa, sinpa;
+    T pi, gap, filletR;
+};
+
+// the two tooth profiles, point on the curve and its derivatives at roll angle theta,
+// cost and sint are cos and sin of pa + theta. The slopes are written as they always
+// were at each call site, they round differently and the meshes mustn't change
+
+// exact involute of the base circle
+template<class T> struct involuteExactOf
+{
+    typedef T scalar;
+    const T rp, rbc, pa, sinpa, cospa;
+
+    void point(T theta, T cost, T sint, T &x, T &y) const
+    {
+        x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
+        y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
+    }
+    // derivative wrt theta, for the radius solve
+    void slope(T theta, T cost, T sint, T &dx, T &dy) const
+    {
+        dx = -rbc * cost + rp * cospa * cost - rp * (sinpa + theta * cospa) * sint;
+        dy = -rbc * sint + rp * cospa * sint + rp * (sinpa + theta * cospa) * cost;
+    }
+    // derivative from the point, for the fillet solve
+    void tangent(T cost, T sint, T x, T y, T &dx, T &dy) const
+    {
+        dx = -y + rp * cospa * cost;
+        dy = x + rp * cospa * sint;
+    }
+    void curvature(T cost, T sint, T dx, T dy, T &ddx, T &ddy) const
+    {
+        ddx = -dy - rp * cospa * sint;
+        ddy = dx + rp * cospa * cost;
+    }
+    // derivative from the point, for the vertex normals
+    void normal(T theta, T x, T y, T &dx, T &dy) const
+    {
+        dx = -y + rp * cospa * mathsOf<T>::cos(pa + theta);
+        dy = x + rp * cospa * mathsOf<T>::sin(pa + theta);
+    }
+};
+
+// circle through the pitch point centred on the line of action, tangent to the involute there
+template<class T> struct involuteApproxOf
+{
+    typedef T scalar;
+    const T rp, rbc, pa, sinpa, cospa;
+
+    void point(T, T cost, T sint, T &x, T &y) const
+    {
+        x = -rbc * sinpa + rp * sinpa * cost;
+        y = rbc * cospa + rp * sinpa * sint;
+    }
+    void tangent(T, T, T x, T y, T &dx, T &dy) const
+    {
+        dx = -y + rp * cospa * cospa;
+        dy = x + rp * cospa * sinpa;
+    }
+    void slope(T theta, T cost, T sint, T &dx, T &dy) const
+    {
+        T x, y;
+        point(theta, cost, sint, x, y);
+        tangent(cost, sint, x, y, dx, dy);
+    }
+    void curvature(T, T, T dx, T dy, T &ddx, T &ddy) const
+    {
+        ddx = -dy;
+        ddy = dx;
+    }
+    void normal(T, T x, T y, T &dx, T &dy) const
+    {
+        tangent(0.0f, 0.0f, x, y, dx, dy);
+    }
+};
+
+gear::gear(unsigned int Ni, float pai, float dZ, gearBuild build, gearDetail detail, gearPrecision precision):N(Ni),
+    Ninv(detail == gearDetail::coarse ? NinvCoarse : NinvFine), Nfillet(detail == gearDetail::coarse ? NfilletCoarse : NfilletFine),
+    nVertices(8*(1+Ninv)*Ni+2), nIndices(24*Ninv*Ni), n1indices(Ni *(12*Ninv+6)), rp((float) Ni / 2.0f), rbc(rp * cos(pai)), rmaj((float) (Ni+2) / 2.0f),
+    rmin((float) (Ni+2) / 2.0f - Df), delZ(dZ), pa(pai), cospa(cos(pai)), sinpa(sin(pai)), bFull(build == gearBuild::full),
+    bDouble(precision == gearPrecision::doubles)
+{
+    TRACE_SCOPE("gear::gear");
+    verts.resize(bFull ? 6*nVertices : 12); // only the centres are kept when streaming
     vert_it = verts.end() - 12; // offset for centre verticies
-    inds.resize(nIndices);
-    ind_it0 = inds.begin(); // the blue stuff, 12 * Ninv + 6 indicies
-    ind_it1 = ind_it0 + n1indices; // the cut stuff, 12 * Ninv - 6 indicies
-    invo_curve_x.resize(Ninv);
-    invo_curve_y.resize(Ninv);
-    invo_curve_xn.resize(Ninv);
-    invo_curve_yn.resize(Ninv);
+    if(bFull){
+        inds.resize(nIndices);
+        ind_it0 = inds.begin(); // the blue stuff, 12 * Ninv + 6 indicies
+        ind_it1 = ind_it0 + n1indices; // the cut stuff, 12 * Ninv - 6 indicies
+    }
+    sizeOutline(tooth);
 
-    sectorVerts();
-    for(unsigned int i=0; i<N; ++i) sectorV(i);
-    sectorIndicies();
-    for(unsigned int i=0; i<N; ++i) sectorI(i);
+    generate<involuteExactOf>();
 }
 
 
-gear::gear(unsigned int Ni, float pai, float dZ, float rmaji):N(Ni), nVertices(8*(1+Ninv)*Ni+2), nIndices(24*Ninv*Ni),
-    n1indices(Ni *(12*Ninv+6)), rp((float) Ni / 2.0f), rbc(rp * cos(pai)), rmaj(rmaji),
-    rmin((float) (Ni+2) / 2.0f - Df), delZ(dZ), pa(pai), cospa(cos(pai)), sinpa(sin(pai))
+gear::gear(unsigned int Ni, float pai, float dZ, float rmaji, gearBuild build, gearDetail detail, gearPrecision precision):N(Ni),
+    Ninv(detail == gearDetail::coarse ? NinvCoarse : NinvFine), Nfillet(detail == gearDetail::coarse ? NfilletCoarse : NfilletFine),
+    nVertices(8*(1+Ninv)*Ni+2), nIndices(24*Ninv*Ni), n1indices(Ni *(12*Ninv+6)), rp((float) Ni / 2.0f), rbc(rp * cos(pai)), rmaj(rmaji),
+    rmin((float) (Ni+2) / 2.0f - Df), delZ(dZ), pa(pai), cospa(cos(pai)), sinpa(sin(pai)), bFull(build == gearBuild::full),
+    bDouble(precision == gearPrecision::doubles)
 {
-    verts.resize(6*nVertices);
+    verts.resize(bFull ? 6*nVertices : 12); // only the centres are kept when streaming
     vert_it = verts.end() - 12; // offset for centre verticies
-    inds.resize(nIndices);
-    ind_it0 = inds.begin(); // the blue stuff, 12 * Ninv + 6 indicies
-    ind_it1 = ind_it0 + n1indices; // the cut stuff, 12 * Ninv - 6 indicies
-    invo_curve_x.resize(Ninv);
-    invo_curve_y.resize(Ninv);
-    invo_curve_xn.resize(Ninv);
-    invo_curve_yn.resize(Ninv);
+    if(bFull){
+        inds.resize(nIndices);
+        ind_it0 = inds.begin(); // the blue stuff, 12 * Ninv + 6 indicies
+        ind_it1 = ind_it0 + n1indices; // the cut stuff, 12 * Ninv - 6 indicies
+    }
+    sizeOutline(tooth);
 }
 
 gear::~gear()
 {
 }
 
+// float is the gear's own members, exactly as they always were
+template<> toothParams<float> gear::params<float>() const
+{
+    return toothParams<float>{rp, rbc, rmaj, rmin, pa, cospa, sinpa, pi, gap, filletR};
+}
+
+// wider scalars work the dimensions out again from N and the float parameters, the
+// pressure angle, major radius and the constants, so every precision makes the same gear
+template<class T> toothParams<T> gear::params() const
+{
+    typedef mathsOf<T> M;
+    toothParams<T> q;
+    q.rp = (T) N / 2;
+    q.pa = pa;
+    q.cospa = M::cos(q.pa);
+    q.sinpa = M::sin(q.pa);
+    q.rbc = q.rp * q.cospa;
+    q.rmaj = rmaj;
+    q.rmin = (T) (N + 2) / 2 - (T) Df;
+    q.pi = (T) 3.14159265358979323846264338327950288L;
+    q.gap = gap;
+    q.filletR = filletR;
+    return q;
+}
+
+template<class P> P gear::profile() const
+{
+    const toothParams<typename P::scalar> q = params<typename P::scalar>();
+    return P{q.rp, q.rbc, q.pa, q.sinpa, q.cospa};
+}
+
+template<class T> void gear::sizeOutline(toothOutline<T> &o) const
+{
+    o.invo_curve_x.resize(Ninv);
+    o.invo_curve_y.resize(Ninv);
+    o.invo_curve_xn.resize(Ninv);
+    o.invo_curve_yn.resize(Ninv);
+}
+
+// profile of one flank then the whole gear, P is the tooth profile. The float outline
+// is always made, for GetToothX() and the shading, gearPrecision::doubles makes it
+// again in double for the vertices
+template<template<class> class P> void gear::generate()
+{
+    sectorFillet<P<float>>();
+    sectorVerts();
+    if(bDouble){
+        sizeOutline(toothD);
+        sectorFillet<P<double>>(toothD);
+        toothFlanks(toothD);
+    }
+    if(bFull){
+        TRACE_SCOPE("gear::sectors");
+        for(unsigned int i=0; i<N; ++i) sectorV(i);
+        for(unsigned int i=0; i<N; ++i) sectorI(i);
+    }
+}
+
+template<class T> toothOutline<T> gear::OutlineIn() const
+{
+    toothOutline<T> o;
+    sizeOutline(o);
+    if(rCircle != 0.0f) sectorFillet<involuteApproxOf<T>>(o);
+    else sectorFillet<involuteExactOf<T>>(o);
+    toothFlanks(o);
+    return o;
+}
+
+template<class T> void gear::SectorVertsIn(unsigned int n, const toothOutline<T> &o, T *vr) const
+{
+    sectorV(n, o, vr);
+}
+
+// callculate involute with fillet radius for case where
+// fillet is entirely inside base circle, computes the verticies
+// for the involute and stores them in arrays invo_curve_x[], invo_curve_y[]
+template<class P, class T> void gear::sectorFillet(toothOutline<T> &o) const
+{
+    typedef mathsOf<T> M;
+    const toothParams<T> q = params<T>();
+    const P p = profile<P>();
+    T x0, y0, dtheta1, dtheta2;
+
+    {
+        T x, y, theta;
+
+        theta = - q.rp * q.sinpa / q.rbc; // angle where involute crosses base circle
+        x0 = q.filletR;
+        y0 = q.rbc; // put fillet tangent to y sector line at base circle radius
+        dtheta1 = q.pa + theta; // angle to rotate onto tooth
+        dtheta2 = q.gap * q.pi / (T) N; // rotate gear so middle of gullet is on y axis
+        dtheta1 += dtheta2;
+        x = x0 * M::cos(dtheta1) - y0 * M::sin(dtheta1);
+        y = x0 * M::sin(dtheta1) + y0 * M::cos(dtheta1); // now have height of fillet radius
+        if(y < q.rmin + q.filletR){ // fillet's on the involute
+            involute_fillet<P>(o);
+            return;
+        }
+        // fillet is on the sector
+        T dy = q.rmin + q.filletR - y;
+        y += dy;
+        x -= dy * M::tan(dtheta2);
+        x0 = x;
+        y0 = y;
+        dtheta2 = -dtheta2;
+        x = x0 * M::cos(dtheta2) - y0 * M::sin(dtheta2);
+        y = x0 * M::sin(dtheta2) + y0 * M::cos(dtheta2);
+        x0 = x; // x0, y0 are centre coordinate of fillet
+        y0 = y;
+        dtheta1 = q.pa + theta; // angle from y axis where involute crosses base circle
+        dtheta2 = -dtheta2;   // angle to rotate gear so middle of gullet is on y axis
+    }
+
+    T x, y, r;
+    T xd, yd;
+    T theta, norm;
+    T cost, sint;
+
+    // point on base circle, largest diameter of sector, on the true involute for either profile
+    //theta = -sinpa / cospa; // = -tan(pa)
+    theta = dtheta1 - q.pa;
+    cost = M::cos(q.pa + theta);
+    sint = M::sin(q.pa + theta);
+    x = -q.rbc * sint + q.rp * (q.sinpa + theta * q.cospa) * cost;
+    y = q.rbc * cost + q.rp * (q.sinpa + theta * q.cospa) * sint;
+    o.invo_curve_x[Nfillet] = x;
+    o.invo_curve_y[Nfillet] = y;
+    xd = y; // start of sector, norm is tangent to base circle
+    yd = -x;
+    norm = 1.0f / M::sqrtf(xd * xd + yd * yd);
+    o.invo_curve_xn[Nfillet] = xd * norm;
+    o.invo_curve_yn[Nfillet] = yd * norm;
+
+    // fillets
+    T theta1, theta2;
+    theta1 = 1.5f * q.pi - dtheta2; // blend into gullet
+    theta2 = q.pi + dtheta1; // blend into sector
+    const T delTheta = (theta2 - theta1) / (T) (Nfillet - 1);
+    theta = theta1;
+    for(unsigned int i=0; i<Nfillet; ++i){
+        cost = M::cos(theta);
+        sint = M::sin(theta);
+        x = x0 + q.filletR * cost;
+        y = y0 + q.filletR * sint;
+        o.invo_curve_x[i] = x;
+        o.invo_curve_y[i] = y;
+        norm = 1.0f / M::sqrtf(cost * cost + sint * sint);
+        o.invo_curve_xn[i] = -cost * norm;
+        o.invo_curve_yn[i] = -sint * norm;
+        theta += delTheta;
+    }
+
+    theta = -0.5f * q.sinpa / q.cospa; // half way between pitch circle and base circle
+    const T dr = (q.rmaj - q.rbc) / (T) (Ninv - Nfillet - 1);
+    for(unsigned int i=Nfillet+1; i<Ninv; ++i){
+        r = (T)(i - Nfillet) * dr + q.rbc;
+        NewtonRaphson<P>(6, r, theta, x, y);
+        o.invo_curve_x[i] = x;
+        o.invo_curve_y[i] = y;
+        p.normal(theta, x, y, xd, yd);
+        norm = 1.0f / M::sqrtf(xd * xd + yd * yd);
+        o.invo_curve_xn[i] = yd * norm;
+        o.invo_curve_yn[i] = -xd * norm;
+    }
+}
+
+
+// callculate involute with fillet radius for case where
+// fillet is tangent to involute
+template<class P, class T> void gear::involute_fillet(toothOutline<T> &o) const
+{
+    typedef mathsOf<T> M;
+    const toothParams<T> q = params<T>();
+    const P p = profile<P>();
+    T x, y, dx, dy;
+    T theta, beta;
+    T hPrime;
+    const T gamma = 2.0f * q.gap * q.pi / (T) N;
+    const T sing = M::sin(gamma), cosg = M::cos(gamma);
+
+    theta = 0.0f;
+    T cost, sint;
+    T xf, yf, dh;
+    // find where involute meets fillet
+    for(int i=0; i<6; ++i){
+        cost = M::cos(q.pa + theta);
+        sint = M::sin(q.pa + theta);
+        p.point(theta, cost, sint, x, y);
+        // derivatives wrt theta
+        p.tangent(cost, sint, x, y, dx, dy);
+        beta = -M::atan(dx / dy);
+        xf = x + q.filletR * M::cos(beta);
+        yf = y + q.filletR * M::sin(beta);
+        hPrime = sing * xf + cosg * yf;
+        dh = hPrime - q.rmin - q.filletR;
+
+        // now calculate derivative of gradient
+        T ddx, ddy, gdd, dhPrime;
+        p.curvature(cost, sint, dx, dy, ddx, ddy);
+        // gdd is d/d_theta (dx / dy)
+        gdd = ddx / dy - dx * ddy / (dy * dy);
+        T dxdy = dx / dy;
+        T dBeta_dTheta = -1.0f / (1.0f + dxdy * dxdy) * gdd;
+        dhPrime = sing * (dx - q.filletR * M::sin(beta) * dBeta_dTheta);
+        dhPrime += cosg * (dy + q.filletR * M::cos(beta) * dBeta_dTheta);
+        theta -= dh / dhPrime;
+    }
+
+    // fillets
+    T r = M::sqrt(x * x + y * y); // currently smallest diameter of involute
+    T x0 = x + q.filletR * M::cos(beta);
+    T y0 = y + q.filletR * M::sin(beta);
+    T theta1 = 1.5f * q.pi - q.gap * q.pi / (T) N; // blend into gullet
+    T theta2 = q.pi + beta; // blend into tooth
+    const T delTheta = (theta2 - theta1) / (T) (Nfillet - 1);
+    theta = theta1;
+    T norm;
+    for(unsigned int i=0; i<Nfillet; ++i){
+        cost = M::cos(theta);
+        sint = M::sin(theta);
+        x = x0 + q.filletR * cost;
+        y = y0 + q.filletR * sint;
+        o.invo_curve_x[i] = x;
+        o.invo_curve_y[i] = y;
+        norm = 1.0f / M::sqrtf(cost * cost + sint * sint);
+        o.invo_curve_xn[i] = -cost * norm;
+        o.invo_curve_yn[i] = -sint * norm;
+        theta += delTheta;
+    }
+    theta = 0.0f;
+    T dr = (q.rmaj - r) / (T) (Ninv - Nfillet);
+    for(unsigned int i=Nfillet; i<Ninv; ++i){
+        r += dr;
+        NewtonRaphson<P>(6, r, theta, x, y);
+        o.invo_curve_x[i] = x;
+        o.invo_curve_y[i] = y;
+        p.normal(theta, x, y, dx, dy);
+        norm = 1.0f / M::sqrt(dx * dx + dy * dy);
+        o.invo_curve_xn[i] = dy * norm;
+        o.invo_curve_yn[i] = -dx * norm;
+    }
+}
+
+// find coords to bring involute curve to distance r from centre
+// theta inputs initial guess for its value, x and y input are garbage
+template<class P, class T> void gear::NewtonRaphson(unsigned int n, const T r, T &theta, T &x, T &y) const
+{
+    typedef mathsOf<T> M;
+    const P p = profile<P>();
+    T cost, sint;
+    T dx, dy, dr;
+    T rx;
+    T del_theta;
+
+    for(unsigned int i=0; i<n; ++i){
+        cost = M::cos(p.pa + theta);
+        sint = M::sin(p.pa + theta);
+        p.point(theta, cost, sint, x, y);
+        rx = M::sqrtf(x * x + y * y);
+        p.slope(theta, cost, sint, dx, dy);
+        dr = x * dx + y * dy;
+        dr /= rx;
+        del_theta = (r - rx) / dr;
+        theta += del_theta;
+    }
+    cost = M::cos(p.pa + theta);
+    sint = M::sin(p.pa + theta);
+    p.point(theta, cost, sint, x, y);
+}
+
+// gearbench times the profile maths of each
+template void gear::sectorFillet<involuteExact, float>(toothOutline<float>&) const;
+template void gear::sectorFillet<involuteApprox, float>(toothOutline<float>&) const;
+template void gear::involute_fillet<involuteExact, float>(toothOutline<float>&) const;
+template void gear::involute_fillet<involuteApprox, float>(toothOutline<float>&) const;
+template void gear::NewtonRaphson<involuteExact, float>(unsigned int, const float, float&, float&, float&) const;
+template void gear::NewtonRaphson<involuteApprox, float>(unsigned int, const float, float&, float&, float&) const;
+// and gearbench --precision measures the meshes against long double
+template toothOutline<double> gear::OutlineIn<double>() const;
+template toothOutline<long double> gear::OutlineIn<long double>() const;
+template void gear::SectorVertsIn<double>(unsigned int, const toothOutline<double>&, double*) const;
+template void gear::SectorVertsIn<long double>(unsigned int, const toothOutline<long double>&, long double*) const;
+
+unsigned int gear::GetSectorNverts() const
+{
+    return 8 * (1 + Ninv);
+}
+
+unsigned int gear::GetSectorNInds() const
+{
+    return 24 * Ninv;
+}
+
+void gear::SectorVerts(unsigned int n, float *vr)
+{
+    sectorV(n, vr);
+}
+
+void gear::SectorInds(unsigned int n, unsigned int *it)
+{
+    sectorI(n, it, it + 12 * Ninv + 6);
+}
+
+void gear::SectorInds(unsigned int n, unsigned int *blank, unsigned int *cut)
+{
+    sectorI(n, blank, cut);
+}
+
+float gear::GetFilletR() const
+{
+    return filletR;
+}
+
+// the vectors of one tooth outline, by capacity
+template<class T> static std::size_t outlineBytes(const toothOutline<T> &o)
+{
+    std::size_t n = o.vertx.capacity() + o.verty.capacity() + o.vertxn.capacity() + o.vertyn.capacity();
+    n += o.invo_curve_x.capacity() + o.invo_curve_y.capacity() + o.invo_curve_xn.capacity() + o.invo_curve_yn.capacity();
+    return n * sizeof(T);
+}
+
+std::size_t gear::GetBytes() const
+{
+    return sizeof(*this) + verts.capacity() * sizeof(float) + outlineBytes(tooth) + outlineBytes(toothD) + inds.capacity() * sizeof(unsigned int);
+}
+
+unsigned int flankVerts(gearDetail detail)
+{
+    return detail == gearDetail::coarse ? NinvCoarse : NinvFine;
+}
+
+std::size_t gearBytes(unsigned int N, gearBuild build, gearDetail detail, gearPrecision precision)
+{
+    const std::size_t Ninv = flankVerts(detail);
+    const std::size_t nVertices = 8 * (1 + Ninv) * N + 2, nIndices = 24 * Ninv * N;
+    const bool bFull = build == gearBuild::full;
+    // the vertices or just the centres, the outline and its normals, the flank, in double again for doubles
+    const std::size_t floats = (bFull ? 6 * nVertices : 12) + 4 * 2 * Ninv + 4 * Ninv;
+    const std::size_t doubles = precision == gearPrecision::doubles ? 4 * 2 * Ninv + 4 * Ninv : 0;
+    return sizeof(gear) + floats * sizeof(float) + doubles * sizeof(double) + (bFull ? nIndices : 0) * sizeof(unsigned int);
+}
+
+void gear::GetFlankShading(float s[3]) const
+{
+    // the last fillet vertex, on the sector line below the base circle or tangent to the flank
+    const std::vector<float> &vertx = tooth.vertx, &verty = tooth.verty;
+    const float rf = std::sqrt(vertx[Nfillet-1] * vertx[Nfillet-1] + verty[Nfillet-1] * verty[Nfillet-1]);
+    s[0] = rbc;
+    s[1] = rf > rbc ? rf : rbc;
+    s[2] = rCircle;
+}
+
 // make a preliminary (2D in xy plane only) template
 // consisting of 1 tooth worth of verticies
 // and their norms for the two curved involute faces
 // either side of tooth.
-void gear::sectorVerts()
+template<class T> void gear::toothFlanks(toothOutline<T> &o) const
 {
+    typedef mathsOf<T> M;
+    const toothParams<T> q = params<T>();
     unsigned int i, j;
-    float x, y, xn, yn;
-    float sinx, cosx;
-    float del_tooth;
+    T x, y, xn, yn;
+    T sinx, cosx;
+    T del_tooth;
     const unsigned int Nt = 2 * Ninv;
 
-    vertx.resize(Nt);
-    verty.resize(Nt);
-    vertxn.resize(Nt); // norms to involute
-    vertyn.resize(Nt); // norms to involute
-    involute();
-    del_tooth = 2.0f * (1.0f - gap) * pi / static_cast<float>(N);
+    o.vertx.resize(Nt);
+    o.verty.resize(Nt);
+    o.vertxn.resize(Nt); // norms to involute
+    o.vertyn.resize(Nt); // norms to involute
+    del_tooth = 2.0f * (1.0f - q.gap) * q.pi / static_cast<T>(N);
     // rotate involute after flipping for 2nd side
-    sinx = sin(del_tooth);
-    cosx = cos(del_tooth);
+    sinx = M::sin(del_tooth);
+    cosx = M::cos(del_tooth);
     for(i=0; i<Ninv; ++i){
         j = Ninv + i;
-        x = -(vertx[i] = invo_curve_x[i]);
-        y = verty[i] = invo_curve_y[i];
-        xn = -(vertxn[i] = invo_curve_xn[i]);
-        yn = vertyn[i] = invo_curve_yn[i];
-        vertx[j] = cosx * x - sinx * y;
-        verty[j] = sinx * x + cosx * y;
-        vertxn[j] = cosx * xn - sinx * yn;
-        vertyn[j] = sinx * xn + cosx * yn;
+        x = -(o.vertx[i] = o.invo_curve_x[i]);
+        y = o.verty[i] = o.invo_curve_y[i];
+        xn = -(o.vertxn[i] = o.invo_curve_xn[i]);
+        yn = o.vertyn[i] = o.invo_curve_yn[i];
+        o.vertx[j] = cosx * x - sinx * y;
+        o.verty[j] = sinx * x + cosx * y;
+        o.vertxn[j] = cosx * xn - sinx * yn;
+        o.vertyn[j] = sinx * xn + cosx * yn;
     }
+}
+
+// the float tooth and the centre verticies
+void gear::sectorVerts()
+{
+    TRACE_SCOPE("gear::sectorVerts");
+    toothFlanks(tooth);
     // 2 centre verticies, common to all teeth
     unsigned int cnt = 0;
     vert_it[cnt++] = 0.0f;
@@ -117,16 +581,30 @@ void gear::sectorVerts()
 // 6 floats per vertex
 void gear::sectorV(unsigned int n)
 {
+    // move to this sector
+    sectorV(n, &verts[48 * n * (1 + Ninv)]);
+}
+
+void gear::sectorV(unsigned int n, float *vr)
+{
+    if(bDouble) sectorV(n, toothD, vr);
+    else sectorV(n, tooth, vr);
+}
+
+template<class T, class V> void gear::sectorV(unsigned int n, const toothOutline<T> &o, V *vr) const
+{
+    typedef mathsOf<T> M;
+    const toothParams<T> q = params<T>();
+    const std::vector<T> &vertx = o.vertx, &verty = o.verty, &vertxn = o.vertxn, &vertyn = o.vertyn;
+    const T rmaj = q.rmaj, rmin = q.rmin;
     unsigned int i, j, k, cnt;
     const unsigned int N1 = Ninv - 1;
-    float cosx, sinx, theta;
-    // use iterator to move to this sector
-    std::vector<float>::iterator vr = verts.begin() + 48 * n * (1 + Ninv);
+    T cosx, sinx, theta;
 
     // rotate whole tooth by theta
-    theta = 2.0f * pi * (float) n / (float) N;
-    cosx = cos(theta);
-    sinx = sin(theta);
+    theta = 2.0f * q.pi * (T) n / (T) N;
+    cosx = M::cos(theta);
+    sinx = M::sin(theta);
     // outside diameter of gear blank, 4 verticies
     cnt = 0;
     j = Ninv + N1;
@@ -258,305 +736,203 @@ void gear::sectorV(unsigned int n)
 }
 
 
-// Set the incicies for drawing the triangles from the vertercies
-void gear::sectorIndicies()
+// Set the incicies for drawing the triangles from the vertercies.
+// One sector's pattern depends only on Ninv so it's made at compile time, each
+// index counted from the first vertex of the sector it's in, either this sector
+// or the previous one (around the world for sector 0), or the 2 centre verticies
+enum : unsigned char { thisSector, prevSector, centreVerts };
+
+template<unsigned int n> struct sectorPattern
 {
-    unsigned int i, j, k, dN;
-    const unsigned int N1 = Ninv - 1;
+    unsigned int ind[n];
+    unsigned char from[n];
+    unsigned int nOwn; // leading indicies which are all in this sector
+};
+
+template<unsigned int Ninv> constexpr sectorPattern<12 * Ninv + 6> blankPattern()
+{
+    sectorPattern<12 * Ninv + 6> p{};
+    unsigned int i = 0, j = 0, k = 0;
+    const unsigned int N1 = Ninv - 1, dN = 8 + 4 * Ninv;
 
-    inds0.resize(12 * Ninv + 6); // blank's triangles (blue)
-    inds1.resize(12 * Ninv - 6); // cut surface's triangles
-    // first render the blank (blue)
     // sides of teeth, 8 + 4 * Ninv verticies already done
-    dN = 8 + 4 * Ninv;
     for(i=j=0; i<N1; ++i){
         k = 4 * i + dN;
         // front 2 triangles
-        inds0[j++] = k;
-        inds0[j++] = k + 1;
-        inds0[j++] = k + 4;
-        inds0[j++] = k + 1;
-        inds0[j++] = k + 4;
-        inds0[j++] = k + 5;
+        p.ind[j++] = k;
+        p.ind[j++] = k + 1;
+        p.ind[j++] = k + 4;
+        p.ind[j++] = k + 1;
+        p.ind[j++] = k + 4;
+        p.ind[j++] = k + 5;
         // back 2 triangles
-        inds0[j++] = k + 2;
-        inds0[j++] = k + 3;
-        inds0[j++] = k + 6;
-        inds0[j++] = k + 3;
-        inds0[j++] = k + 6;
-        inds0[j++] = k + 7;
+        p.ind[j++] = k + 2;
+        p.ind[j++] = k + 3;
+        p.ind[j++] = k + 6;
+        p.ind[j++] = k + 3;
+        p.ind[j++] = k + 6;
+        p.ind[j++] = k + 7;
     }  // currently j = 12 * (Ninv - 1) indicies
-    // outside diameter,
-    k = 0; // front tooth OD
-    inds0[j++] = k;
-    inds0[j++] = k + 1;
-    inds0[j++] = k + 2;
-    inds0[j++] = k + 2;
-    inds0[j++] = k + 3;
-    inds0[j++] = k + 1;
-    // side faces, 8 + 4 * Ninv verticies already done
-    // currently j = 12 * N1 + 6
-    //////////////////////////
+    // outside diameter, front tooth OD
+    p.ind[j++] = 0;
+    p.ind[j++] = 1;
+    p.ind[j++] = 2;
+    p.ind[j++] = 2;
+    p.ind[j++] = 3;
+    p.ind[j++] = 1;
+    p.nOwn = j;
     // Now do 2 triangles which go to the centre
-    i = nVertices - 2; // centres
-    dN = 8 + 4 * Ninv;
-    k = 8 * (Ninv + 1) * (N - 1); // vertex off neighbouring sector, around the world less one!
-    inds0[j++] = i; // front face centre
-    inds0[j++] = dN;
-    inds0[j++] = dN + 1;
-    inds0[j++] = i;
-    inds0[j++] = dN;
-    inds0[j++] = dN + k + 1;     // around world
-    inds0[j++] = i + 1;      // back face centre
-    inds0[j++] = dN + 2;
-    inds0[j++] = dN + 3;
-    inds0[j++] = i + 1;
-    inds0[j++] = dN + 2;
-    inds0[j++] = dN + k + 3; //around world
-    //////////////////////////////////////////////
-    // now for the cut surfaces, different colour
+    p.from[j] = centreVerts;
+    p.ind[j++] = 0; // front face centre
+    p.ind[j++] = dN;
+    p.ind[j++] = dN + 1;
+    p.from[j] = centreVerts;
+    p.ind[j++] = 0;
+    p.ind[j++] = dN;
+    p.from[j] = prevSector;
+    p.ind[j++] = dN + 1; // around world
+    p.from[j] = centreVerts;
+    p.ind[j++] = 1; // back face centre
+    p.ind[j++] = dN + 2;
+    p.ind[j++] = dN + 3;
+    p.from[j] = centreVerts;
+    p.ind[j++] = 1;
+    p.ind[j++] = dN + 2;
+    p.from[j] = prevSector;
+    p.ind[j++] = dN + 3; // around world
+    return p;
+}
+
+// the cut surfaces, different colour
+template<unsigned int Ninv> constexpr sectorPattern<12 * Ninv - 6> cutPattern()
+{
+    sectorPattern<12 * Ninv - 6> p{};
+    unsigned int i = 0, j = 0, k = 0;
+    const unsigned int N1 = Ninv - 1;
+
     // involute faces, start 8 verticies down list
     for(i=j=0; i<N1; ++i){
         k = 4 * i + 8;
         // first rectangle
-        inds1[j++] = k;
-        inds1[j++] = k + 4;
-        inds1[j++] = k + 2;
-        inds1[j++] = k + 4;
-        inds1[j++] = k + 2;
-        inds1[j++] = k + 6;
+        p.ind[j++] = k;
+        p.ind[j++] = k + 4;
+        p.ind[j++] = k + 2;
+        p.ind[j++] = k + 4;
+        p.ind[j++] = k + 2;
+        p.ind[j++] = k + 6;
         // rectangle on opposite side
-        inds1[j++] = k + 1;
-        inds1[j++] = k + 5;
-        inds1[j++] = k + 3;
-        inds1[j++] = k + 5;
-        inds1[j++] = k + 3;
-        inds1[j++] = k + 7;
+        p.ind[j++] = k + 1;
+        p.ind[j++] = k + 5;
+        p.ind[j++] = k + 3;
+        p.ind[j++] = k + 5;
+        p.ind[j++] = k + 3;
+        p.ind[j++] = k + 7;
     } // currently j = 12 * (Ninv - 1)
+    p.nOwn = j;
     // minor diameter
-    k = 8 * (Ninv + 1) * (N - 1); // vertex off neighbouring sector, around the world less one!
-    inds1[j++] = 4; // front face of gear disk
-    inds1[j++] = 6; // rear face of gear disk
-    inds1[j++] = k + 5; // front face, around the world
-    inds1[j++] = k + 5;
-    inds1[j++] = k + 7; // rear face, around the world
-    inds1[j++] = 6;
-    // if(ind_it[i] >= nVertices) ind_it[i] -= nVertices - 2;
+    p.ind[j++] = 4; // front face of gear disk
+    p.ind[j++] = 6; // rear face of gear disk
+    p.from[j] = prevSector;
+    p.ind[j++] = 5; // front face, around the world
+    p.from[j] = prevSector;
+    p.ind[j++] = 5;
+    p.from[j] = prevSector;
+    p.ind[j++] = 7; // rear face, around the world
+    p.ind[j++] = 6;
+    return p;
 }
 
-
-// 8 * N * (1 + Ninv) + 2 verticies per sector
-void gear::sectorI(unsigned int n)
+template<unsigned int n> constexpr bool ownPrefix(const sectorPattern<n> &p)
 {
-    unsigned int i;
-    const unsigned int Nmax = nVertices - 2, N1 = Ninv - 1;
-    std::vector<unsigned int>::iterator it0, it1;
-    const unsigned int dnv = 8 * (Ninv + 1) * n; // rotate sectors
-    const unsigned int nc1 = 12 * N1 + 6, nc2 = 12 * N1 + 9;
-    const unsigned int nc3 = 12 * N1 + 12, nc4 = 12 * N1 + 15;
-    unsigned int Ni;
-
-    it0 = ind_it0 + n * (12 * Ninv + 6); // the blank stuff (blue)
-    it1 = ind_it1 + n * (12 * Ninv - 6); // the cut stuff
-    Ni = 12 * Ninv + 6;
-    for(i=0; i<Ni; ++i){
-        it0[i] = inds0[i];
-        if(i != nc1 && i != nc2 && i != nc3 && i != nc4){
-            it0[i] += dnv; // don't move centres
-            if(it0[i] >= Nmax) it0[i] -= Nmax;  // move backwards around the world!
-        }
-    }
-    Ni = 12 * Ninv - 6;
-    for(i=0; i<Ni; ++i){
-        it1[i] = inds1[i] + dnv;
-        if(it1[i] >= Nmax) it1[i] -= Nmax;  // move backwards around the world!
-    }
+    for(unsigned int i=0; i<p.nOwn; ++i) if(p.from[i] != thisSector) return false;
+    return true;
 }
 
-
-// callculate involute with fillet radius for case where
-// fillet is entirely inside base circle
-void gear::sectorFillet()
+// both patterns for each gearDetail
+template<unsigned int Ninv> struct sectorPatterns
 {
-    float x0, y0, dtheta1, dtheta2;
-
-    {
-        float x, y, theta;
-
-        theta = - rp * sinpa / rbc; // angle where involute crosses base circle
-        x0 = filletR;
-        y0 = rbc; // put fillet tangent to y sector line at base circle radius
-        dtheta1 = pa + theta; // angle to rotate onto tooth
-        dtheta2 = gap * pi / (float) N; // rotate gear so middle of gullet is on y axis
-        dtheta1 += dtheta2;
-        x = x0 * cos(dtheta1) - y0 * sin(dtheta1);
-        y = x0 * sin(dtheta1) + y0 * cos(dtheta1); // now have height of fillet radius
-        if(y < rmin + filletR){ // fillet's on the involute
-            involute_fillet();
-            return;
-        }
-        // fillet is on the sector
-        float dy = rmin + filletR - y;
-        y += dy;
-        x -= dy * tan(dtheta2);
-        x0 = x;
-        y0 = y;
-        dtheta2 = -dtheta2;
-        x = x0 * cos(dtheta2) - y0 * sin(dtheta2);
-        y = x0 * sin(dtheta2) + y0 * cos(dtheta2);
-        x0 = x; // x0, y0 are centre coordinate of fillet
-        y0 = y;
-        dtheta1 = pa + theta; // angle from y axis where involute crosses base circle
-        dtheta2 = -dtheta2;   // angle to rotate gear so middle of gullet is on y axis
-    }
+    static constexpr sectorPattern<12 * Ninv + 6> blank = blankPattern<Ninv>();
+    static constexpr sectorPattern<12 * Ninv - 6> cut = cutPattern<Ninv>();
+    static_assert(ownPrefix(blank) && ownPrefix(cut), "sector patterns must start with their own sector's indicies");
+};
+template<unsigned int Ninv> constexpr sectorPattern<12 * Ninv + 6> sectorPatterns<Ninv>::blank;
+template<unsigned int Ninv> constexpr sectorPattern<12 * Ninv - 6> sectorPatterns<Ninv>::cut;
+
+// offset one pattern to its sector, the bulk is a plain add
+template<unsigned int n> inline void emitSector(const sectorPattern<n> &p, const unsigned int base[3], unsigned int *it)
+{
+    const unsigned int own = base[thisSector];
+    for(unsigned int i=0; i<p.nOwn; ++i) it[i] = p.ind[i] + own;
+    for(unsigned int i=p.nOwn; i<n; ++i) it[i] = p.ind[i] + base[p.from[i]];
+}
 
-    float x, y, r;
-    float xd, yd;
-    float theta, norm;
-    float cost, sint;
+template<unsigned int Ninv> void emitSectors(const unsigned int base[3], unsigned int *it0, unsigned int *it1)
+{
+    emitSector(sectorPatterns<Ninv>::blank, base, it0);
+    emitSector(sectorPatterns<Ninv>::cut, base, it1);
+}
 
-    // point on base circle, largest diameter of sector
-    //theta = -sinpa / cospa; // = -tan(pa)
-    theta = dtheta1 - pa;
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
-    y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-    invo_curve_x[Nfillet] = x;
-    invo_curve_y[Nfillet] = y;
-    xd = y; // start of sector, norm is tangent to base circle
-    yd = -x;
-    norm = 1.0f / sqrtf(xd * xd + yd * yd);
-    invo_curve_xn[Nfillet] = xd * norm;
-    invo_curve_yn[Nfillet] = yd * norm;
+// 8 * N * (1 + Ninv) + 2 verticies per sector
+void gear::sectorI(unsigned int n)
+{
+    sectorI(n, &ind_it0[n * (12 * Ninv + 6)], // the blank stuff (blue)
+               &ind_it1[n * (12 * Ninv - 6)]); // the cut stuff
+}
 
-    // fillets
-    float theta1, theta2;
-    theta1 = 1.5f * pi - dtheta2; // blend into gullet
-    theta2 = pi + dtheta1; // blend into sector
-    const float delTheta = (theta2 - theta1) / (float) (Nfillet - 1);
-    theta = theta1;
-    for(unsigned int i=0; i<Nfillet; ++i){
-        cost = cos(theta);
-        sint = sin(theta);
-        x = x0 + filletR * cost;
-        y = y0 + filletR * sint;
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        norm = 1.0f / sqrtf(cost * cost + sint * sint);
-        invo_curve_xn[i] = -cost * norm;
-        invo_curve_yn[i] = -sint * norm;
-        theta += delTheta;
-    }
+void gear::sectorI(unsigned int n, unsigned int *it0, unsigned int *it1)
+{
+    const unsigned int spv = 8 * (Ninv + 1); // verticies per sector
+    const unsigned int base[3] = {spv * n, // this sector
+                                  spv * ((n + N - 1) % N), // previous sector, around the world for sector 0
+                                  nVertices - 2}; // centres
 
-    theta = -0.5f * sinpa / cospa; // half way between pitch circle and base circle
-    const float dr = (rmaj - rbc) / (float) (Ninv - Nfillet - 1);
-    for(unsigned int i=Nfillet+1; i<Ninv; ++i){
-        r = (float)(i - Nfillet) * dr + rbc;
-        NewtonRaphson(6, r, theta, x, y);
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        xd = -y + rp * cospa * cos(pa + theta);
-        yd = x + rp * cospa * sin(pa + theta);
-        norm = 1.0f / sqrtf(xd * xd + yd * yd);
-        invo_curve_xn[i] = yd * norm;
-        invo_curve_yn[i] = -xd * norm;
-    }
+    if(Ninv == NinvCoarse) emitSectors<NinvCoarse>(base, it0, it1);
+    else emitSectors<NinvFine>(base, it0, it1);
 }
 
 
-// callculate involute with fillet radius for case where
-// fillet is tangent to involute
-void gear::involute_fillet()
+void gear::RotateVerts(float theta)
 {
-    float x, y, dx, dy;
-    float theta, beta;
-    float hPrime;
-    const float gamma = 2.0f * gap * pi / (float) N;
-    const float sing = sin(gamma), cosg = cos(gamma);
-
-    theta = 0.0f;
-    float cost, sint;
-    float xf, yf, dh;
-    // find where involute meets fillet
-    for(int i=0; i<6; ++i){
-        cost = cos(pa + theta);
-        sint = sin(pa + theta);
-        x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
-        y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-        // derivatives wrt theta
-        dx = -y + rp * cospa * cost;
-        dy = x + rp * cospa * sint;
-        beta = -atan(dx / dy);
-        xf = x + filletR * cos(beta);
-        yf = y + filletR * sin(beta);
-        hPrime = sing * xf + cosg * yf;
-        dh = hPrime - rmin - filletR;
+    TRACE_SCOPE("gear::RotateVerts");
+    rotateVerts(verts.data(), nVertices, theta);
+}
 
-        // now calculate derivative of gradient
-        float ddx, ddy, gdd, dhPrime;
-        ddx = -dy - rp * cospa * sint;
-        ddy = dx + rp * cospa * cost;
-        // gdd is d/d_theta (dx / dy)
-        gdd = ddx / dy - dx * ddy / (dy * dy);
-        float dxdy = dx / dy;
-        float dBeta_dTheta = -1.0f / (1.0f + dxdy * dxdy) * gdd;
-        dhPrime = sing * (dx - filletR * sin(beta) * dBeta_dTheta);
-        dhPrime += cosg * (dy + filletR * cos(beta) * dBeta_dTheta);
-        theta -= dh / dhPrime;
-    }
+void rotateVerts(float *v, std::size_t n, float theta)
+{
+    theta = pi * theta / 180.0f;
+    const float cosx = cos(theta);
+    const float sinx = sin(theta);
+    float x, y;
 
-    // fillets
-    float r = sqrt(x * x + y * y); // currently smallest diameter of involute
-    float x0 = x + filletR * cos(beta);
-    float y0 = y + filletR * sin(beta);
-    float theta1 = 1.5f * pi - gap * pi / (float) N; // blend into gullet
-    float theta2 = pi + beta; // blend into tooth
-    const float delTheta = (theta2 - theta1) / (float) (Nfillet - 1);
-    theta = theta1;
-    float norm;
-    for(unsigned int i=0; i<Nfillet; ++i){
-        cost = cos(theta);
-        sint = sin(theta);
-        x = x0 + filletR * cost;
-        y = y0 + filletR * sint;
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        norm = 1.0f / sqrtf(cost * cost + sint * sint);
-        invo_curve_xn[i] = -cost * norm;
-        invo_curve_yn[i] = -sint * norm;
-        theta += delTheta;
-    }
-    theta = 0.0f;
-    float dr = (rmaj - r) / (float) (Ninv - Nfillet);
-    for(unsigned int i=Nfillet; i<Ninv; ++i){
-        r += dr;
-        NewtonRaphson(6, r, theta, x, y);
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        dx = -y + rp * cospa * cos(pa + theta);
-        dy = x + rp * cospa * sin(pa + theta);
-        norm = 1.0f / sqrt(dx * dx + dy * dy);
-        invo_curve_xn[i] = dy * norm;
-        invo_curve_yn[i] = -dx * norm;
+    for(std::size_t i=0, j; i<n; ++i){
+        j = i * 6;
+        x = v[j];
+        y = v[j+1];
+        v[j] = cosx * x - sinx * y;
+        v[j+1] = sinx * x + cosx * y;
+        x = v[j+3];
+        y = v[j+4];
+        v[j+3] = cosx * x - sinx * y;
+        v[j+4] = sinx * x + cosx * y;
     }
 }
 
-// method calls computation of the verticies for the involute and
-// stores them in arrays invo_curve_x[], invo_curve_y[]
-void gear::involute()
-{
-    sectorFillet();
-}
 
-// find coords to bring involute curve to distance r from centre
-// theta inputs initial guess for its value, x and y input are garbage
-void gear::NewtonRaphson(unsigned int n, const float r, float &theta, float &x, float &y)
+// find coords to bring involute curve to distance rp * fac from centre
+// returns their polar angle in degrees, used to phase a meshing pair
+float involutePhase(const unsigned int n, const float rp, const float fac, const float pa)
 {
     float cost, sint;
+    float x, y;
     float dx, dy, dr;
     float rx;
     float del_theta;
+    float theta = 0.05f;
+    //const float rp = 0.5 * (float) N;
+    //const float r = rp + del;
+    const float r = rp * fac;
+    const float sinpa = sin(pa), cospa = cos(pa);
+    const float rbc = rp * cospa;
 
     for(unsigned int i=0; i<n; ++i){
         cost = cos(pa + theta);
@@ -570,52 +946,18 @@ void gear::NewtonRaphson(unsigned int n, const float r, float &theta, float &x,
         dr /= rx;
         del_theta = (r - rx) / dr;
         theta += del_theta;
+        //std::cout << "theta = " << theta << ", rx = " << rx << ", r = " << r << std::endl;
     }
     cost = cos(pa + theta);
     sint = sin(pa + theta);
     x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
     y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-    rx = sqrtf(x * x + y * y);
-}
-
-
-// returns the tangent angle at given point on the involute
-float gear::tangent(float theta)
-{
-    float dx, dy;
-    float cost, sint;
-
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    dx = -rbc * cost + rp * cospa * cost - rp * (sinpa + theta * cospa) * sint;
-    dy = -rbc * sint + rp * cospa * sint + rp * (sinpa + theta * cospa) * cost;
-    return atan(-dx / dy);
-}
-
-
-void gear::RotateVerts(float theta)
-{
-    theta = pi * theta / 180.0f;
-    const float cosx = cos(theta);
-    const float sinx = sin(theta);
-    float x, y;
-
-    for(unsigned int i=0, j; i<nVertices; ++i){
-        j = i * 6;
-        x = verts[j];
-        y = verts[j+1];
-        verts[j] = cosx * x - sinx * y;
-        verts[j+1] = sinx * x + cosx * y;
-        x = verts[j+3];
-        y = verts[j+4];
-        verts[j+3] = cosx * x - sinx * y;
-        verts[j+4] = sinx * x + cosx * y;
-    }
+    return atan(x/y) * 180.0f / 3.141592654; // convert from
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////////
-/////// Polymorphic Class which uses circle approximation for involute /////////////
+/////// Class which uses circle approximation for involute ///////////////////////
 ////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -646,225 +988,10 @@ float rmajCalc(unsigned int N, float pa)
     return rmaj;
 }
 
-gearApprox::gearApprox(unsigned int Ni, float pai, float dZ):gear(Ni, pai, dZ, rmajCalc(Ni, pai))
+gearApprox::gearApprox(unsigned int Ni, float pai, float dZ, gearBuild build, gearDetail detail, gearPrecision precision):
+    gear(Ni, pai, dZ, rmajCalc(Ni, pai), build, detail, precision)
 {
-    sectorVerts();
-    for(unsigned int i=0; i<N; ++i) sectorV(i);
-    sectorIndicies();
-    for(unsigned int i=0; i<N; ++i) sectorI(i);
+    TRACE_SCOPE("gearApprox::gearApprox");
+    rCircle = rp * sinpa;
+    generate<involuteApproxOf>();
 }
-
-
-// callculate involute with fillet radius for case where
-// fillet is entirely inside base circle
-// uses circle approximation for involute
-void gearApprox::sectorFillet()
-{
-    float x0, y0, dtheta1, dtheta2;
-
-    {
-        float x, y, theta;
-
-        theta = - rp * sinpa / rbc; // angle where involute crosses base circle
-        x0 = filletR;
-        y0 = rbc; // put fillet tangent to y sector line at base circle radius
-        dtheta1 = pa + theta; // angle to rotate onto tooth
-        dtheta2 = gap * pi / (float) N; // rotate gear so middle of gullet is on y axis
-        dtheta1 += dtheta2;
-        x = x0 * cos(dtheta1) - y0 * sin(dtheta1);
-        y = x0 * sin(dtheta1) + y0 * cos(dtheta1); // now have height of fillet radius
-        if(y < rmin + filletR){ // fillet's on the involute
-            involute_fillet();
-            return;
-        }
-        // fillet is on the sector
-        float dy = rmin + filletR - y;
-        y += dy;
-        x -= dy * tan(dtheta2);
-        x0 = x;
-        y0 = y;
-        dtheta2 = -dtheta2;
-        x = x0 * cos(dtheta2) - y0 * sin(dtheta2);
-        y = x0 * sin(dtheta2) + y0 * cos(dtheta2);
-        x0 = x; // x0, y0 are centre coordinate of fillet
-        y0 = y;
-        dtheta1 = pa + theta; // angle from y axis where involute crosses base circle
-        dtheta2 = -dtheta2;   // angle to rotate gear so middle of gullet is on y axis
-    }
-
-    float x, y, r;
-    float xd, yd;
-    float theta, norm;
-    float cost, sint;
-
-    // point on base circle, largest diameter of sector
-    //theta = -sinpa / cospa; // = -tan(pa)
-    theta = dtheta1 - pa;
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
-    y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-    invo_curve_x[Nfillet] = x;
-    invo_curve_y[Nfillet] = y;
-    xd = y; // start of sector, norm is tangent to base circle
-    yd = -x;
-    norm = 1.0f / sqrtf(xd * xd + yd * yd);
-    invo_curve_xn[Nfillet] = xd * norm;
-    invo_curve_yn[Nfillet] = yd * norm;
-
-    // fillets
-    float theta1, theta2;
-    theta1 = 1.5f * pi - dtheta2; // blend into gullet
-    theta2 = pi + dtheta1; // blend into sector
-    const float delTheta = (theta2 - theta1) / (float) (Nfillet - 1);
-    theta = theta1;
-    for(unsigned int i=0; i<Nfillet; ++i){
-        cost = cos(theta);
-        sint = sin(theta);
-        x = x0 + filletR * cost;
-        y = y0 + filletR * sint;
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        norm = 1.0f / sqrtf(cost * cost + sint * sint);
-        invo_curve_xn[i] = -cost * norm;
-        invo_curve_yn[i] = -sint * norm;
-        theta += delTheta;
-    }
-
-    theta = -0.5f * sinpa / cospa; // half way between pitch circle and base circle
-    const float dr = (rmaj - rbc) / (float) (Ninv - Nfillet - 1);
-    for(unsigned int i=Nfillet+1; i<Ninv; ++i){
-        r = (float)(i - Nfillet) * dr + rbc;
-        NewtonRaphson(6, r, theta, x, y);
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        xd = -y + rp * cospa * cospa;
-        yd = x + rp * cospa * sinpa;
-        norm = 1.0f / sqrtf(xd * xd + yd * yd);
-        invo_curve_xn[i] = yd * norm;
-        invo_curve_yn[i] = -xd * norm;
-    }
-}
-
-
-// callculate involute with fillet radius for case where
-// fillet is tangent to involute
-// uses circle approximation for involute
-void gearApprox::involute_fillet()
-{
-    float x, y, dx, dy;
-    float theta, beta;
-    float hPrime;
-    const float gamma = 2.0f * gap * pi / (float) N;
-    const float sing = sin(gamma), cosg = cos(gamma);
-
-    theta = 0.0f;
-    float cost, sint;
-    float xf, yf, dh;
-    // find where involute meets fillet
-    for(int i=0; i<6; ++i){
-        cost = cos(pa + theta);
-        sint = sin(pa + theta);
-        x = -rbc * sinpa + rp * sinpa * cost;
-        y = rbc * cospa + rp * sinpa * sint;
-        // derivatives wrt theta
-        dx = -y + rp * cospa * cospa;
-        dy = x + rp * cospa * sinpa;
-        beta = -atan(dx / dy);
-        xf = x + filletR * cos(beta);
-        yf = y + filletR * sin(beta);
-        hPrime = sing * xf + cosg * yf;
-        dh = hPrime - rmin - filletR;
-
-        // now calculate derivative of gradient
-        float ddx, ddy, gdd, dhPrime;
-        ddx = -dy;
-        ddy = dx;
-        // gdd is d/d_theta (dx / dy)
-        gdd = ddx / dy - dx * ddy / (dy * dy);
-        float dxdy = dx / dy;
-        float dBeta_dTheta = -1.0f / (1.0f + dxdy * dxdy) * gdd;
-        dhPrime = sing * (dx - filletR * sin(beta) * dBeta_dTheta);
-        dhPrime += cosg * (dy + filletR * cos(beta) * dBeta_dTheta);
-        theta -= dh / dhPrime;
-    }
-
-    // fillets
-    float r = sqrt(x * x + y * y); // currently smallest diameter of involute
-    float x0 = x + filletR * cos(beta);
-    float y0 = y + filletR * sin(beta);
-    float theta1 = 1.5f * pi - gap * pi / (float) N; // blend into gullet
-    float theta2 = pi + beta; // blend into tooth
-    const float delTheta = (theta2 - theta1) / (float) (Nfillet - 1);
-    theta = theta1;
-    float norm;
-    for(unsigned int i=0; i<Nfillet; ++i){
-        cost = cos(theta);
-        sint = sin(theta);
-        x = x0 + filletR * cost;
-        y = y0 + filletR * sint;
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        norm = 1.0f / sqrtf(cost * cost + sint * sint);
-        invo_curve_xn[i] = -cost * norm;
-        invo_curve_yn[i] = -sint * norm;
-        theta += delTheta;
-    }
-    theta = 0.0f;
-    float dr = (rmaj - r) / (float) (Ninv - Nfillet);
-    for(unsigned int i=Nfillet; i<Ninv; ++i){
-        r += dr;
-        NewtonRaphson(6, r, theta, x, y);
-        invo_curve_x[i] = x;
-        invo_curve_y[i] = y;
-        dx = -y + rp * cospa * cospa;
-        dy = x + rp * cospa * sinpa;
-        norm = 1.0f / sqrt(dx * dx + dy * dy);
-        invo_curve_xn[i] = dy * norm;
-        invo_curve_yn[i] = -dx * norm;
-    }
-}
-
-// find coords to bring involute curve to distance r from centre
-// theta inputs initial guess for its value, x and y input are garbage
-void gearApprox::NewtonRaphson(unsigned int n, const float r, float &theta, float &x, float &y)
-{
-    float cost, sint;
-    float dx, dy, dr;
-    float rx;
-    float del_theta;
-
-    for(unsigned int i=0; i<n; ++i){
-        cost = cos(pa + theta);
-        sint = sin(pa + theta);
-        x = -rbc * sinpa + rp * sinpa * cost;
-        y = rbc * cospa + rp * sinpa * sint;
-        rx = sqrtf(x * x + y * y);
-        dx = -y + rp * cospa * cospa;
-        dy = x + rp * cospa * sinpa;
-        dr = x * dx + y * dy;
-        dr /= rx;
-        del_theta = (r - rx) / dr;
-        theta += del_theta;
-    }
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    x = -rbc * sinpa + rp * sinpa * cost;
-    y = rbc * cospa + rp * sinpa * sint;
-    rx = sqrtf(x * x + y * y);
-}
-
-
-// returns the tangent angle at given point on the involute
-float gearApprox::tangent(float theta)
-{
-    float dx, dy;
-    float cost, sint;
-
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    dx = -rp * sinpa * sint;
-    dy = rp * sinpa * cost;
-    return atan(-dx / dy);
-}
-
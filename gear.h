@@ -5,52 +5,135 @@
 #ifndef GEAR_H
 #define GEAR_H
 
+// bump whenever the generated geometry changes, along with golden_meshes.txt,
+// it invalidates any prebuilt mesh library
+const unsigned int gearGeneratorVersion = 1;
+
+// full builds the whole gear, sectors makes just the one tooth template
+// so a very large gear can be streamed out a sector at a time
+enum class gearBuild { full, sectors };
+
+// verticies along each flank, fine is 20 with 9 in the root fillet, coarse 8 with 3,
+// it leans on the shader's analytic flank normals to look as smooth
+enum class gearDetail { fine, coarse };
+
+// the profile and sector maths in float, or in double and only rounded to float as
+// each vertex is written, which keeps very large tooth counts true to a float's precision
+enum class gearPrecision { floats, doubles };
+
+// tooth profiles, the exact involute and its circle approximation, in scalar T
+template<class T> struct involuteExactOf;
+template<class T> struct involuteApproxOf;
+using involuteExact = involuteExactOf<float>;
+using involuteApprox = involuteApproxOf<float>;
+
+// a gear's dimensions in scalar T
+template<class T> struct toothParams;
+
+// one tooth in scalar T, a flank fillet first then both flanks of tooth 0
+template<class T> struct toothOutline
+{
+    std::vector<T> invo_curve_x, invo_curve_y, invo_curve_xn, invo_curve_yn;
+    std::vector<T> vertx, verty, vertxn, vertyn;
+};
+
 class gear
 {
 public:
-    gear(unsigned int Ni, float pai, float dZ);
+    gear(unsigned int Ni, float pai, float dZ, gearBuild build = gearBuild::full, gearDetail detail = gearDetail::fine,
+         gearPrecision precision = gearPrecision::floats);
     virtual ~gear();
     std::vector<float>& GetVerts(){ return verts; }
     std::vector<unsigned int>& GetInds(){ return inds; }
     unsigned int GetNInds(){ return nIndices; }
     unsigned int GetN1Inds(){ return n1indices; }
     unsigned int GetNverts() { return nVertices; }
+    float GetRmaj() const { return rmaj; }
+    float GetRmin() const { return rmin; }
+    float GetPa() const { return pa; }
     void RotateVerts(float);
+    // sector (one tooth) at a time, works for either build
+    unsigned int GetN() const { return N; }
+    unsigned int GetSectorNverts() const;
+    unsigned int GetSectorNInds() const;
+    void SectorVerts(unsigned int n, float *vr); // 6 floats per vertex, GetSectorNverts() of them
+    void SectorInds(unsigned int n, unsigned int *it); // the blank's then the cut surface's, GetSectorNInds() of them
+    void SectorInds(unsigned int n, unsigned int *blank, unsigned int *cut); // the two apart, as a full gear lays them out
+    const float* GetCentreVerts() const { return &*vert_it; } // 2 verticies, last in the vertex list
+    // 2D outline of tooth 0, first flank root to tip then second flank root to tip
+    const std::vector<float>& GetToothX() const { return tooth.vertx; }
+    const std::vector<float>& GetToothY() const { return tooth.verty; }
+    const std::vector<float>& GetToothXn() const { return tooth.vertxn; } // unit normals of the outline
+    const std::vector<float>& GetToothYn() const { return tooth.vertyn; }
+    float GetDelZ() const { return delZ; } // faces at +-delZ
+    // for recomputing the flank normals from the radius: base circle radius, radius the flank
+    // starts at above the fillet, radius of the approximating circle (0 for the true involute)
+    void GetFlankShading(float s[3]) const;
+    float GetFilletR() const; // of the root fillets
+    std::size_t GetBytes() const; // the object and every vector it holds, by capacity
+    gearPrecision GetPrecision() const { return bDouble ? gearPrecision::doubles : gearPrecision::floats; }
+    // the tooth and any sector worked out wholly in T (float, double or long double)
+    // whatever the gear's precision, to measure its vertices against
+    template<class T> toothOutline<T> OutlineIn() const;
+    template<class T> void SectorVertsIn(unsigned int n, const toothOutline<T> &o, T *vr) const;
 protected:
-    gear(unsigned int Ni, float pai, float dZ, float rmaji);
+    gear(unsigned int Ni, float pai, float dZ, float rmaji, gearBuild build, gearDetail detail, gearPrecision precision);
+    template<class T> toothParams<T> params() const;
+    template<class P> P profile() const;
+    template<template<class> class P> void generate();
+    template<class T> void sizeOutline(toothOutline<T> &o) const;
+    template<class T> void toothFlanks(toothOutline<T> &o) const;
     void sectorVerts();
-    void sectorIndicies();
     void sectorV(unsigned int n);
+    void sectorV(unsigned int n, float *vr);
+    // T the maths, V the vertices written
+    template<class T, class V> void sectorV(unsigned int n, const toothOutline<T> &o, V *vr) const;
     void sectorI(unsigned int n);
-    void involute();
-    virtual void sectorFillet();
-    virtual void involute_fillet();
-    virtual void NewtonRaphson(unsigned int n, const float r, float &theta, float &x, float &y);
-    virtual float tangent(float theta);
+    void sectorI(unsigned int n, unsigned int *it0, unsigned int *it1);
+    // profile of one flank, P is the tooth profile, into tooth or o
+    template<class P> void sectorFillet() { sectorFillet<P>(tooth); }
+    template<class P> void involute_fillet() { involute_fillet<P>(tooth); }
+    template<class P, class T> void sectorFillet(toothOutline<T> &o) const; // T is P's scalar
+    template<class P, class T> void involute_fillet(toothOutline<T> &o) const;
+    template<class P, class T> void NewtonRaphson(unsigned int n, const T r, T &theta, T &x, T &y) const;
 
-    const unsigned int N, nVertices, nIndices, n1indices;
+    const unsigned int N, Ninv, Nfillet, nVertices, nIndices, n1indices; // Ninv verticies a flank, Nfillet of them the fillet
     // pitch radius, base circle radius, major radius, minor radius
     const float rp, rbc, rmaj, rmin, delZ;
     const float pa, cospa, sinpa;
+    const bool bFull;
+    const bool bDouble; // gearPrecision::doubles, the maths is done in toothD
     float delTheta = 0.0f;
+    float rCircle = 0.0f; // gearApprox's profile circle
     std::vector<float> verts;
     std::vector<float>::iterator vert_it;
-    std::vector<float> vertx, verty, vertxn, vertyn;
     std::vector<unsigned int> inds;
-    std::vector<unsigned int> inds0, inds1; // two colours
     std::vector<unsigned int>::iterator ind_it0, ind_it1;
-    std::vector<float> invo_curve_x, invo_curve_y, invo_curve_xn, invo_curve_yn;
+    toothOutline<float> tooth; // always, GetToothX() and the shading read it
+    toothOutline<double> toothD; // empty for gearPrecision::floats
 };
 
 class gearApprox:public gear
 {
 public:
-    gearApprox(unsigned int Ni, float pai, float dZ);
-private:
-    void sectorFillet();
-    void involute_fillet();
-    void NewtonRaphson(unsigned int n, const float r, float &theta, float &x, float &y);
-    float tangent(float theta);
+    gearApprox(unsigned int Ni, float pai, float dZ, gearBuild build = gearBuild::full, gearDetail detail = gearDetail::fine,
+               gearPrecision precision = gearPrecision::floats);
 };
 
+// n verticies of 6 floats turned theta degrees about z, as gear::RotateVerts
+void rotateVerts(float *v, std::size_t n, float theta);
+
+// verticies along each flank
+unsigned int flankVerts(gearDetail detail);
+
+// what GetBytes() will come to, worked out from the counts without building the gear
+std::size_t gearBytes(unsigned int N, gearBuild build = gearBuild::full, gearDetail detail = gearDetail::fine,
+                      gearPrecision precision = gearPrecision::floats);
+
+// major radius used by gearApprox, short of a razor sharp tooth
+float rmajCalc(unsigned int N, float pa);
+
+// angle (degrees) of the involute of a gear with pitch radius rp where it crosses radius rp*fac
+float involutePhase(const unsigned int n, const float rp, const float fac, const float pa);
+
 #endif // GEAR_H
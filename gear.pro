@@ -13,6 +13,9 @@ win32: QT += winextras
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
+# qmake CONFIG+=trace to record Chrome trace events, W key writes gear_trace.json
+trace: DEFINES += GEAR_TRACE
+
 TARGET = gear
 TEMPLATE = app
 
@@ -20,12 +23,40 @@ TEMPLATE = app
 SOURCES += main.cpp\
         widget.cpp\
         gear.cpp\
+        phasebatch.cpp\
+        helical.cpp\
+        gearpair.cpp\
+        gearsdf.cpp\
+        meshcache.cpp\
+        precompute.cpp\
+        trace.cpp\
+        gearexport.cpp\
+        meshlib.cpp\
+        interference.cpp\
+        transmission.cpp\
+        gearpick.cpp\
+        cli.cpp\
+        eventlog.cpp\
         oglwidget.cpp \
         scroller.cpp
 
 HEADERS  += myshaders.h \
         widget.h\
         gear.h\
+        phasebatch.h\
+        helical.h\
+        gearpair.h\
+        gearsdf.h\
+        meshcache.h\
+        precompute.h\
+        trace.h\
+        gearexport.h\
+        meshlib.h\
+        interference.h\
+        transmission.h\
+        gearpick.h\
+        cli.h\
+        eventlog.h\
         oglwidget.h\
         scroller.h
 
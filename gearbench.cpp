@@ -0,0 +1,521 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+// Self contained micro benchmarks of gear generation and the involute maths,
+// doesn't need Qt or OpenGL, build with gearbench.pro
+// usage: gearbench [--json file] [--filter text] [--min-time seconds]
+// also checks the generator against golden meshes, see meshcheck.h
+//        gearbench --golden-check golden_meshes.txt [--ref-dir dir] [--tolerance t]
+//        gearbench --golden-write golden_meshes.txt [--ref-dir dir]
+// and reports each gearPrecision's vertex error against long double
+//        gearbench --precision [N,N,...]
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <ctime>
+#include <cmath>
+#include "gear.h"
+#include "meshcheck.h"
+#include "interference.h"
+#include "transmission.h"
+#include "phasebatch.h"
+#include "helical.h"
+#include "gearpair.h"
+#include "gearpick.h"
+
+namespace {
+
+// the three pressure angles offered by the GUI, in degrees
+const float paDegrees[3] = {14.5f, 20.0f, 25.0f};
+
+float radians(float deg)
+{
+    return static_cast<float>(deg * 3.14159265358979323846 / 180.0);
+}
+
+// exposes the protected profile maths, G is the gear and P its tooth profile
+template<class G, class P> class benchGear : public G
+{
+public:
+    benchGear(unsigned int Ni, float pai) : G(Ni, pai, 5.0f) {}
+    void NewtonRaphson(unsigned int n, const float r, float &theta, float &x, float &y) const
+    {
+        G::template NewtonRaphson<P>(n, r, theta, x, y);
+    }
+    void sectorFillet() { G::template sectorFillet<P>(); }
+    void involute_fillet() { G::template involute_fillet<P>(); }
+    float baseRadius() const { return this -> rbc; }
+    float majorRadius() const { return this -> rmaj; }
+};
+
+struct benchResult
+{
+    std::string name;
+    long long iterations;
+    double ns; // per iteration, median of the repetitions
+};
+
+class benchRunner
+{
+public:
+    benchRunner(const std::string &ifilter, double iminTime) : filter(ifilter), minTime(iminTime) {}
+
+    // time f(), first finding an iteration count which takes about minTime / reps
+    template<class F> void run(const std::string &name, F f)
+    {
+        if(!filter.empty() && name.find(filter) == std::string::npos) return;
+
+        const double target = minTime / reps;
+        long long n = 1;
+        double t;
+        for(;;){
+            t = timeIt(n, f);
+            if(t >= target || n >= (1LL << 40)) break;
+            n = (t > 0.0) ? std::max(2 * n, static_cast<long long>(1.2 * n * target / t)) : 10 * n;
+        }
+        std::vector<double> times(reps);
+        for(auto &x: times) x = timeIt(n, f) * 1.0e9 / n;
+        std::sort(times.begin(), times.end());
+        results.push_back(benchResult{name, n, times[reps / 2]});
+        std::cout << std::left << std::setw(44) << name << std::right << std::setw(16) << std::fixed;
+        std::cout << std::setprecision(1) << results.back().ns << " ns" << std::setw(14) << n << std::endl;
+    }
+
+    bool writeJson(const std::string &fileName) const
+    {
+        std::ofstream fout(fileName);
+        if(!fout) return false;
+        std::time_t now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+        fout << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n";
+        fout << "    \"executable\": \"gearbench\",\n";
+        fout << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+        fout << "    \"min_time\": " << minTime << "\n  },\n  \"benchmarks\": [\n";
+        for(std::size_t i=0; i<results.size(); ++i){
+            const benchResult &r = results[i];
+            fout << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations;
+            fout << ", \"real_time\": " << std::setprecision(3) << std::fixed << r.ns;
+            fout << ", \"time_unit\": \"ns\"}" << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        fout << "  ]\n}\n";
+        return static_cast<bool>(fout);
+    }
+
+private:
+    template<class F> static double timeIt(long long n, F &f)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for(long long i=0; i<n; ++i) f();
+        std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+        return dt.count();
+    }
+
+    static const int reps = 5;
+    const std::string filter;
+    const double minTime;
+    std::vector<benchResult> results;
+};
+
+volatile float sink; // stops results being optimised away
+
+std::string caseName(const char *what, unsigned int N, float paDeg)
+{
+    std::ostringstream os;
+    os << what << "/N:" << N << "/pa:" << std::setprecision(3) << paDeg;
+    return os.str();
+}
+
+template<class G> void benchProfile(benchRunner &bench, const char *what, unsigned int N, float paDeg)
+{
+    G g(N, radians(paDeg));
+    const float r = 0.5f * (g.baseRadius() + g.majorRadius());
+
+    bench.run(caseName((std::string(what) + "/NewtonRaphson").c_str(), N, paDeg), [&]{
+        float theta = 0.0f, x, y;
+        g.NewtonRaphson(6, r, theta, x, y);
+        sink = x + y;
+    });
+    bench.run(caseName((std::string(what) + "/sectorFillet").c_str(), N, paDeg), [&]{ g.sectorFillet(); });
+    bench.run(caseName((std::string(what) + "/involute_fillet").c_str(), N, paDeg), [&]{ g.involute_fillet(); });
+}
+
+// the fragment shader's flank normal (myshaders.h) at x, y on the cut surface, s from
+// gear::GetFlankShading, the interpolated vertex normal nx, ny only picks the flank
+void analyticNormal(const float s[3], float x, float y, float nx, float ny, float &ox, float &oy)
+{
+    const float r = std::sqrt(x * x + y * y), rbc = s[0], rho = s[2];
+    const float ux = x / r, uy = y / r;
+    float c = rho > 0.0f ? (r * r + rbc * rbc - rho * rho) / (2.0f * r * rbc) : rbc / r;
+    c = std::min(0.999999f, std::max(-1.0f, c)); // tangent to the base circle on it
+    const float a = (r - rbc * c) * (nx * ux + ny * uy < 0.0f ? -1.0f : 1.0f);
+    const float b = rbc * std::sqrt(1.0f - c * c) * (ny * ux - nx * uy < 0.0f ? -1.0f : 1.0f);
+    const float len = std::sqrt(a * a + b * b);
+    ox = (a * ux - b * uy) / len;
+    oy = (a * uy + b * ux) / len;
+}
+
+// point and interpolated normal where the first flank of the outline crosses radius r
+void flankAt(const gear &g, unsigned int first, float r, float &x, float &y, float &nx, float &ny)
+{
+    const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+    const std::vector<float> &txn = g.GetToothXn(), &tyn = g.GetToothYn();
+    unsigned int i = first;
+    const unsigned int last = static_cast<unsigned int>(tx.size()) / 2 - 1;
+    while(i + 1 < last && tx[i+1] * tx[i+1] + ty[i+1] * ty[i+1] < r * r) ++i;
+    // |p + t d| = r along the chord
+    const float dx = tx[i+1] - tx[i], dy = ty[i+1] - ty[i];
+    const float qa = dx * dx + dy * dy, qb = tx[i] * dx + ty[i] * dy, qc = tx[i] * tx[i] + ty[i] * ty[i] - r * r;
+    float t = (-qb + std::sqrt(std::max(0.0f, qb * qb - qa * qc))) / qa;
+    t = std::min(1.0f, std::max(0.0f, t));
+    x = tx[i] + t * dx;
+    y = ty[i] + t * dy;
+    nx = txn[i] + t * (txn[i+1] - txn[i]);
+    ny = tyn[i] + t * (tyn[i+1] - tyn[i]);
+    const float len = std::sqrt(nx * nx + ny * ny);
+    nx /= len;
+    ny /= len;
+}
+
+// Lambert shading of the involute flank, against the true flank, for each
+// gearDetail with the vertex normals and with the shader's analytic ones.
+// A spur flank's image only changes across the flank, so the image is its
+// shading at every radius from the fillet to the tip under lights all round
+void flankShading(unsigned int N, float paDeg)
+{
+    const float pa = radians(paDeg);
+    const unsigned int nr = 512, nl = 256;
+
+    for(gearDetail detail: {gearDetail::fine, gearDetail::coarse}){
+        const gear g(N, pa, 5.0f, gearBuild::sectors, detail);
+        const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+        float s[3];
+        g.GetFlankShading(s);
+        const float rbc = s[0];
+        auto inv = [rbc](float r){ const float a = std::acos(std::min(1.0f, rbc / r)); return std::tan(a) - a; };
+        // first vertex of the profile proper, on the true involute
+        unsigned int first = 0;
+        while(tx[first] * tx[first] + ty[first] * ty[first] < s[1] * s[1] * (1.0f - 1.0e-5f)) ++first;
+        const float rf = std::sqrt(tx[first] * tx[first] + ty[first] * ty[first]), phif = std::atan2(ty[first], tx[first]);
+        const float sense = std::atan2(ty[first+1], tx[first+1]) > phif ? 1.0f : -1.0f;
+        float vertexErr = 0.0f, analyticErr = 0.0f, sag = 0.0f;
+        for(unsigned int k=0; k<=nr; ++k){
+            const float r = rf + (g.GetRmaj() - rf) * static_cast<float>(k) / static_cast<float>(nr);
+            float x, y, nx, ny, ax, ay, rx, ry;
+            flankAt(g, first, r, x, y, nx, ny);
+            analyticNormal(s, x, y, nx, ny, ax, ay);
+            // the true flank at this radius, turned from the first vertex by the involute function
+            const float phi = phif + sense * (inv(r) - inv(rf));
+            sag = std::max(sag, r * std::fabs(std::atan2(y, x) - phi));
+            analyticNormal(s, r * std::cos(phi), r * std::sin(phi), nx, ny, rx, ry);
+            for(unsigned int l=0; l<nl; ++l){
+                const float lx = std::cos(6.2831853f * l / nl), ly = std::sin(6.2831853f * l / nl);
+                const float ref = std::max(0.0f, rx * lx + ry * ly);
+                vertexErr = std::max(vertexErr, std::fabs(std::max(0.0f, nx * lx + ny * ly) - ref));
+                analyticErr = std::max(analyticErr, std::fabs(std::max(0.0f, ax * lx + ay * ly) - ref));
+            }
+        }
+        std::cout << caseName(detail == gearDetail::fine ? "flankShading/fine" : "flankShading/coarse", N, paDeg);
+        std::cout << std::fixed << std::setprecision(2) << "  triangles/tooth " << g.GetSectorNInds() / 3;
+        std::cout << "  vertex normals " << 255.0f * vertexErr << " levels, analytic " << 255.0f * analyticErr;
+        std::cout << " levels, flank off true " << std::scientific << std::setprecision(1) << sag << " module" << std::endl;
+    }
+}
+
+// how far one gear's vertices stray from the same sectors worked out wholly in long double,
+// over a spread of sectors, and the least a float could be out there
+struct precisionError
+{
+    double mesh = 0.0, floor = 0.0; // module
+};
+
+precisionError meshError(gear &g, unsigned int samples)
+{
+    const toothOutline<long double> ref = g.OutlineIn<long double>();
+    const unsigned int N = g.GetN(), nv = g.GetSectorNverts();
+    std::vector<float> v(6 * nv);
+    std::vector<long double> r(6 * nv);
+    precisionError e;
+    samples = std::min(samples, N);
+    for(unsigned int k=0; k<samples; ++k){
+        const unsigned int n = samples > 1 ? static_cast<unsigned int>((N - 1) * static_cast<unsigned long long>(k) / (samples - 1)) : 0;
+        g.SectorVerts(n, v.data());
+        g.SectorVertsIn(n, ref, r.data());
+        for(unsigned int i=0; i<6*nv; i+=6){
+            const long double dx = v[i] - r[i], dy = v[i+1] - r[i+1];
+            const long double fx = static_cast<float>(r[i]) - r[i], fy = static_cast<float>(r[i+1]) - r[i+1];
+            e.mesh = std::max(e.mesh, static_cast<double>(std::sqrt(dx * dx + dy * dy)));
+            e.floor = std::max(e.floor, static_cast<double>(std::sqrt(fx * fx + fy * fy)));
+        }
+    }
+    return e;
+}
+
+// the vertices of every sector, as a streamed export makes them
+double sectorMs(unsigned int N, float pa, gearPrecision precision)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    gear g(N, pa, 5.0f, gearBuild::sectors, gearDetail::fine, precision);
+    std::vector<float> v(6 * g.GetSectorNverts());
+    for(unsigned int n=0; n<N; ++n){
+        g.SectorVerts(n, v.data());
+        sink = v[0];
+    }
+    const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+    return dt.count();
+}
+
+// worst vertex error of each gearPrecision against long double, and what it costs
+void precisionReport(const std::vector<unsigned int> &teeth)
+{
+    const float pa = radians(20.0f);
+    std::cout << std::setw(9) << "N" << std::setw(14) << "floats" << std::setw(14) << "doubles" << std::setw(14) << "float floor";
+    std::cout << std::setw(12) << "floats ms" << std::setw(12) << "doubles ms" << "   (errors in module)" << std::endl;
+    for(unsigned int N: teeth){
+        precisionError e[2];
+        double ms[2];
+        int i = 0;
+        for(gearPrecision precision: {gearPrecision::floats, gearPrecision::doubles}){
+            gear g(N, pa, 5.0f, gearBuild::sectors, gearDetail::fine, precision);
+            e[i] = meshError(g, 512);
+            ms[i++] = sectorMs(N, pa, precision);
+        }
+        std::cout << std::setw(9) << N << std::scientific << std::setprecision(2) << std::setw(14) << e[0].mesh;
+        std::cout << std::setw(14) << e[1].mesh << std::setw(14) << e[0].floor << std::fixed << std::setprecision(1);
+        std::cout << std::setw(12) << ms[0] << std::setw(12) << ms[1] << std::endl;
+    }
+}
+
+// the nearest triangle along the ray by testing every one, to check the bvh against
+bool pickEvery(gear &g, const float o[3], const float d[3], unsigned int &triangle)
+{
+    const std::vector<float> &v = g.GetVerts();
+    const std::vector<unsigned int> &ind = g.GetInds();
+    double best = 1e30;
+    bool bHit = false;
+    for(unsigned int i=0; i<g.GetNInds()/3; ++i){
+        const float *v0 = &v[6 * ind[3 * i]], *v1 = &v[6 * ind[3 * i + 1]], *v2 = &v[6 * ind[3 * i + 2]];
+        const double e1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]}, e2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+        const double p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+        const double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if(std::fabs(det) < 1e-12) continue;
+        const double s[3] = {o[0] - v0[0], o[1] - v0[1], o[2] - v0[2]};
+        const double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+        const double q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+        const double w = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det, t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+        if(u < 0.0 || w < 0.0 || u + w > 1.0 || t <= 0.0 || t >= best) continue;
+        best = t;
+        triangle = i;
+        bHit = true;
+    }
+    return bHit;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    std::string jsonFile, filter, goldenFile, refDir;
+    double minTime = 0.5;
+    float tolerance = 0.0f;
+    bool bGoldenWrite = false;
+    std::vector<unsigned int> precisionTeeth;
+
+    for(int i=1; i<argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--json" && i + 1 < argc) jsonFile = argv[++i];
+        else if(arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if(arg == "--min-time" && i + 1 < argc) minTime = std::stod(argv[++i]);
+        else if(arg == "--golden-check" && i + 1 < argc) goldenFile = argv[++i];
+        else if(arg == "--golden-write" && i + 1 < argc){
+            goldenFile = argv[++i];
+            bGoldenWrite = true;
+        }
+        else if(arg == "--ref-dir" && i + 1 < argc) refDir = argv[++i];
+        else if(arg == "--tolerance" && i + 1 < argc) tolerance = std::stof(argv[++i]);
+        else if(arg == "--precision"){
+            precisionTeeth = {100, 1000, 10000, 100000, 1000000};
+            if(i + 1 < argc && argv[i+1][0] != '-'){
+                precisionTeeth.clear();
+                std::istringstream is(argv[++i]);
+                std::string n;
+                while(std::getline(is, n, ',')) precisionTeeth.push_back(static_cast<unsigned int>(std::stoul(n)));
+            }
+        }
+        else{
+            std::cerr << "usage: gearbench [--json file] [--filter text] [--min-time seconds]" << std::endl;
+            std::cerr << "       gearbench --golden-check file [--ref-dir dir] [--tolerance t]" << std::endl;
+            std::cerr << "       gearbench --golden-write file [--ref-dir dir]" << std::endl;
+            std::cerr << "       gearbench --precision [N,N,...]" << std::endl;
+            return 1;
+        }
+    }
+    if(bGoldenWrite) return goldenWrite(goldenFile, refDir, std::cerr) ? 0 : 1;
+    if(!goldenFile.empty()) return goldenCheck(goldenFile, refDir, tolerance, std::cout) ? 1 : 0;
+    if(!precisionTeeth.empty()){
+        precisionReport(precisionTeeth);
+        return 0;
+    }
+    benchRunner bench(filter, minTime);
+    const unsigned int Ns[] = {6, 12, 30, 100, 300, 1000, 3000, 10000};
+
+    // whole gear construction
+    for(unsigned int N: Ns){
+        for(float paDeg: paDegrees){
+            const float pa = radians(paDeg);
+            bench.run(caseName("gear", N, paDeg), [&]{ gear g(N, pa, 5.0f); sink = g.GetVerts()[0]; });
+            bench.run(caseName("gearApprox", N, paDeg), [&]{ gearApprox g(N, pa, 5.0f); sink = g.GetVerts()[0]; });
+            bench.run(caseName("gear/coarse", N, paDeg), [&]{ gear g(N, pa, 5.0f, gearBuild::full, gearDetail::coarse); sink = g.GetVerts()[0]; });
+        }
+    }
+    // a rebuild of the simulator's pair, on one thread then every core, lopsided pairs included
+    {
+        const unsigned int pairs[4][2] = {{12, 12}, {12, 500}, {100, 100}, {500, 500}};
+        const float pa = radians(20.0f);
+        for(const auto &p: pairs){
+            for(unsigned int threads: {1u, 0u}){
+                std::ostringstream os;
+                os << "gearPair/Na:" << p[0] << "/Nb:" << p[1] << "/threads:" << (threads ? "1" : "all");
+                bench.run(os.str(), [&]{ sink = buildGearPair(p[0], p[1], pa, true, gearDetail::fine, threads).verts[0]; });
+            }
+        }
+    }
+    // picking a tooth of a 1000 tooth gear, its bvh built on one thread then every core,
+    // then rays cast at it from the simulator's eye, as OGLWidget takes a click into the gear's frame
+    {
+        gear g(1000, radians(20.0f), 5.0f);
+        const unsigned int nTriangles = g.GetNInds() / 3;
+        for(unsigned int threads: {1u, 0u}){
+            bench.run(std::string("meshBvh/build/N:1000/threads:") + (threads ? "1" : "all"), [&]{
+                const meshBvh b(g.GetVerts().data(), g.GetInds().data(), nTriangles, threads);
+                sink = (float) b.size();
+            });
+        }
+        const meshBvh bvh(g.GetVerts().data(), g.GetInds().data(), nTriangles);
+        const std::size_t nRays = 1024;
+        std::vector<float> rays(6 * nRays); // origin then direction
+        for(std::size_t i=0; i<nRays; ++i){ // over the gear's face and just past its teeth
+            const float r = g.GetRmaj() * 1.02f * std::sqrt((float) ((i * 389) % nRays) / nRays), a = 2.399963f * i;
+            const float eye[3] = {0.0f, -0.6f * g.GetRmaj(), 2.0f * g.GetRmaj()}, at[3] = {r * std::cos(a), r * std::sin(a), 0.0f};
+            for(int c=0; c<3; ++c){
+                rays[6 * i + c] = eye[c];
+                rays[6 * i + 3 + c] = at[c] - eye[c];
+            }
+        }
+        std::size_t k = 0;
+        bench.run("meshBvh/pick/N:1000", [&]{
+            const float *ray = &rays[6 * (k++ % nRays)];
+            bvhHit h;
+            sink = bvh.intersect(ray, ray + 3, h) ? h.t : 0.0f;
+        });
+        if(filter.empty() || filter.find("meshBvh") != std::string::npos){
+            unsigned int differ = 0, hits = 0;
+            for(std::size_t i=0; i<nRays; i+=8){
+                bvhHit h;
+                unsigned int t = 0;
+                const bool bBvh = bvh.intersect(&rays[6 * i], &rays[6 * i + 3], h), bEvery = pickEvery(g, &rays[6 * i], &rays[6 * i + 3], t);
+                if(bBvh) ++hits;
+                if(bBvh != bEvery || (bBvh && toothOfTriangle(h.triangle, 1000, g.GetNInds(), g.GetN1Inds()) != toothOfTriangle(t, 1000, g.GetNInds(), g.GetN1Inds())))
+                    ++differ;
+            }
+            std::cout << "meshBvh of " << nTriangles << " triangles, depth " << bvh.depth() << ", " << std::setprecision(1) << std::fixed;
+            std::cout << 1e-6 * bvh.bytes() << " MB, " << hits << " of " << nRays / 8 << " rays hit, " << differ;
+            std::cout << " picked a different tooth to testing every triangle" << std::endl;
+        }
+    }
+    // what the coarse mesh gives up, with and without the shader's analytic flank normals
+    if(filter.empty() || filter.find("flankShading") != std::string::npos){
+        for(unsigned int N: {12u, 100u}) for(float paDeg: paDegrees) flankShading(N, paDeg);
+    }
+    // involute maths kernels
+    for(unsigned int N: {12u, 100u, 1000u}){
+        for(float paDeg: paDegrees){
+            benchProfile<benchGear<gear, involuteExact>>(bench, "exact", N, paDeg);
+            benchProfile<benchGear<gearApprox, involuteApprox>>(bench, "approx", N, paDeg);
+        }
+    }
+    for(unsigned int N: Ns){
+        for(float paDeg: paDegrees){
+            const float pa = radians(paDeg);
+            bench.run(caseName("rmajCalc", N, paDeg), [&]{ sink = rmajCalc(N, pa); });
+        }
+    }
+    // involute phase of one gear of a meshing pair
+    for(unsigned int N: {12u, 100u, 1000u}){
+        for(float paDeg: paDegrees){
+            const float pa = radians(paDeg), rp = 0.5f * N;
+            bench.run(caseName("involutePhase", N, paDeg), [&]{ sink = involutePhase(7, rp, 1.01f, pa); });
+        }
+    }
+    // OGLWidget::setSeperation for a sweep of pairs and centre distances, one at a time and batched
+    {
+        const std::size_t n = 4096;
+        std::vector<unsigned int> Na(n), Nb(n);
+        std::vector<float> pa(n), del(n), scalar(n), batch(n);
+        for(std::size_t i=0; i<n; ++i){
+            Na[i] = 8 + (i * 37) % 193;
+            Nb[i] = 8 + (i * 101) % 193;
+            pa[i] = radians(paDegrees[i % 3]);
+            del[i] = -0.1f + 0.85f * (float) ((i * 7) % 64) / 63.0f; // the GUI's range
+        }
+        bench.run("separationPhase/scalar/n:4096", [&]{
+            for(std::size_t i=0; i<n; ++i) scalar[i] = separationPhase(Na[i], Nb[i], pa[i], del[i]);
+            sink = scalar[0];
+        });
+        bench.run("separationPhase/batch/n:4096", [&]{
+            separationPhaseBatch(Na.data(), Nb.data(), pa.data(), del.data(), batch.data(), n);
+            sink = batch[0];
+        });
+        if(filter.empty() || filter.find("separationPhase") != std::string::npos){
+            for(std::size_t i=0; i<n; ++i) scalar[i] = separationPhase(Na[i], Nb[i], pa[i], del[i]);
+            separationPhaseBatch(Na.data(), Nb.data(), pa.data(), del.data(), batch.data(), n);
+            float dev = 0.0f;
+            for(std::size_t i=0; i<n; ++i) dev = std::max(dev, std::fabs(batch[i] - scalar[i]));
+            std::cout << "separationPhase batch against scalar, max deviation " << std::scientific << dev << " degrees" << std::endl;
+        }
+    }
+    // helical gear of 30 degrees, rings and slices written into preallocated buffers
+    for(unsigned int N: {100u, 1000u}){
+        gear g(N, radians(20.0f), 5.0f, gearBuild::sectors);
+        const helicalGear h(g, radians(30.0f), helixSlices(5.0f, radians(30.0f)));
+        std::vector<float> verts(6 * static_cast<std::size_t>(h.GetNverts()));
+        std::vector<unsigned int> inds(h.GetNInds());
+        std::ostringstream os;
+        os << "helicalGear/N:" << N << "/K:" << h.GetSlices();
+        bench.run(os.str(), [&]{ h.fill(verts.data(), inds.data()); sink = verts[0]; });
+    }
+    // overlap sweep of a pair over one pitch, as rerun by the GUI on every parameter change
+    for(unsigned int N: {12u, 100u, 1000u}){
+        for(float paDeg: paDegrees){
+            const float pa = radians(paDeg);
+            gear ga(N, pa, 5.0f, gearBuild::sectors), gb(2 * N, pa, 5.0f, gearBuild::sectors);
+            bench.run(caseName("findInterference", N, paDeg), [&]{ sink = findInterference(ga, gb).maxDepth; });
+        }
+    }
+    // transmission error sweep, single threaded so the figure is per core
+    for(unsigned int N: {12u, 100u}){
+        for(float paDeg: paDegrees){
+            const float pa = radians(paDeg);
+            gear ga(N, pa, 5.0f, gearBuild::sectors), gb(2 * N, pa, 5.0f, gearBuild::sectors);
+            transmissionOptions opt;
+            opt.samples = 1024;
+            opt.threads = 1;
+            opt.offsets.clear();
+            bench.run(caseName("sweepTransmission", N, paDeg), [&]{ sink = sweepTransmission(ga, gb, opt).teMax; });
+        }
+    }
+
+    if(!jsonFile.empty() && !bench.writeJson(jsonFile)){
+        std::cerr << "can't write " << jsonFile << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Micro benchmarks for gear generation, no Qt needed
+# qmake gearbench.pro && make, then ./gearbench --json results.json
+#
+#-------------------------------------------------
+
+unix: QMAKE_CXXFLAGS += -std=c++14
+win32: CONFIG += c++14
+CONFIG += console release
+CONFIG -= qt app_bundle
+
+TARGET = gearbench
+TEMPLATE = app
+
+SOURCES += gearbench.cpp\
+        gear.cpp\
+        gearpair.cpp\
+        phasebatch.cpp\
+        helical.cpp\
+        meshcheck.cpp\
+        interference.cpp\
+        transmission.cpp\
+        gearpick.cpp\
+        trace.cpp
+
+HEADERS  += gear.h\
+        gearpair.h\
+        phasebatch.h\
+        helical.h\
+        meshcheck.h\
+        interference.h\
+        transmission.h\
+        gearpick.h\
+        trace.h
@@ -0,0 +1,291 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <cctype>
+#include "gear.h"
+#include "gearexport.h"
+#include "helical.h"
+#include "trace.h"
+
+namespace {
+
+bool hostLittleEndian()
+{
+    const std::uint16_t one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+// output through a large buffer, numbers are written little endian whatever the host
+class bufferedWriter
+{
+public:
+    explicit bufferedWriter(const std::string &fileName) : fout(std::fopen(fileName.c_str(), "wb")), bLittle(hostLittleEndian())
+    {
+        buf.reserve(1 << 20);
+    }
+    ~bufferedWriter() { close(); }
+    bool good() const { return fout != nullptr && bGood; }
+    bool close()
+    {
+        if(fout){
+            flush();
+            bGood = std::fclose(fout) == 0 && bGood;
+            fout = nullptr;
+        }
+        return bGood;
+    }
+    void put(const void *data, std::size_t n)
+    {
+        if(buf.size() + n > buf.capacity()){
+            flush();
+            if(n > buf.capacity()){ // big blocks go straight out
+                bGood = std::fwrite(data, 1, n, fout) == n && bGood;
+                return;
+            }
+        }
+        const char *p = static_cast<const char*>(data);
+        buf.insert(buf.end(), p, p + n);
+    }
+    void text(const char *s) { put(s, std::strlen(s)); }
+    void u32(std::uint32_t x)
+    {
+        const unsigned char b[4] = {static_cast<unsigned char>(x), static_cast<unsigned char>(x >> 8),
+                                    static_cast<unsigned char>(x >> 16), static_cast<unsigned char>(x >> 24)};
+        put(b, 4);
+    }
+    void f32(float x)
+    {
+        std::uint32_t u;
+        std::memcpy(&u, &x, 4);
+        u32(u);
+    }
+    // a block of floats, copied unchanged on a little endian host
+    void f32s(const float *x, std::size_t n)
+    {
+        if(bLittle) put(x, n * sizeof(float));
+        else for(std::size_t i=0; i<n; ++i) f32(x[i]);
+    }
+private:
+    void flush()
+    {
+        if(!buf.empty()) bGood = std::fwrite(buf.data(), 1, buf.size(), fout) == buf.size() && bGood;
+        buf.clear();
+    }
+    std::FILE *fout;
+    std::vector<char> buf;
+    const bool bLittle;
+    bool bGood = true;
+};
+
+// mesh whose vertices and indices are all in memory
+class fullSource
+{
+public:
+    fullSource(const float *iv, unsigned int inVerts, const unsigned int *iind, std::size_t inInds) :
+        v(iv), ind(iind), Nverts(inVerts), Ninds(inInds) {}
+    explicit fullSource(gear &g) : fullSource(g.GetVerts().data(), g.GetNverts(), g.GetInds().data(), g.GetNInds()) {}
+    unsigned int nVerts() { return Nverts; }
+    std::size_t nTris() { return Ninds / 3; }
+    template<class F> void vertexBlocks(F f) { f(v, Nverts); }
+    template<class F> void triangles(F f)
+    {
+        for(std::size_t i=0; i<Ninds; i+=3){
+            f(ind[i], ind[i+1], ind[i+2], v + 6 * ind[i], v + 6 * ind[i+1], v + 6 * ind[i+2]);
+        }
+    }
+private:
+    const float *v;
+    const unsigned int *ind;
+    const unsigned int Nverts;
+    const std::size_t Ninds;
+};
+
+// gear generated a sector at a time, triangles reach back into
+// the previous sector and to the two centre verticies only
+class streamSource
+{
+public:
+    explicit streamSource(gear &ig) : g(ig), sn(g.GetSectorNverts()), cur(6 * sn), prev(6 * sn), ind(g.GetSectorNInds()) {}
+    unsigned int nVerts() { return g.GetNverts(); }
+    std::size_t nTris() { return g.GetNInds() / 3; }
+    template<class F> void vertexBlocks(F f)
+    {
+        for(unsigned int n=0; n<g.GetN(); ++n){
+            g.SectorVerts(n, cur.data());
+            f(cur.data(), sn);
+        }
+        f(g.GetCentreVerts(), 2);
+    }
+    template<class F> void triangles(F f)
+    {
+        const unsigned int N = g.GetN(), nc = g.GetNverts() - 2;
+        g.SectorVerts(N - 1, prev.data());
+        for(unsigned int n=0; n<N; ++n){
+            g.SectorVerts(n, cur.data());
+            g.SectorInds(n, ind.data());
+            auto pos = [&](unsigned int v) -> const float* {
+                if(v >= nc) return g.GetCentreVerts() + 6 * (v - nc);
+                return (v / sn == n ? cur.data() : prev.data()) + 6 * (v % sn);
+            };
+            for(std::size_t i=0; i<ind.size(); i+=3){
+                f(ind[i], ind[i+1], ind[i+2], pos(ind[i]), pos(ind[i+1]), pos(ind[i+2]));
+            }
+            std::swap(cur, prev);
+        }
+    }
+private:
+    gear &g;
+    const unsigned int sn;
+    std::vector<float> cur, prev;
+    std::vector<unsigned int> ind;
+};
+
+// the gear's triangles aren't consistently wound, so wind each one
+// to agree with its vertex normals, returns the unit face normal
+void orient(unsigned int &b, unsigned int &c, const float *&pb, const float *&pc, const float *pa, float n[3])
+{
+    const float u[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+    const float v[3] = {pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2]};
+    n[0] = u[1] * v[2] - u[2] * v[1];
+    n[1] = u[2] * v[0] - u[0] * v[2];
+    n[2] = u[0] * v[1] - u[1] * v[0];
+    float m = 0.0f;
+    for(int i=3; i<6; ++i) m += n[i-3] * (pa[i] + pb[i] + pc[i]);
+    if(m < 0.0f){
+        std::swap(b, c);
+        std::swap(pb, pc);
+        for(int i=0; i<3; ++i) n[i] = -n[i];
+    }
+    const float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if(len > 0.0f) for(int i=0; i<3; ++i) n[i] /= len;
+}
+
+template<class S> bool writeSTL(S &src, bufferedWriter &out)
+{
+    char header[80] = "binary STL, involute gear";
+    out.put(header, sizeof(header));
+    out.u32(static_cast<std::uint32_t>(src.nTris()));
+    src.triangles([&](unsigned int, unsigned int b, unsigned int c, const float *pa, const float *pb, const float *pc){
+        float n[3];
+        orient(b, c, pb, pc, pa, n);
+        out.f32s(n, 3);
+        out.f32s(pa, 3);
+        out.f32s(pb, 3);
+        out.f32s(pc, 3);
+        const unsigned char attr[2] = {0, 0};
+        out.put(attr, 2);
+    });
+    return out.close();
+}
+
+template<class S> bool writeOBJ(S &src, bufferedWriter &out)
+{
+    char line[128];
+    out.text("# involute gear\n");
+    src.vertexBlocks([&](const float *v, unsigned int count){
+        for(unsigned int i=0; i<count; ++i, v+=6){
+            std::snprintf(line, sizeof(line), "v %.7g %.7g %.7g\nvn %.7g %.7g %.7g\n", v[0], v[1], v[2], v[3], v[4], v[5]);
+            out.text(line);
+        }
+    });
+    src.triangles([&](unsigned int a, unsigned int b, unsigned int c, const float *pa, const float *pb, const float *pc){
+        float n[3];
+        orient(b, c, pb, pc, pa, n);
+        ++a, ++b, ++c; // obj counts from 1
+        std::snprintf(line, sizeof(line), "f %u//%u %u//%u %u//%u\n", a, a, b, b, c, c);
+        out.text(line);
+    });
+    return out.close();
+}
+
+template<class S> bool writePLY(S &src, bufferedWriter &out)
+{
+    char header[512];
+    std::snprintf(header, sizeof(header),
+                  "ply\nformat binary_little_endian 1.0\ncomment involute gear\n"
+                  "element vertex %u\nproperty float x\nproperty float y\nproperty float z\n"
+                  "property float nx\nproperty float ny\nproperty float nz\n"
+                  "element face %lu\nproperty list uchar uint vertex_indices\nend_header\n",
+                  src.nVerts(), static_cast<unsigned long>(src.nTris()));
+    out.text(header);
+    src.vertexBlocks([&](const float *v, unsigned int count){ out.f32s(v, 6 * count); });
+    src.triangles([&](unsigned int a, unsigned int b, unsigned int c, const float *pa, const float *pb, const float *pc){
+        float n[3];
+        orient(b, c, pb, pc, pa, n);
+        const unsigned char three = 3;
+        out.put(&three, 1);
+        out.u32(a);
+        out.u32(b);
+        out.u32(c);
+    });
+    return out.close();
+}
+
+template<class S> bool writeMesh(S &src, meshFormat fmt, const std::string &fileName)
+{
+    bufferedWriter out(fileName);
+    if(!out.good()) return false;
+    switch(fmt){
+    case meshFormat::stl: return writeSTL(src, out);
+    case meshFormat::obj: return writeOBJ(src, out);
+    case meshFormat::ply: return writePLY(src, out);
+    }
+    return false;
+}
+
+}
+
+bool formatFromName(const std::string &fileName, meshFormat &fmt)
+{
+    const std::size_t dot = fileName.rfind('.');
+    if(dot == std::string::npos) return false;
+    std::string ext = fileName.substr(dot + 1);
+    for(auto &c: ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    if(ext == "stl") fmt = meshFormat::stl;
+    else if(ext == "obj") fmt = meshFormat::obj;
+    else if(ext == "ply") fmt = meshFormat::ply;
+    else return false;
+    return true;
+}
+
+bool exportGear(gear &g, meshFormat fmt, const std::string &fileName)
+{
+    TRACE_SCOPE("exportGear");
+    fullSource src(g);
+    return writeMesh(src, fmt, fileName);
+}
+
+bool exportGearStream(unsigned int N, float pa, bool bExact, float dZ, meshFormat fmt, const std::string &fileName)
+{
+    TRACE_SCOPE("exportGearStream");
+    std::unique_ptr<gear> g;
+
+    // streamed gears are the big ones, work the sectors out in double so the teeth stay to within float's rounding
+    if(bExact) g = std::make_unique<gear>(N, pa, dZ, gearBuild::sectors, gearDetail::fine, gearPrecision::doubles);
+    else g = std::make_unique<gearApprox>(N, pa, dZ, gearBuild::sectors, gearDetail::fine, gearPrecision::doubles);
+    streamSource src(*g);
+    return writeMesh(src, fmt, fileName);
+}
+
+bool exportHelical(unsigned int N, float pa, bool bExact, float dZ, float helix, unsigned int K, meshFormat fmt, const std::string &fileName)
+{
+    TRACE_SCOPE("exportHelical");
+    std::unique_ptr<gear> g;
+
+    if(bExact) g = std::make_unique<gear>(N, pa, dZ, gearBuild::sectors);
+    else g = std::make_unique<gearApprox>(N, pa, dZ, gearBuild::sectors);
+    const helicalGear h(*g, helix, K ? K : helixSlices(dZ, helix));
+    std::vector<float> verts(6 * static_cast<std::size_t>(h.GetNverts()));
+    std::vector<unsigned int> inds(h.GetNInds());
+    h.fill(verts.data(), inds.data());
+    fullSource src(verts.data(), h.GetNverts(), inds.data(), inds.size());
+    return writeMesh(src, fmt, fileName);
+}
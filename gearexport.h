@@ -0,0 +1,27 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef GEAREXPORT_H
+#define GEAREXPORT_H
+
+#include <string>
+
+class gear;
+
+// binary STL, Wavefront OBJ (text), binary PLY
+enum class meshFormat { stl, obj, ply };
+
+// picks the format from the file name's extension, returns false if it isn't one of ours
+bool formatFromName(const std::string &fileName, meshFormat &fmt);
+
+// writes a fully built gear straight from its vertex and index buffers
+bool exportGear(gear &g, meshFormat fmt, const std::string &fileName);
+
+// generates and writes the gear one sector at a time, in double, memory use doesn't grow with N
+bool exportGearStream(unsigned int N, float pa, bool bExact, float dZ, meshFormat fmt, const std::string &fileName);
+
+// helical gear of K slices (0 picks them from the helix), helix in radians, right hand for positive
+bool exportHelical(unsigned int N, float pa, bool bExact, float dZ, float helix, unsigned int K, meshFormat fmt, const std::string &fileName);
+
+#endif // GEAREXPORT_H
@@ -0,0 +1,137 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include "gear.h"
+#include "gearpair.h"
+#include "gearpick.h"
+#include "trace.h"
+
+std::unique_ptr<gear> buildPairGear(unsigned int N, float pa, bool bExact, unsigned int role, gearDetail detail)
+{
+    // gear a slightly thinner so b shows above any overlap
+    const float dZ = role ? 5.0001f : 5.0f;
+    std::unique_ptr<gear> g;
+
+    if(bExact) g = std::make_unique<gear>(N, pa, dZ, gearBuild::full, detail);
+    else g = std::make_unique<gearApprox>(N, pa, dZ, gearBuild::full, detail);
+    g -> RotateVerts(role ? 90.0f : -90.0f);
+    return g;
+}
+
+namespace {
+
+// the tooth profile only, role 0 is gear a, 1 gear b
+std::unique_ptr<gear> pairProfile(unsigned int N, float pa, bool bExact, unsigned int role, gearDetail detail)
+{
+    const float dZ = role ? 5.0001f : 5.0f;
+    if(bExact) return std::make_unique<gear>(N, pa, dZ, gearBuild::sectors, detail);
+    return std::make_unique<gearApprox>(N, pa, dZ, gearBuild::sectors, detail);
+}
+
+// buildGearPair holds both profiles and the pair's buffers, sized once
+std::size_t buildPeak(std::size_t bytesA, std::size_t bytesB, std::size_t pairVerts, std::size_t pairInds)
+{
+    return bytesA + bytesB + pairVerts + pairInds;
+}
+
+// the fewest teeth worth starting a thread for, a tooth takes a microsecond or so
+const unsigned int teethPerThread = 64;
+
+}
+
+gearPair buildGearPair(unsigned int Na, unsigned int Nb, float pa, bool bExact, gearDetail detail, unsigned int threads)
+{
+    TRACE_SCOPE("buildGearPair");
+    // the profiles, then every tooth of both gears is written and turned into
+    // place straight in the pair's buffers, the teeth shared out over the threads
+    std::unique_ptr<gear> g[2] = {pairProfile(Na, pa, bExact, 0, detail), pairProfile(Nb, pa, bExact, 1, detail)};
+    const float rot[2] = {-90.0f, 90.0f}; // as buildPairGear
+    gearPair pair;
+
+    pair.Nind_a = g[0] -> GetNInds();
+    pair.Nind1_a = g[0] -> GetN1Inds();
+    pair.Nind_b = g[1] -> GetNInds();
+    pair.Nind1_b = g[1] -> GetN1Inds();
+    pair.Nverts_a = g[0] -> GetNverts();
+    g[0] -> GetFlankShading(pair.flank_a);
+    g[1] -> GetFlankShading(pair.flank_b);
+    pair.bytes_a = g[0] -> GetBytes();
+    pair.bytes_b = g[1] -> GetBytes();
+    pair.verts.resize(6 * (static_cast<std::size_t>(pair.Nverts_a) + g[1] -> GetNverts()));
+    pair.inds.resize(static_cast<std::size_t>(pair.Nind_a) + pair.Nind_b);
+
+    float *const verts[2] = {pair.verts.data(), pair.verts.data() + 6 * static_cast<std::size_t>(pair.Nverts_a)};
+    unsigned int *const blank[2] = {pair.inds.data(), pair.inds.data() + pair.Nind_a};
+    unsigned int *const cut[2] = {blank[0] + pair.Nind1_a, blank[1] + pair.Nind1_b};
+    const unsigned int sectorVerts = g[0] -> GetSectorNverts(), sectorInds = g[0] -> GetSectorNInds();
+    const unsigned int sectorBlank = pair.Nind1_a / Na, sectorCut = sectorInds - sectorBlank;
+    const unsigned int nJobs = Na + Nb; // gear a's teeth then gear b's
+    auto worker = [&](unsigned int first, unsigned int last){
+        TRACE_SCOPE("buildGearPair teeth");
+        for(unsigned int j=first; j<last; ++j){
+            const unsigned int k = j < Na ? 0 : 1, n = k ? j - Na : j;
+            float *const v = verts[k] + 6 * static_cast<std::size_t>(sectorVerts) * n;
+            g[k] -> SectorVerts(n, v);
+            rotateVerts(v, sectorVerts, rot[k]);
+            g[k] -> SectorInds(n, blank[k] + static_cast<std::size_t>(sectorBlank) * n, cut[k] + static_cast<std::size_t>(sectorCut) * n);
+        }
+    };
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1u, std::min(threads, nJobs / teethPerThread));
+    std::vector<std::thread> pool;
+    const unsigned int chunk = (nJobs + threads - 1) / threads;
+    for(unsigned int t=1; t<threads; ++t){
+        pool.emplace_back(worker, std::min(nJobs, t * chunk), std::min(nJobs, (t + 1) * chunk));
+    }
+    for(unsigned int k=0; k<2; ++k){ // the centres, last of each gear's vertices
+        float *const c = verts[k] + 6 * static_cast<std::size_t>(g[k] -> GetNverts() - 2);
+        std::copy(g[k] -> GetCentreVerts(), g[k] -> GetCentreVerts() + 12, c);
+        rotateVerts(c, 2, rot[k]);
+    }
+    worker(0, std::min(nJobs, chunk));
+    for(auto &t: pool) t.join();
+    pair.peakBytes = buildPeak(pair.bytes_a, pair.bytes_b, pair.verts.capacity() * sizeof(float),
+                               pair.inds.capacity() * sizeof(unsigned int));
+    return pair;
+}
+
+std::size_t gearPair::bytes() const
+{
+    return sizeof(gearPair) + verts.capacity() * sizeof(float) + inds.capacity() * sizeof(unsigned int);
+}
+
+std::size_t gearPair::gpuBytes() const
+{
+    return verts.size() * sizeof(float) + inds.size() * sizeof(unsigned int);
+}
+
+pairMemory estimatePairMemory(unsigned int Na, unsigned int Nb, gearDetail detail)
+{
+    const std::size_t Ninv = flankVerts(detail);
+    const std::size_t vertsA = 6 * (8 * (1 + Ninv) * Na + 2), vertsB = 6 * (8 * (1 + Ninv) * Nb + 2);
+    const std::size_t indsA = 24 * Ninv * Na, indsB = 24 * Ninv * Nb;
+    pairMemory m;
+    m.gpu = (vertsA + vertsB) * sizeof(float) + (indsA + indsB) * sizeof(unsigned int);
+    m.cpu = sizeof(gearPair) + m.gpu;
+    m.peak = buildPeak(gearBytes(Na, gearBuild::sectors, detail), gearBytes(Nb, gearBuild::sectors, detail),
+                       (vertsA + vertsB) * sizeof(float), (indsA + indsB) * sizeof(unsigned int));
+    m.pick = meshBvhBytes(indsA / 3) + meshBvhBytes(indsB / 3);
+    return m;
+}
+
+bool fitMemoryBudget(unsigned int Na, unsigned int Nb, std::size_t budget, unsigned int gpuCopies, gearDetail &detail,
+                     std::size_t held)
+{
+    if(budget == 0) return true;
+    if(held >= budget) return false;
+    budget -= held;
+    if(estimatePairMemory(Na, Nb, detail).total(gpuCopies) <= budget) return true;
+    if(estimatePairMemory(Na, Nb, gearDetail::coarse).total(gpuCopies) > budget) return false;
+    detail = gearDetail::coarse;
+    return true;
+}
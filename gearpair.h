@@ -0,0 +1,56 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef GEARPAIR_H
+#define GEARPAIR_H
+
+#include <vector>
+#include <memory>
+#include "gear.h"
+
+// CPU side mesh for a meshing pair of gears, both gears share one
+// vertex and one index buffer. Gear b's vertices follow gear a's, and its
+// indices count from its own first vertex, so they need no rebasing
+// (the renderer offsets the attribute pointers by Nverts_a instead)
+struct gearPair
+{
+    std::vector<float> verts;
+    std::vector<unsigned int> inds;
+    unsigned int Nind_a = 0, Nind1_a = 0, Nind_b = 0, Nind1_b = 0;
+    unsigned int Nverts_a = 0;
+    float flank_a[3] = {}, flank_b[3] = {}; // gear::GetFlankShading of each
+    std::size_t bytes_a = 0, bytes_b = 0; // gear::GetBytes of each gear's profile, the teeth are written into the pair
+    std::size_t peakBytes = 0; // the most buildGearPair held at once
+    std::size_t bytes() const; // held now, by capacity
+    std::size_t gpuBytes() const; // the vertex and index buffers once uploaded
+};
+
+// memory a pair configuration costs, from the counts alone
+struct pairMemory
+{
+    std::size_t cpu; // the gearPair, as kept by the mesh cache
+    std::size_t gpu; // its OpenGL buffers
+    std::size_t peak; // building it, both profiles and the pair's buffers
+    std::size_t pick; // both gears' picking bvhs, once a tooth is picked
+    // a rebuild with the other profile's buffers and bvhs still resident
+    std::size_t total(unsigned int gpuCopies = 1) const { return peak + gpuCopies * (gpu + pick); }
+};
+
+// one gear of the pair, built and rotated into place, role 0 is gear a, 1 gear b
+std::unique_ptr<gear> buildPairGear(unsigned int N, float pa, bool bExact, unsigned int role, gearDetail detail = gearDetail::fine);
+
+// build the pair, doesn't touch OpenGL so may be called from any thread. Both gears'
+// teeth are shared out over threads (0 for every core), a few dozen teeth to each
+gearPair buildGearPair(unsigned int Na, unsigned int Nb, float pa, bool bExact, gearDetail detail = gearDetail::fine,
+                       unsigned int threads = 0);
+
+pairMemory estimatePairMemory(unsigned int Na, unsigned int Nb, gearDetail detail = gearDetail::fine);
+
+// keeps detail if the pair's total(gpuCopies) fits in budget bytes alongside held bytes
+// kept regardless (the mesh cache, a build under way), drops to coarse if that fits
+// instead, false when neither does, a budget of 0 is unlimited
+bool fitMemoryBudget(unsigned int Na, unsigned int Nb, std::size_t budget, unsigned int gpuCopies, gearDetail &detail,
+                     std::size_t held = 0);
+
+#endif // GEARPAIR_H
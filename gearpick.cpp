@@ -0,0 +1,319 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include "gearpick.h"
+#include "trace.h"
+
+namespace {
+
+const unsigned int leafSize = 8; // triangles
+
+// n's box around a's and b's
+void join(const bvhNode &a, const bvhNode &b, bvhNode &n)
+{
+    for(int c=0; c<3; ++c){
+        n.lo[c] = std::min(a.lo[c], b.lo[c]);
+        n.hi[c] = std::max(a.hi[c], b.hi[c]);
+    }
+}
+
+// a triangle's centroid kept with its number, so the splits sort without chasing indices
+struct bvhItem
+{
+    float c[3];
+    unsigned int triangle;
+};
+
+// bounds of a run of centroids
+struct extent
+{
+    float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max()};
+    float hi[3] = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+    void grow(const float *p)
+    {
+        for(int c=0; c<3; ++c){
+            lo[c] = std::min(lo[c], p[c]);
+            hi[c] = std::max(hi[c], p[c]);
+        }
+    }
+};
+
+// splits a run of the triangles across the middle of its centroids' longest axis,
+// the boxes are filled in once the triangles are in their final order
+struct bvhBuilder
+{
+    std::vector<bvhItem> &order; // each node's a run of it
+
+    // Halfway across the centroids suits a gear's even spread of triangles, and the
+    // partition works out both sides' centroid bounds in the same one pass. All
+    // on one side means they're all equal, so any split will do
+    unsigned int split(unsigned int first, unsigned int last, const extent &e, extent &left, extent &right) const
+    {
+        int axis = 0;
+        for(int c=1; c<3; ++c) if(e.hi[c] - e.lo[c] > e.hi[axis] - e.lo[axis]) axis = c;
+        const float at = 0.5f * (e.lo[axis] + e.hi[axis]);
+        unsigned int i = first, j = last;
+        while(i < j){
+            if(order[i].c[axis] < at) left.grow(order[i++].c);
+            else{
+                std::swap(order[i], order[--j]);
+                right.grow(order[j].c);
+            }
+        }
+        if(i == first || i == last){
+            left = right = e;
+            return first + (last - first) / 2;
+        }
+        return i;
+    }
+
+    // the subtree over order[first, last) appended depth first, right children
+    // numbered within out, e the run's centroid bounds
+    void build(unsigned int first, unsigned int last, const extent &e, std::vector<bvhNode> &out) const
+    {
+        const std::size_t i = out.size();
+        out.emplace_back();
+        if(last - first <= leafSize){
+            out[i].first = first;
+            out[i].count = last - first;
+            return;
+        }
+        extent left, right;
+        const unsigned int mid = split(first, last, e, left, right);
+        build(first, mid, left, out);
+        const std::size_t r = out.size();
+        build(mid, last, right, out);
+        out[i].first = static_cast<unsigned int>(r);
+        out[i].count = 0;
+    }
+};
+
+// the top of the tree, split before the threads start, each leaf a subtree for one of them
+struct topNode
+{
+    bvhNode node;
+    int left = -1, right = -1;
+    int task = -1; // the subtree standing in for this node
+    unsigned int first, last;
+    extent centroids;
+};
+
+// the lowest positive t at which the ray enters the box, infinity if it misses or lies beyond best
+float boxEntry(const bvhNode &n, const float o[3], const float inv[3], float best)
+{
+    float t0 = 0.0f, t1 = best;
+    for(int c=0; c<3; ++c){
+        float a = (n.lo[c] - o[c]) * inv[c], b = (n.hi[c] - o[c]) * inv[c];
+        if(a > b) std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+    }
+    return t0 <= t1 ? t0 : std::numeric_limits<float>::infinity();
+}
+
+}
+
+meshBvh::meshBvh(const float *verts, const unsigned int *inds, unsigned int nTriangles, unsigned int threads)
+{
+    TRACE_SCOPE("meshBvh::meshBvh");
+    if(nTriangles == 0) return;
+    std::vector<bvhItem> order(nTriangles);
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max(1u, nTriangles / 4096)); // not worth a thread for fewer
+
+    auto run = [threads](unsigned int n, const std::function<void(unsigned int, unsigned int)> &f){
+        std::vector<std::thread> pool;
+        const unsigned int chunk = (n + threads - 1) / threads;
+        for(unsigned int t=1; t<threads; ++t) pool.emplace_back(f, std::min(n, t * chunk), std::min(n, (t + 1) * chunk));
+        f(0, std::min(n, chunk));
+        for(auto &t: pool) t.join();
+    };
+    run(nTriangles, [&](unsigned int first, unsigned int last){
+        for(unsigned int i=first; i<last; ++i){
+            const float *v[3] = {verts + 6 * static_cast<std::size_t>(inds[3 * i]), verts + 6 * static_cast<std::size_t>(inds[3 * i + 1]),
+                                 verts + 6 * static_cast<std::size_t>(inds[3 * i + 2])};
+            for(int c=0; c<3; ++c) order[i].c[c] = (v[0][c] + v[1][c] + v[2][c]) / 3.0f;
+            order[i].triangle = i;
+        }
+    });
+
+    // split the top levels here into a few subtrees a thread, they're built side by side
+    const bvhBuilder builder{order};
+    std::vector<topNode> top;
+    std::vector<std::vector<bvhNode>> tasks;
+    const unsigned int taskSize = threads == 1 ? nTriangles : std::max(leafSize, nTriangles / (4 * threads));
+    std::function<int(unsigned int, unsigned int, const extent&)> splitTop = [&](unsigned int first, unsigned int last, const extent &e){
+        const int i = static_cast<int>(top.size());
+        top.emplace_back();
+        top[i].first = first;
+        top[i].last = last;
+        top[i].centroids = e;
+        if(last - first <= taskSize){
+            top[i].task = static_cast<int>(tasks.size());
+            tasks.emplace_back();
+            return i;
+        }
+        top[i].node.count = 0;
+        extent l, r;
+        const unsigned int mid = builder.split(first, last, e, l, r);
+        const int left = splitTop(first, mid, l), right = splitTop(mid, last, r);
+        top[i].left = left;
+        top[i].right = right;
+        return i;
+    };
+    extent all;
+    for(const bvhItem &t: order) all.grow(t.c);
+    splitTop(0, nTriangles, all);
+    std::vector<const topNode*> leaves;
+    for(const topNode &t: top) if(t.task >= 0) leaves.push_back(&t);
+    run(static_cast<unsigned int>(leaves.size()), [&](unsigned int first, unsigned int last){
+        for(unsigned int k=first; k<last; ++k) builder.build(leaves[k]->first, leaves[k]->last, leaves[k]->centroids, tasks[leaves[k]->task]);
+    });
+
+    // stitch the subtrees under the top, renumbering their right children
+    std::function<void(int)> emit = [&](int i){
+        const topNode &t = top[i];
+        if(t.task >= 0){
+            const unsigned int base = static_cast<unsigned int>(nodes.size());
+            for(bvhNode n: tasks[t.task]){
+                if(n.count == 0) n.first += base;
+                nodes.push_back(n);
+            }
+            return;
+        }
+        const std::size_t n = nodes.size();
+        nodes.push_back(t.node);
+        emit(t.left);
+        nodes[n].first = static_cast<unsigned int>(nodes.size());
+        emit(t.right);
+    };
+    std::size_t total = 0;
+    for(const auto &t: tasks) total += t.size();
+    nodes.reserve(total + top.size());
+    emit(0);
+
+    tris.resize(nTriangles);
+    for(unsigned int i=0; i<nTriangles; ++i) tris[i] = order[i].triangle;
+    corners.resize(9 * static_cast<std::size_t>(nTriangles));
+    run(nTriangles, [&](unsigned int first, unsigned int last){
+        for(unsigned int i=first; i<last; ++i){
+            for(int k=0; k<3; ++k){
+                const float *v = verts + 6 * static_cast<std::size_t>(inds[3 * static_cast<std::size_t>(tris[i]) + k]);
+                std::copy(v, v + 3, &corners[9 * static_cast<std::size_t>(i) + 3 * k]);
+            }
+        }
+    });
+    // the leaves' boxes from their corners, then each inner node's around its children, which follow it
+    for(std::size_t i=nodes.size(); i-->0;){
+        bvhNode &n = nodes[i];
+        if(n.count == 0){
+            join(nodes[i + 1], nodes[n.first], n);
+            continue;
+        }
+        for(int c=0; c<3; ++c){
+            n.lo[c] = std::numeric_limits<float>::max();
+            n.hi[c] = -std::numeric_limits<float>::max();
+        }
+        for(std::size_t k=9*static_cast<std::size_t>(n.first); k<9*static_cast<std::size_t>(n.first+n.count); k+=3){
+            for(int c=0; c<3; ++c){
+                n.lo[c] = std::min(n.lo[c], corners[k + c]);
+                n.hi[c] = std::max(n.hi[c], corners[k + c]);
+            }
+        }
+    }
+}
+
+// Moller and Trumbore's ray triangle test in each leaf the ray reaches,
+// the nearer child first so most boxes past the first hit are skipped
+bool meshBvh::intersect(const float origin[3], const float dir[3], bvhHit &hit) const
+{
+    if(nodes.empty()) return false;
+    const float inv[3] = {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+    float best = std::numeric_limits<float>::infinity();
+    bool bHit = false;
+    unsigned int stack[64];
+    int sp = 0;
+    if(boxEntry(nodes[0], origin, inv, best) < best) stack[sp++] = 0;
+    while(sp){
+        const unsigned int i = stack[--sp];
+        const bvhNode &n = nodes[i];
+        if(n.count){
+            for(unsigned int k=n.first; k<n.first+n.count; ++k){
+                const float *v0 = &corners[9 * static_cast<std::size_t>(k)], *v1 = v0 + 3, *v2 = v0 + 6;
+                const float e1[3] = {v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2]};
+                const float e2[3] = {v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2]};
+                const float p[3] = {dir[1] * e2[2] - dir[2] * e2[1], dir[2] * e2[0] - dir[0] * e2[2], dir[0] * e2[1] - dir[1] * e2[0]};
+                const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+                if(std::fabs(det) < 1e-12f) continue; // edge on
+                const float invDet = 1.0f / det;
+                const float s[3] = {origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2]};
+                const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+                if(u < 0.0f || u > 1.0f) continue;
+                const float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+                const float v = (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]) * invDet;
+                if(v < 0.0f || u + v > 1.0f) continue;
+                const float t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+                if(t > 0.0f && t < best){
+                    best = t;
+                    hit = bvhHit{tris[k], t, u, v};
+                    bHit = true;
+                }
+            }
+            continue;
+        }
+        const unsigned int left = i + 1, right = n.first;
+        const float tl = boxEntry(nodes[left], origin, inv, best), tr = boxEntry(nodes[right], origin, inv, best);
+        if(tl <= tr){
+            if(tr < best) stack[sp++] = right;
+            if(tl < best) stack[sp++] = left;
+        }
+        else{
+            if(tl < best) stack[sp++] = left;
+            if(tr < best) stack[sp++] = right;
+        }
+    }
+    return bHit;
+}
+
+std::size_t meshBvh::depth() const
+{
+    std::size_t deepest = 0;
+    std::vector<std::pair<unsigned int, std::size_t>> stack;
+    if(!nodes.empty()) stack.emplace_back(0, 1);
+    while(!stack.empty()){
+        const auto s = stack.back();
+        stack.pop_back();
+        const bvhNode &n = nodes[s.first];
+        if(n.count) deepest = std::max(deepest, s.second);
+        else{
+            stack.emplace_back(s.first + 1, s.second + 1);
+            stack.emplace_back(n.first, s.second + 1);
+        }
+    }
+    return deepest;
+}
+
+std::size_t meshBvh::bytes() const
+{
+    return sizeof(*this) + nodes.capacity() * sizeof(bvhNode) + tris.capacity() * sizeof(unsigned int) + corners.capacity() * sizeof(float);
+}
+
+std::size_t meshBvhBytes(std::size_t nTriangles)
+{
+    const std::size_t nodes = 2 * (2 * nTriangles / leafSize + 1);
+    return sizeof(meshBvh) + nodes * sizeof(bvhNode) + nTriangles * (sizeof(unsigned int) + 9 * sizeof(float));
+}
+
+unsigned int toothOfTriangle(unsigned int triangle, unsigned int N, unsigned int nInds, unsigned int n1Inds)
+{
+    const unsigned int i = 3 * triangle;
+    if(i < n1Inds) return i / (n1Inds / N);
+    return (i - n1Inds) / ((nInds - n1Inds) / N);
+}
@@ -0,0 +1,55 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef GEARPICK_H
+#define GEARPICK_H
+
+#include <vector>
+#include <cstddef>
+
+// axis aligned box, an inner node's right child is numbered first and its
+// left child follows it, a leaf has count triangles from first in leaf order
+struct bvhNode
+{
+    float lo[3], hi[3];
+    unsigned int first, count; // count 0 for an inner node
+};
+
+// nearest triangle along a ray, t in units of the ray's direction
+struct bvhHit
+{
+    unsigned int triangle; // as numbered by the index list the bvh was built from
+    float t, u, v; // the point is (1 - u - v) v0 + u v1 + v v2
+};
+
+// bounding volume hierarchy over one mesh's triangles, in the mesh's own frame,
+// so a moving gear is picked by taking the ray into its frame rather than rebuilding
+class meshBvh
+{
+public:
+    meshBvh() {}
+    // verts 6 floats each (position then normal), nTriangles of 3 indices into them,
+    // built over threads (0 for every core)
+    meshBvh(const float *verts, const unsigned int *inds, unsigned int nTriangles, unsigned int threads = 0);
+    // the nearest triangle hit for t > 0, false for a miss
+    bool intersect(const float origin[3], const float dir[3], bvhHit &hit) const;
+    bool empty() const { return nodes.empty(); }
+    std::size_t size() const { return tris.size(); } // triangles
+    std::size_t depth() const; // of the deepest leaf
+    std::size_t bytes() const; // by capacity
+private:
+    std::vector<bvhNode> nodes; // depth first, nodes[0] the root
+    std::vector<unsigned int> tris; // triangle numbers in leaf order
+    std::vector<float> corners; // 9 floats a triangle in leaf order, so a leaf reads one run of memory
+};
+
+// what a meshBvh of nTriangles takes, with its leaves half full as they come out
+// for the gears, for budgeting before it's built
+std::size_t meshBvhBytes(std::size_t nTriangles);
+
+// tooth of a triangle of a gear mesh laid out as gear::GetInds, the blank's triangles
+// a sector at a time then the cut surface's, nInds and n1Inds as GetNInds and GetN1Inds
+unsigned int toothOfTriangle(unsigned int triangle, unsigned int N, unsigned int nInds, unsigned int n1Inds);
+
+#endif // GEARPICK_H
@@ -0,0 +1,106 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "gear.h"
+#include "gearsdf.h"
+
+static const float pi = 3.1415926535897932f;
+
+namespace {
+
+// involute function of the pressure angle at radius r
+float involute(float r, float rbc)
+{
+    const float a = std::acos(std::min(rbc / r, 1.0f));
+    return std::tan(a) - a;
+}
+
+// angle where the flank from point first crosses radius r
+float flankAngle(const std::vector<float> &x, const std::vector<float> &y, unsigned int first, unsigned int n, float r)
+{
+    for(unsigned int i=first; i+1<first+n; ++i){
+        const float r0 = std::hypot(x[i], y[i]), r1 = std::hypot(x[i+1], y[i+1]);
+        if((r0 - r) * (r1 - r) <= 0.0f && r0 != r1){
+            const float t = (r - r0) / (r1 - r0);
+            return std::atan2(y[i] + t * (y[i+1] - y[i]), x[i] + t * (x[i+1] - x[i]));
+        }
+    }
+    return std::atan2(y[first+n-1], x[first+n-1]);
+}
+
+// a fillet of radius r in the corner where two fields meet
+float roundUnion(float a, float b, float r)
+{
+    const float u = std::max(r - a, 0.0f), v = std::max(r - b, 0.0f);
+    return std::max(r, std::min(a, b)) - std::sqrt(u * u + v * v);
+}
+
+}
+
+gearSdf gearSdfShape(const gear &g, float rotDeg, float twist)
+{
+    const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+    const unsigned int Ninv = static_cast<unsigned int>(tx.size()) / 2;
+    const float rp = 0.5f * (float) g.GetN();
+    float s[3];
+    g.GetFlankShading(s);
+
+    gearSdf f;
+    f.N = (float) g.GetN();
+    f.rbc = s[0];
+    f.rmin = g.GetRmin();
+    f.rmaj = g.GetRmaj();
+    // the flanks mirror each other about the centre line, both profiles pass through the pitch point
+    const float a0 = flankAngle(tx, ty, 0, Ninv, rp), a1 = flankAngle(tx, ty, Ninv, Ninv, rp);
+    const float centre = std::atan2(std::sin(a0) + std::sin(a1), std::cos(a0) + std::cos(a1));
+    const float half = 0.5f * std::fabs(std::remainder(a1 - a0, 2.0f * pi));
+    f.baseHalf = half + involute(rp, f.rbc);
+    f.toothAngle = centre + rotDeg * pi / 180.0f;
+    f.rCircle = s[2];
+    f.circleAngle = f.baseHalf - std::tan(g.GetPa()); // where the pitch point's normal touches the base circle
+    f.delZ = g.GetDelZ();
+    f.twist = twist;
+    f.filletR = g.GetFilletR();
+    return f;
+}
+
+void gearSdfUniforms(const gearSdf &s, float teeth[4], float flank[4], float face[3])
+{
+    teeth[0] = s.N;
+    teeth[1] = s.rbc;
+    teeth[2] = s.rmin;
+    teeth[3] = s.rmaj;
+    flank[0] = s.baseHalf;
+    flank[1] = s.toothAngle;
+    flank[2] = s.rCircle;
+    flank[3] = s.circleAngle;
+    face[0] = s.delZ;
+    face[1] = s.twist;
+    face[2] = 1.0f / std::sqrt(1.0f + s.twist * s.twist * s.rmaj * s.rmaj); // the twist stretches the field
+}
+
+float gearSdfDistance(const gearSdf &s, float x, float y, float z)
+{
+    // untwist, then fold onto the first half of tooth 0
+    const float c = std::cos(s.twist * z), sn = std::sin(s.twist * z);
+    const float px = c * x + sn * y, py = -sn * x + c * y;
+    const float r = std::sqrt(px * px + py * py), pitch = 2.0f * pi / s.N;
+    float phi = std::atan2(py, px) - s.toothAngle;
+    phi = std::fabs(phi - pitch * std::floor(phi / pitch + 0.5f));
+    float side;
+    if(r < s.rbc) side = r * std::sin(phi - s.baseHalf); // radial below the base circle
+    else if(s.rCircle > 0.0f){
+        const float dx = r * std::cos(phi) - s.rbc * std::cos(s.circleAngle), dy = r * std::sin(phi) - s.rbc * std::sin(s.circleAngle);
+        side = std::sqrt(dx * dx + dy * dy) - s.rCircle;
+    }
+    else side = s.rbc * (phi + involute(r, s.rbc) - s.baseHalf);
+    const float d2 = roundUnion(std::max(side, r - s.rmaj), r - s.rmin, s.filletR);
+    // extruded
+    const float w0 = d2, w1 = std::fabs(z) - s.delZ;
+    const float e0 = std::max(w0, 0.0f), e1 = std::max(w1, 0.0f);
+    return std::min(std::max(w0, w1), 0.0f) + std::sqrt(e0 * e0 + e1 * e1);
+}
@@ -0,0 +1,34 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef GEARSDF_H
+#define GEARSDF_H
+
+class gear;
+
+// A gear as a signed distance field, for the raymarched render mode. The
+// teeth fold onto half of tooth 0, where the flank is the involute (its
+// parallel curves are rotations of it, so the distance is rbc times the turn
+// between them), or the approximating circle, radial below the base circle,
+// blended into the root circle by a fillet of the generator's radius, and
+// extruded to the face width. Everything the shader needs is these numbers,
+// so a change of tooth count or pressure angle is just new uniforms.
+struct gearSdf
+{
+    float N, rbc, rmin, rmaj;        // the shader's teeth uniform
+    float baseHalf, toothAngle;      // half tooth angle at the base circle, tooth 0's centre line
+    float rCircle, circleAngle;      // gearApprox's flank circle, its centre on the base circle, 0 for the involute
+    float delZ, twist, filletR;      // faces at +-delZ, helix radians per unit z
+};
+
+// the field of g turned by rotDeg, as buildPairGear turns the pair's meshes
+gearSdf gearSdfShape(const gear &g, float rotDeg, float twist = 0.0f);
+
+// packed as the shader's teeth, flank and face uniforms
+void gearSdfUniforms(const gearSdf &s, float teeth[4], float flank[4], float face[3]);
+
+// the shader's field (myshaders.h), in the gear's frame
+float gearSdfDistance(const gearSdf &s, float x, float y, float z);
+
+#endif // GEARSDF_H
@@ -0,0 +1,186 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include "gear.h"
+#include "helical.h"
+#include "trace.h"
+
+static const float pi = 3.1415926535897932f;
+
+// Vertex layout, rings then the two end faces then the centres:
+//   K + 1 rings of the cut surface, ring k at z = delZ - 2 delZ k / K, each N
+//   sectors of Nt + 4: the outside diameter's two verticies, the minor
+//   diameter's two, then the tooth outline, first flank then second
+//   front face, N sectors of the Nt outline verticies, then the back face
+//   front centre, back centre
+// Index layout, the blank's (end faces, then the outside diameter slice by
+// slice) then the cut surface's slice by slice, so every slice's indices sit
+// at a fixed offset and the slices can be written in any order.
+
+unsigned int helixSlices(float delZ, float helix)
+{
+    // twist over the face is 2 delZ tan(helix) / rp against a pitch of 2 pi / N, with rp = N / 2
+    const float pitches = 2.0f * delZ * std::tan(std::fabs(helix)) / pi;
+    return std::max(1u, static_cast<unsigned int>(std::ceil(8.0f * pitches)));
+}
+
+helicalGear::helicalGear(const gear &spur, float helix, unsigned int iK):g(spur), N(spur.GetN()), K(std::max(1u, iK)),
+    Nt(static_cast<unsigned int>(spur.GetToothX().size())), nRing(N * (Nt + 4)),
+    nVertices((K + 1) * nRing + 2 * N * Nt + 2),
+    nIndices(static_cast<std::size_t>(6) * N * Nt + static_cast<std::size_t>(6) * K * N * Nt),
+    n1indices(static_cast<std::size_t>(6) * N * Nt + static_cast<std::size_t>(6) * K * N),
+    delZ(spur.GetDelZ()), twist(std::tan(helix) * 2.0f / static_cast<float>(spur.GetN()))
+{
+}
+
+// one ring of the cut surface, the outline turned by its sector and the twist at its z
+void helicalGear::ring(unsigned int k, float *vr) const
+{
+    const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+    const std::vector<float> &txn = g.GetToothXn(), &tyn = g.GetToothYn();
+    const unsigned int Ninv = Nt / 2;
+    const float z = delZ - 2.0f * delZ * static_cast<float>(k) / static_cast<float>(K);
+    const float rmaj = g.GetRmaj(), rmin = g.GetRmin();
+
+    for(unsigned int n=0; n<N; ++n){
+        const float theta = 2.0f * pi * static_cast<float>(n) / static_cast<float>(N) + twist * z;
+        const float cosx = std::cos(theta), sinx = std::sin(theta);
+        float *v = vr + 6 * (Nt + 4) * n;
+        // outside then minor diameter, normals radial as for the spur gear
+        const unsigned int edge[4] = {Ninv - 1, Nt - 1, 0, Ninv};
+        for(unsigned int e=0; e<4; ++e, v+=6){
+            const float x = tx[edge[e]], y = ty[edge[e]], r = e < 2 ? rmaj : rmin;
+            v[0] = cosx * x - sinx * y;
+            v[1] = sinx * x + cosx * y;
+            v[2] = z;
+            v[3] = v[0] / r;
+            v[4] = v[1] / r;
+            v[5] = 0.0f;
+        }
+        // the flanks, the helix tips the normal by the twist's turn of the point
+        for(unsigned int i=0; i<Nt; ++i, v+=6){
+            const float x = tx[i], y = ty[i], xn = txn[i], yn = tyn[i];
+            const float nz = -twist * (x * yn - y * xn);
+            const float norm = 1.0f / std::sqrt(1.0f + nz * nz);
+            v[0] = cosx * x - sinx * y;
+            v[1] = sinx * x + cosx * y;
+            v[2] = z;
+            v[3] = (cosx * xn - sinx * yn) * norm;
+            v[4] = (sinx * xn + cosx * yn) * norm;
+            v[5] = nz * norm;
+        }
+    }
+}
+
+// front and back faces with the fans to the centres, and the centres themselves
+void helicalGear::ends(float *vr, unsigned int *it) const
+{
+    const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+    const unsigned int Ninv = Nt / 2, face0 = (K + 1) * nRing, centre = nVertices - 2;
+
+    for(unsigned int side=0; side<2; ++side){
+        const float z = side ? -delZ : delZ, nz = side ? -1.0f : 1.0f;
+        const unsigned int face = face0 + side * N * Nt;
+        float *v = vr + 6 * face;
+        for(unsigned int n=0; n<N; ++n){
+            const float theta = 2.0f * pi * static_cast<float>(n) / static_cast<float>(N) + twist * z;
+            const float cosx = std::cos(theta), sinx = std::sin(theta);
+            for(unsigned int i=0; i<Nt; ++i, v+=6){
+                v[0] = cosx * tx[i] - sinx * ty[i];
+                v[1] = sinx * tx[i] + cosx * ty[i];
+                v[2] = z;
+                v[3] = 0.0f;
+                v[4] = 0.0f;
+                v[5] = nz;
+            }
+        }
+        // sides of the teeth, then 2 triangles to the centre, one reaching back a sector
+        for(unsigned int n=0; n<N; ++n){
+            const unsigned int f1 = face + n * Nt, f2 = f1 + Ninv;
+            const unsigned int prev2 = face + ((n + N - 1) % N) * Nt + Ninv;
+            for(unsigned int i=0; i+1<Ninv; ++i){
+                *it++ = f1 + i;
+                *it++ = f2 + i;
+                *it++ = f1 + i + 1;
+                *it++ = f2 + i;
+                *it++ = f1 + i + 1;
+                *it++ = f2 + i + 1;
+            }
+            *it++ = centre + side;
+            *it++ = f1;
+            *it++ = f2;
+            *it++ = centre + side;
+            *it++ = f1;
+            *it++ = prev2;
+        }
+    }
+    float *c = vr + 6 * centre;
+    const float centres[12] = {0.0f, 0.0f, delZ, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -delZ, 0.0f, 0.0f, -1.0f};
+    std::copy(centres, centres + 12, c);
+}
+
+// the outside diameter and the cut surface between rings k and k + 1
+void helicalGear::slice(unsigned int k, unsigned int *itOD, unsigned int *itCut) const
+{
+    const unsigned int R = Nt + 4, Ninv = Nt / 2;
+
+    for(unsigned int n=0; n<N; ++n){
+        const unsigned int p = k * nRing + n * R, q = p + nRing; // this sector, front and back ring
+        const unsigned int pp = k * nRing + ((n + N - 1) % N) * R, qp = pp + nRing; // previous sector
+        *itOD++ = p;
+        *itOD++ = p + 1;
+        *itOD++ = q;
+        *itOD++ = q;
+        *itOD++ = q + 1;
+        *itOD++ = p + 1;
+        // both flanks
+        for(unsigned int f=0; f<2; ++f){
+            const unsigned int a = p + 4 + f * Ninv, b = q + 4 + f * Ninv;
+            for(unsigned int i=0; i+1<Ninv; ++i){
+                *itCut++ = a + i;
+                *itCut++ = a + i + 1;
+                *itCut++ = b + i;
+                *itCut++ = a + i + 1;
+                *itCut++ = b + i;
+                *itCut++ = b + i + 1;
+            }
+        }
+        // minor diameter, from the previous tooth's second flank
+        *itCut++ = p + 2;
+        *itCut++ = q + 2;
+        *itCut++ = pp + 3;
+        *itCut++ = pp + 3;
+        *itCut++ = qp + 3;
+        *itCut++ = q + 2;
+    }
+}
+
+void helicalGear::fill(float *verts, unsigned int *inds, unsigned int threads) const
+{
+    TRACE_SCOPE("helicalGear::fill");
+    const std::size_t nEnds = static_cast<std::size_t>(6) * N * Nt;
+    const std::size_t nOD = static_cast<std::size_t>(6) * N, nCut = static_cast<std::size_t>(6) * N * (Nt - 1);
+    const unsigned int nJobs = K + 1; // rings, every slice but the last starts one
+
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, nJobs);
+    auto worker = [&](unsigned int first, unsigned int last){
+        for(unsigned int k=first; k<last; ++k){
+            ring(k, verts + 6 * static_cast<std::size_t>(k) * nRing);
+            if(k < K) slice(k, inds + nEnds + k * nOD, inds + n1indices + k * nCut);
+        }
+    };
+    std::vector<std::thread> pool;
+    const unsigned int chunk = (nJobs + threads - 1) / threads;
+    for(unsigned int t=1; t<threads; ++t){
+        pool.emplace_back(worker, std::min(nJobs, t * chunk), std::min(nJobs, (t + 1) * chunk));
+    }
+    ends(verts, inds);
+    worker(0, std::min(nJobs, chunk));
+    for(auto &t: pool) t.join();
+}
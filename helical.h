@@ -0,0 +1,45 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef HELICAL_H
+#define HELICAL_H
+
+#include <cstddef>
+
+class gear;
+
+// slices across the face width so the flanks follow a helix to an eighth
+// of a tooth pitch, the same for any N since the twist goes as 1 / rp
+unsigned int helixSlices(float delZ, float helix);
+
+// Helical gear, the spur gear's outline turned by z tan(helix) / rp along
+// the face and cut into K slices. The vertex count goes as N x K so the mesh
+// is written into buffers the caller allocates (or maps), with the slices
+// shared out over threads. Same vertex and index layout rules as gear,
+// 6 floats a vertex, the blank's indices then the cut surface's, the two
+// centre verticies last.
+class helicalGear
+{
+public:
+    // spur may be a gearBuild::sectors gear, only its tooth outline is used
+    helicalGear(const gear &spur, float helix, unsigned int K);
+    unsigned int GetN() const { return N; }
+    unsigned int GetSlices() const { return K; }
+    unsigned int GetNverts() const { return nVertices; }
+    std::size_t GetNInds() const { return nIndices; }
+    std::size_t GetN1Inds() const { return n1indices; }
+    // verts holds 6 * GetNverts() floats, inds GetNInds(), 0 threads uses every core
+    void fill(float *verts, unsigned int *inds, unsigned int threads = 0) const;
+private:
+    void ring(unsigned int k, float *vr) const;
+    void ends(float *vr, unsigned int *it) const;
+    void slice(unsigned int k, unsigned int *itOD, unsigned int *itCut) const;
+
+    const gear &g;
+    const unsigned int N, K, Nt, nRing, nVertices;
+    const std::size_t nIndices, n1indices;
+    const float delZ, twist; // twist is radians per unit z
+};
+
+#endif // HELICAL_H
@@ -0,0 +1,360 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "gear.h"
+#include "interference.h"
+#include "trace.h"
+
+namespace {
+
+const float pi = 3.1415926535897932f;
+const unsigned int binsPerTooth = 8;
+const unsigned int binReach = 2; // bins either side searched for the nearest segment
+const float touch = 1.0e-4f; // overlap below this (modules) is rounding, not interference
+
+float segDistance(float px, float py, float ax, float ay, float bx, float by)
+{
+    const float dx = bx - ax, dy = by - ay;
+    const float len2 = dx * dx + dy * dy;
+    float t = len2 > 0.0f ? ((px - ax) * dx + (py - ay) * dy) / len2 : 0.0f;
+    t = std::min(1.0f, std::max(0.0f, t));
+    const float ex = ax + t * dx - px, ey = ay + t * dy - py;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+// up to two points where the segment a->b crosses the circle of radius r about c,
+// returns how many, as parameters along the segment
+int circleCrossings(float ax, float ay, float bx, float by, float cx, float cy, float r, float s[2])
+{
+    const float dx = bx - ax, dy = by - ay, px = ax - cx, py = ay - cy;
+    const float qa = dx * dx + dy * dy, qb = px * dx + py * dy, qc = px * px + py * py - r * r;
+    const float disc = qb * qb - qa * qc;
+    if(qa == 0.0f || disc < 0.0f) return 0;
+    const float root = std::sqrt(disc);
+    int n = 0;
+    for(float t: {(-qb - root) / qa, (-qb + root) / qa}) if(t >= 0.0f && t <= 1.0f) s[n++] = t;
+    return n;
+}
+
+// angle difference wrapped into (-pi, pi]
+float wrapAngle(float a)
+{
+    a -= 2.0f * pi * std::floor(a / (2.0f * pi));
+    return a > pi ? a - 2.0f * pi : a;
+}
+
+// angle where the flank from point first to first+Ninv-1 crosses radius r
+float flankCrossing(const std::vector<float> &x, const std::vector<float> &y, unsigned int first, unsigned int n, float r)
+{
+    for(unsigned int i=first; i+1<first+n; ++i){
+        const float r0 = std::hypot(x[i], y[i]), r1 = std::hypot(x[i+1], y[i+1]);
+        if((r0 - r) * (r1 - r) <= 0.0f && r0 != r1){
+            const float t = (r - r0) / (r1 - r0);
+            return std::atan2(y[i] + t * (y[i+1] - y[i]), x[i] + t * (x[i+1] - x[i]));
+        }
+    }
+    return std::atan2(y[first+n-1], x[first+n-1]); // short tooth, use its tip
+}
+
+}
+
+gearOutline::gearOutline(gear &g) : N(g.GetN()), perTooth(static_cast<unsigned int>(g.GetToothX().size())),
+    nBins(binsPerTooth * g.GetN())
+{
+    TRACE_SCOPE("gearOutline::gearOutline");
+    const std::vector<float> &tx = g.GetToothX(), &ty = g.GetToothY();
+    const unsigned int Ninv = perTooth / 2, M = N * perTooth;
+
+    // tooth template in outline order, up the first flank and down the second
+    std::vector<float> ox(perTooth), oy(perTooth);
+    for(unsigned int i=0; i<Ninv; ++i){
+        ox[i] = tx[i];
+        oy[i] = ty[i];
+        ox[perTooth-1-i] = tx[Ninv+i];
+        oy[perTooth-1-i] = ty[Ninv+i];
+    }
+    x.resize(M);
+    y.resize(M);
+    for(unsigned int n=0; n<N; ++n){
+        const float theta = 2.0f * pi * (float) n / (float) N;
+        const float cosx = std::cos(theta), sinx = std::sin(theta);
+        for(unsigned int i=0; i<perTooth; ++i){
+            x[n*perTooth+i] = cosx * ox[i] - sinx * oy[i];
+            y[n*perTooth+i] = sinx * ox[i] + cosx * oy[i];
+        }
+    }
+    rmin = rmax = std::hypot(ox[0], oy[0]);
+    for(unsigned int i=0; i<perTooth; ++i){
+        rmax = std::max(rmax, std::hypot(ox[i], oy[i]));
+        rmin = std::min(rmin, std::hypot(ox[i], oy[i]));
+    }
+    const float rp = 0.5f * (float) N;
+    const float a0 = flankCrossing(tx, ty, 0, Ninv, rp), a1 = flankCrossing(tx, ty, Ninv, Ninv, rp);
+    toothCentre = std::atan2(std::sin(a0) + std::sin(a1), std::cos(a0) + std::cos(a1));
+
+    segRmin.resize(M);
+    segRmax.resize(M);
+    for(unsigned int i=0; i<M; ++i){
+        const unsigned int j = (i + 1) % M;
+        segRmin[i] = segDistance(0.0f, 0.0f, x[i], y[i], x[j], y[j]);
+        segRmax[i] = std::max(std::hypot(x[i], y[i]), std::hypot(x[j], y[j]));
+    }
+
+    // file each segment under every bin its angular span touches, counting first
+    std::vector<std::pair<unsigned int, unsigned int>> span(M);
+    binStart.assign(nBins + 1, 0);
+    for(unsigned int i=0; i<M; ++i){
+        const unsigned int j = (i + 1) % M;
+        unsigned int b0 = bin(std::atan2(y[i], x[i])), b1 = bin(std::atan2(y[j], x[j]));
+        // segments are short, so the shorter way round is the right one
+        if((b1 + nBins - b0) % nBins > nBins / 2) std::swap(b0, b1);
+        span[i] = {b0, (b1 + nBins - b0) % nBins};
+        for(unsigned int k=0; k<=span[i].second; ++k) ++binStart[(b0 + k) % nBins + 1];
+    }
+    for(unsigned int b=0; b<nBins; ++b) binStart[b+1] += binStart[b];
+    binSegs.resize(binStart[nBins]);
+    std::vector<unsigned int> fill(binStart.begin(), binStart.end() - 1);
+    for(unsigned int i=0; i<M; ++i){
+        for(unsigned int k=0; k<=span[i].second; ++k) binSegs[fill[(span[i].first + k) % nBins]++] = i;
+    }
+}
+
+unsigned int gearOutline::bin(float theta) const
+{
+    float t = theta / (2.0f * pi);
+    t -= std::floor(t);
+    return std::min(nBins - 1, static_cast<unsigned int>(t * (float) nBins));
+}
+
+// count crossings of the ray from the point directly away from the centre,
+// only segments in the point's bin can cross it
+bool gearOutline::inside(float px, float py) const
+{
+    const float r = std::hypot(px, py);
+    if(r >= rmax) return false;
+    if(r == 0.0f) return true;
+    const float ux = px / r, uy = py / r;
+    const unsigned int b = bin(std::atan2(py, px));
+    const unsigned int M = static_cast<unsigned int>(x.size());
+    bool bIn = false;
+
+    for(unsigned int k=binStart[b]; k<binStart[b+1]; ++k){
+        const unsigned int i = binSegs[k], j = (i + 1) % M;
+        const float ci = ux * y[i] - uy * x[i], cj = ux * y[j] - uy * x[j];
+        if((ci > 0.0f) == (cj > 0.0f)) continue;
+        const float s = ci / (ci - cj);
+        const float rx = x[i] + s * (x[j] - x[i]), ry = y[i] + s * (y[j] - y[i]);
+        if(ux * rx + uy * ry > r) bIn = !bIn;
+    }
+    return bIn;
+}
+
+float gearOutline::distance(float px, float py) const
+{
+    const unsigned int b = bin(std::atan2(py, px));
+    const unsigned int M = static_cast<unsigned int>(x.size());
+    float d = std::numeric_limits<float>::max();
+
+    for(unsigned int n=0; n<=2*binReach; ++n){
+        const unsigned int bn = (b + nBins + n - binReach) % nBins;
+        for(unsigned int k=binStart[bn]; k<binStart[bn+1]; ++k){
+            const unsigned int i = binSegs[k], j = (i + 1) % M;
+            d = std::min(d, segDistance(px, py, x[i], y[i], x[j], y[j]));
+        }
+    }
+    return d;
+}
+
+void gearOutline::facingTeeth(float rot, float rOther, float C, int &first, int &last) const
+{
+    const float pitch = 2.0f * pi / (float) N;
+    // half angle of our circle inside the other, widened by a tooth
+    const float cw = (rmax * rmax + C * C - rOther * rOther) / (2.0f * rmax * C);
+    const float w = std::acos(std::min(1.0f, std::max(-1.0f, cw))) + pitch;
+    const int n0 = static_cast<int>(std::lround(-(rot + toothCentre) / pitch));
+    const int reach = static_cast<int>(std::ceil(w / pitch));
+    first = n0 - reach;
+    last = n0 + reach;
+}
+
+// the outline turned by delta crosses radius r at theta when one of its own
+// crossings sits at theta - delta, which lies within limit of theta
+bool gearOutline::turnToPoint(float r, float theta, float sign, float limit, float &delta) const
+{
+    if(r > rmax || r < rmin) return false;
+    const float binWidth = 2.0f * pi / (float) nBins;
+    const int reach = static_cast<int>(std::ceil(limit / binWidth)) + 1;
+    const int b = static_cast<int>(bin(theta));
+    const unsigned int M = static_cast<unsigned int>(x.size());
+    bool bFound = false;
+    float s[2];
+
+    // the crossings wanted lie on the far side of theta from the turn
+    for(int n=0; n<=reach; ++n){
+        const int bs = b - static_cast<int>(sign) * n;
+        const unsigned int bn = static_cast<unsigned int>((bs % (int) nBins + (int) nBins) % (int) nBins);
+        for(unsigned int k=binStart[bn]; k<binStart[bn+1]; ++k){
+            const unsigned int i = binSegs[k], j = (i + 1) % M;
+            if(segRmin[i] > r || segRmax[i] < r) continue;
+            const int nc = circleCrossings(x[i], y[i], x[j], y[j], 0.0f, 0.0f, r, s);
+            for(int c=0; c<nc; ++c){
+                const float a = std::atan2(y[i] + s[c] * (y[j] - y[i]), x[i] + s[c] * (x[j] - x[i]));
+                const float d = sign * wrapAngle(theta - a);
+                if(d > 0.0f && d <= limit && (!bFound || d < delta)){
+                    delta = d;
+                    bFound = true;
+                }
+            }
+        }
+    }
+    return bFound;
+}
+
+bool gearOutline::turnPointTo(float cx, float cy, float r, float psi, float sign, float limit, float &delta) const
+{
+    // the arc the point can sweep, as seen from our centre
+    const float ax = cx + r * std::cos(psi), ay = cy + r * std::sin(psi);
+    const float end = psi + sign * limit, mid = psi + 0.5f * sign * limit;
+    const float a0 = std::atan2(ay, ax);
+    const float a1 = a0 + wrapAngle(std::atan2(cy + r * std::sin(end), cx + r * std::cos(end)) - a0);
+    const float am = a0 + wrapAngle(std::atan2(cy + r * std::sin(mid), cx + r * std::cos(mid)) - a0);
+    const float lo = std::min(a0, std::min(a1, am)), hi = std::max(a0, std::max(a1, am));
+    const float binWidth = 2.0f * pi / (float) nBins;
+    const int b0 = static_cast<int>(bin(lo)) - 1;
+    const int nb = static_cast<int>(std::ceil((hi - lo) / binWidth)) + 3;
+    const unsigned int M = static_cast<unsigned int>(x.size());
+    const float r2 = r * r;
+    bool bFound = false;
+    float s[2];
+
+    for(int n=0; n<nb && n<(int) nBins; ++n){
+        const unsigned int bn = static_cast<unsigned int>(((b0 + n) % (int) nBins + (int) nBins) % (int) nBins);
+        for(unsigned int k=binStart[bn]; k<binStart[bn+1]; ++k){
+            const unsigned int i = binSegs[k], j = (i + 1) % M;
+            const float di = (x[i] - cx) * (x[i] - cx) + (y[i] - cy) * (y[i] - cy);
+            const float dj = (x[j] - cx) * (x[j] - cx) + (y[j] - cy) * (y[j] - cy);
+            if(di < r2 && dj < r2) continue; // wholly inside the circle
+            const int nc = circleCrossings(x[i], y[i], x[j], y[j], cx, cy, r, s);
+            for(int c=0; c<nc; ++c){
+                const float a = std::atan2(y[i] + s[c] * (y[j] - y[i]) - cy, x[i] + s[c] * (x[j] - x[i]) - cx);
+                const float d = sign * wrapAngle(a - psi);
+                if(d > 0.0f && d <= limit && (!bFound || d < delta)){
+                    delta = d;
+                    bFound = true;
+                }
+            }
+        }
+    }
+    return bFound;
+}
+
+namespace {
+
+// deepest point of src's teeth facing dst that lies inside dst, src's centre is the
+// origin and dst's is (C, 0), rotations are of each gear's tooth 0 in radians
+float penetration(const gearOutline &src, float rotSrc, const gearOutline &dst, float rotDst, float C)
+{
+    const unsigned int Ns = src.GetN(), per = src.GetToothNpts();
+    const float rd = dst.GetRmax();
+    int first, last;
+    src.facingTeeth(rotSrc, rd, C, first, last);
+    const float cs = std::cos(rotSrc), ss = std::sin(rotSrc);
+    const float cd = std::cos(-rotDst), sd = std::sin(-rotDst);
+    const std::vector<float> &x = src.GetX(), &y = src.GetY();
+    float depth = 0.0f;
+
+    for(int n=first; n<=last; ++n){
+        const unsigned int tooth = static_cast<unsigned int>(((n % (int) Ns) + (int) Ns) % (int) Ns);
+        for(unsigned int i=tooth*per; i<(tooth+1)*per; ++i){
+            const float wx = cs * x[i] - ss * y[i] - C, wy = ss * x[i] + cs * y[i];
+            if(wx * wx + wy * wy >= rd * rd) continue;
+            const float lx = cd * wx - sd * wy, ly = sd * wx + cd * wy;
+            if(dst.inside(lx, ly)) depth = std::max(depth, dst.distance(lx, ly));
+        }
+    }
+    return depth;
+}
+
+}
+
+void restingPhase(const gearOutline &a, const gearOutline &b, float &rotA, float &rotB)
+{
+    rotA = -a.GetToothCentre();
+    rotB = pi - b.GetToothCentre() - pi / (float) b.GetN();
+}
+
+float outlineOverlap(const gearOutline &a, float rotA, const gearOutline &b, float rotB, float C)
+{
+    const float d = penetration(a, rotA, b, rotB, C);
+    // from b's centre a lies along -x, so turn the whole scene half a revolution
+    return std::max(d, penetration(b, rotB - pi, a, rotA - pi, C));
+}
+
+interferenceReport findInterference(gear &a, gear &b, unsigned int steps, float separation)
+{
+    TRACE_SCOPE("findInterference");
+    const auto t0 = std::chrono::steady_clock::now();
+    interferenceReport r;
+    const gearOutline oa(a), ob(b);
+    const float Na = (float) a.GetN(), Nb = (float) b.GetN();
+    const float C = 0.5f * (Na + Nb) + separation;
+    const float pitchA = 2.0f * pi / Na;
+    float baseA, baseB;
+
+    restingPhase(oa, ob, baseA, baseB);
+    r.steps = steps;
+    r.depth.resize(steps);
+    bool bIn = false;
+    for(unsigned int k=0; k<steps; ++k){
+        const float phi = pitchA * (float) k / (float) steps;
+        const float d = outlineOverlap(oa, baseA + phi, ob, baseB - phi * Na / Nb, C);
+        r.depth[k] = d;
+        const float deg = phi * 180.0f / pi;
+        if(d > r.maxDepth){
+            r.maxDepth = d;
+            r.maxDepthAngle = deg;
+        }
+        if(d > touch && !bIn) r.ranges.push_back({deg, deg});
+        if(d > touch) r.ranges.back().second = deg;
+        bIn = d > touch;
+    }
+    // rack cutter limit, N sin^2(pa) >= 2
+    r.bUndercutA = Na * std::pow(std::sin(a.GetPa()), 2.0f) < 2.0f;
+    r.bUndercutB = Nb * std::pow(std::sin(b.GetPa()), 2.0f) < 2.0f;
+    r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+std::string interferenceSummary(const interferenceReport &r)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(3);
+    if(r.ranges.empty()) os << "no interference";
+    else os << "interference " << r.maxDepth << " deep";
+    if(r.bUndercutA || r.bUndercutB) os << ", undercut";
+    return os.str();
+}
+
+std::string interferenceDetail(const interferenceReport &r)
+{
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(2);
+    if(r.ranges.empty()) os << "no overlap of the profiles over one pitch";
+    else{
+        os << "profiles overlap at gear a rotations (degrees into the pitch)";
+        for(const auto &range: r.ranges) os << "\n  " << range.first << " to " << range.second;
+        os << std::setprecision(4) << "\ndeepest " << r.maxDepth << " modules at " << std::setprecision(2) << r.maxDepthAngle;
+    }
+    if(r.bUndercutA) os << "\ngear a has too few teeth to cut without undercut";
+    if(r.bUndercutB) os << "\ngear b has too few teeth to cut without undercut";
+    os << "\n" << r.steps << " positions in " << std::setprecision(1) << r.ms << " ms";
+    return os.str();
+}
@@ -0,0 +1,73 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef INTERFERENCE_H
+#define INTERFERENCE_H
+
+#include <vector>
+#include <utility>
+#include <string>
+
+class gear;
+
+// Closed 2D outline of a whole gear in its own frame, with the segments
+// filed in angular bins so a point only meets the few segments a ray
+// from the centre through it could cross
+class gearOutline
+{
+public:
+    explicit gearOutline(gear &g);
+    bool inside(float x, float y) const;
+    float distance(float x, float y) const; // to the outline, searching the neighbouring bins
+    // teeth first..last (taken modulo N) can reach a circle of radius rOther
+    // centred C along +x, when the gear is turned by rot
+    void facingTeeth(float rot, float rOther, float C, int &first, int &last) const;
+    // smallest anticlockwise (sign 1) or clockwise (sign -1) turn of the outline, no more
+    // than limit, that brings it to the point at radius r and angle theta
+    bool turnToPoint(float r, float theta, float sign, float limit, float &delta) const;
+    // the same for a point at angle psi on a circle of radius r about (cx, cy), turning
+    // about that centre while the outline stays put
+    bool turnPointTo(float cx, float cy, float r, float psi, float sign, float limit, float &delta) const;
+    unsigned int GetN() const { return N; }
+    unsigned int GetToothNpts() const { return perTooth; }
+    const std::vector<float>& GetX() const { return x; }
+    const std::vector<float>& GetY() const { return y; }
+    float GetRmax() const { return rmax; }
+    float GetRmin() const { return rmin; }
+    float GetToothCentre() const { return toothCentre; } // angle of tooth 0's centre line at the pitch circle
+private:
+    unsigned int bin(float theta) const;
+    const unsigned int N, perTooth, nBins;
+    std::vector<float> x, y;
+    std::vector<unsigned int> binStart, binSegs; // segments of bin b are binSegs[binStart[b]..binStart[b+1])
+    std::vector<float> segRmin, segRmax; // nearest and furthest each segment gets to the centre
+    float rmax = 0.0f, rmin = 0.0f, toothCentre = 0.0f;
+};
+
+struct interferenceReport
+{
+    unsigned int steps = 0; // mesh positions tried over one pitch of gear a
+    float maxDepth = 0.0f; // deepest overlap of the two outlines, in modules
+    float maxDepthAngle = 0.0f; // gear a's rotation there, degrees
+    std::vector<float> depth; // overlap at each step
+    std::vector<std::pair<float, float>> ranges; // gear a rotations with overlap, degrees
+    bool bUndercutA = false, bUndercutB = false; // fewer teeth than a rack cutter can make without undercut
+    double ms = 0.0;
+};
+
+// rotations of the pair's tooth 0s that put a tooth of a on the line of centres,
+// facing the middle of a gap of b, a centred on the origin and b on +x
+void restingPhase(const gearOutline &a, const gearOutline &b, float &rotA, float &rotB);
+
+// deepest point of either outline inside the other, b's centre at (C, 0)
+float outlineOverlap(const gearOutline &a, float rotA, const gearOutline &b, float rotB, float C);
+
+// sweep gear b through one pitch of gear a, at the standard centre distance plus separation
+interferenceReport findInterference(gear &a, gear &b, unsigned int steps = 240, float separation = 0.0f);
+
+// one line summary, and a longer description of the ranges
+std::string interferenceSummary(const interferenceReport &r);
+std::string interferenceDetail(const interferenceReport &r);
+
+#endif // INTERFERENCE_H
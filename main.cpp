@@ -1,9 +1,13 @@
 #include "widget.h"
 #include "scroller.h"
+#include "cli.h"
+#include "trace.h"
 #include <QApplication>
 #include <QScrollArea>
 #include <QIcon>
 #include <fstream>
+#include <iostream>
+#include <string>
 #include <memory>
 
 #ifdef _WIN32
@@ -60,11 +64,26 @@ bool MyApplication::notify(QObject* receiver, QEvent* event)
 
 int main(int argc, char *argv[])
 {
+    int exitCode;
+    if(runCli(argc, argv, exitCode)) return exitCode; // headless, no QApplication
+
     MyApplication app(argc, argv);
     
     auto scroller = std::make_unique<Scroller>();
     auto wiget = std::make_unique<Widget>(scroller.get());
     scroller->setWidget(wiget.get());
+    std::string replayFile, timingsFile, traceFile;
+    for(int i=1; i+1<argc; ++i){
+        const std::string arg = argv[i];
+        if(arg == "--record") wiget->record(argv[++i]);
+        else if(arg == "--replay") replayFile = argv[++i];
+        else if(arg == "--timings") timingsFile = argv[++i];
+        else if(arg == "--trace") traceFile = argv[++i];
+    }
+    if(!replayFile.empty() && !wiget->replay(replayFile, timingsFile)){
+        std::cerr << "can't read event log " << replayFile << std::endl;
+        return 1;
+    }
     auto w = QDesktopWidget().availableGeometry().width();
     auto h = QDesktopWidget().availableGeometry().height();
     w = (w > 1392) ? 1392 : w;
@@ -81,5 +100,7 @@ int main(int argc, char *argv[])
 #endif
 
     scroller->show();
-    return app.exec();
+    exitCode = app.exec();
+    if(!traceFile.empty()) traceWrite(traceFile);
+    return exitCode;
 }
@@ -0,0 +1,102 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include "meshcache.h"
+
+#include <chrono>
+
+std::shared_ptr<const gearPair> meshCache::find(const pairKey &key)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    for(auto it=entries.begin(); it!=entries.end(); ++it){
+        if(it->key == key){
+            if(it->pair.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return nullptr;
+            entries.splice(entries.begin(), entries, it); // move to front
+            return entries.front().pair.get();
+        }
+    }
+    return nullptr;
+}
+
+// building is done without holding the lock, a second thread asking for
+// the same pair meanwhile shares the first one's future rather than building it too
+std::shared_ptr<const gearPair> meshCache::get(const pairKey &key)
+{
+    std::promise<std::shared_ptr<const gearPair>> promise;
+    std::unique_lock<std::mutex> lock(mtx);
+
+    for(auto it=entries.begin(); it!=entries.end(); ++it){
+        if(it->key == key){
+            entries.splice(entries.begin(), entries, it); // move to front
+            std::shared_future<std::shared_ptr<const gearPair>> pair = entries.front().pair;
+            lock.unlock(); // not held while waiting on the build
+            return pair.get();
+        }
+    }
+    entries.push_front(entry{key, promise.get_future().share(), 0});
+    const auto mine = entries.begin(); // list iterators survive splices, and trim() and insert() leave unbuilt entries be
+    lock.unlock();
+    std::shared_ptr<const gearPair> pair;
+    try{
+        pair = std::make_shared<const gearPair>(buildGearPair(key.Na, key.Nb, key.pa, key.bExact, key.detail));
+    }
+    catch(...){ // out of memory most likely, waiters get the same exception and the entry goes
+        promise.set_exception(std::current_exception());
+        lock.lock();
+        entries.erase(mine);
+        throw;
+    }
+    promise.set_value(pair);
+    lock.lock();
+    mine -> bytes = pair -> bytes();
+    trim();
+    return pair;
+}
+
+void meshCache::insert(const pairKey &key, std::shared_ptr<const gearPair> pair)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::promise<std::shared_ptr<const gearPair>> promise;
+    const std::size_t bytes = pair -> bytes();
+
+    entries.remove_if([&key](const entry &e){ return e.key == key && e.bytes; }); // a build under way finishes into its own entry
+    promise.set_value(std::move(pair));
+    entries.push_front(entry{key, promise.get_future().share(), bytes});
+    trim();
+}
+
+void meshCache::setByteLimit(std::size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    byteLimit = maxBytes;
+    trim();
+}
+
+std::size_t meshCache::bytes()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::size_t total = 0;
+
+    for(const auto &e: entries) total += e.bytes;
+    return total;
+}
+
+// the most recent pair is always kept, it's the one just asked for. Pairs still
+// being built are kept too, they hold no bytes yet and their builder fills them in
+void meshCache::trim()
+{
+    std::size_t total = 0;
+    std::size_t count = entries.size();
+
+    for(const auto &e: entries) total += e.bytes;
+    for(auto it=entries.end(); it!=entries.begin() && (count > maxSize || (byteLimit && total > byteLimit));){
+        --it;
+        if(it == entries.begin()) break;
+        if(!it -> bytes) continue;
+        total -= it -> bytes;
+        --count;
+        it = entries.erase(it);
+    }
+}
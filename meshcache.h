@@ -0,0 +1,52 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <memory>
+#include <mutex>
+#include <future>
+#include <list>
+#include "gearpair.h"
+
+// identifies one gear pair configuration
+struct pairKey
+{
+    unsigned int Na, Nb;
+    float pa;
+    bool bExact;
+    gearDetail detail;
+    bool operator==(const pairKey &k) const
+    { return Na == k.Na && Nb == k.Nb && pa == k.pa && bExact == k.bExact && detail == k.detail; }
+};
+
+// thread safe store of recently built gear pairs, least recently used is dropped first once
+// there are more than capacity pairs or they hold more than maxBytes, 0 for no byte bound.
+// A pair being built is in the cache already, so asking for it again waits on that build
+class meshCache
+{
+public:
+    explicit meshCache(unsigned int capacity = 24, std::size_t maxBytes = 256 * 1024 * 1024)
+        : maxSize(capacity), byteLimit(maxBytes) {}
+    std::shared_ptr<const gearPair> find(const pairKey &key); // built pairs only
+    std::shared_ptr<const gearPair> get(const pairKey &key); // find, join a build under way, or build and insert
+    void insert(const pairKey &key, std::shared_ptr<const gearPair> pair);
+    void setByteLimit(std::size_t maxBytes);
+    std::size_t bytes(); // every built pair's gearPair::bytes
+private:
+    struct entry
+    {
+        pairKey key;
+        std::shared_future<std::shared_ptr<const gearPair>> pair;
+        std::size_t bytes; // 0 while it's being built
+    };
+    void trim(); // mtx must be held
+    const unsigned int maxSize;
+    std::size_t byteLimit;
+    std::mutex mtx;
+    std::list<entry> entries; // most recent at front
+};
+
+#endif // MESHCACHE_H
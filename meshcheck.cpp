@@ -0,0 +1,180 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include "gear.h"
+#include "meshcheck.h"
+
+namespace {
+
+// the grid of gears covered by the golden file
+const unsigned int gridN[] = {6, 8, 9, 12, 16, 25, 40, 80, 200, 1000};
+const float gridPa[] = {14.5f, 20.0f, 25.0f}; // degrees
+
+void buildMesh(bool bExact, unsigned int N, float paDeg, std::vector<float> &verts, std::vector<unsigned int> &inds)
+{
+    const float pa = static_cast<float>(paDeg * 3.14159265358979323846 / 180.0);
+    std::unique_ptr<gear> g;
+
+    if(bExact) g = std::make_unique<gear>(N, pa, 5.0f);
+    else g = std::make_unique<gearApprox>(N, pa, 5.0f);
+    verts = std::move(g -> GetVerts());
+    inds = std::move(g -> GetInds());
+}
+
+std::string refFileName(const std::string &refDir, bool bExact, unsigned int N, float paDeg)
+{
+    std::ostringstream os;
+    os << refDir << '/' << (bExact ? "exact_" : "approx_") << N << '_' << paDeg << ".mesh";
+    return os.str();
+}
+
+// raw dump: vertex float count, index count, then the two arrays
+bool writeRef(const std::string &fileName, const std::vector<float> &verts, const std::vector<unsigned int> &inds)
+{
+    std::ofstream fout(fileName, std::ios::binary);
+    const std::uint64_t nv = verts.size(), ni = inds.size();
+    fout.write(reinterpret_cast<const char*>(&nv), sizeof(nv));
+    fout.write(reinterpret_cast<const char*>(&ni), sizeof(ni));
+    fout.write(reinterpret_cast<const char*>(verts.data()), nv * sizeof(float));
+    fout.write(reinterpret_cast<const char*>(inds.data()), ni * sizeof(unsigned int));
+    return static_cast<bool>(fout);
+}
+
+bool readRef(const std::string &fileName, std::vector<float> &verts, std::vector<unsigned int> &inds)
+{
+    std::ifstream fin(fileName, std::ios::binary);
+    std::uint64_t nv, ni;
+    if(!fin.read(reinterpret_cast<char*>(&nv), sizeof(nv))) return false;
+    if(!fin.read(reinterpret_cast<char*>(&ni), sizeof(ni))) return false;
+    verts.resize(nv);
+    inds.resize(ni);
+    fin.read(reinterpret_cast<char*>(verts.data()), nv * sizeof(float));
+    fin.read(reinterpret_cast<char*>(inds.data()), ni * sizeof(unsigned int));
+    return static_cast<bool>(fin);
+}
+
+}
+
+// 64 bit FNV-1a, byte at a time, plenty fast for meshes of this size
+std::uint64_t fnv1a(const void *data, std::size_t bytes)
+{
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = 14695981039346656037ULL;
+
+    for(std::size_t i=0; i<bytes; ++i){
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+meshDiff compareMeshes(const std::vector<float> &verts, const std::vector<unsigned int> &inds,
+                       const std::vector<float> &refVerts, const std::vector<unsigned int> &refInds)
+{
+    meshDiff d;
+
+    d.bSameSize = verts.size() == refVerts.size() && inds.size() == refInds.size();
+    const std::size_t nv = std::min(verts.size(), refVerts.size());
+    for(std::size_t i=0; i<nv; ++i){
+        const float dev = std::fabs(verts[i] - refVerts[i]);
+        if(dev > d.maxDeviation || std::isnan(dev)) d.maxDeviation = dev;
+        if(d.firstVert < 0 && verts[i] != refVerts[i]) d.firstVert = i;
+    }
+    const std::size_t ni = std::min(inds.size(), refInds.size());
+    for(std::size_t i=0; i<ni; ++i){
+        if(inds[i] != refInds[i]){
+            d.firstInd = i;
+            break;
+        }
+    }
+    if(d.firstVert < 0 && verts.size() != refVerts.size()) d.firstVert = nv;
+    if(d.firstInd < 0 && inds.size() != refInds.size()) d.firstInd = ni;
+    return d;
+}
+
+bool goldenWrite(const std::string &fileName, const std::string &refDir, std::ostream &log)
+{
+    std::ofstream fout(fileName);
+    if(!fout) return false;
+    std::vector<float> verts;
+    std::vector<unsigned int> inds;
+
+    fout << "# golden gear meshes: profile N pa(degrees) vertex-floats indices vertex-hash index-hash\n";
+    for(bool bExact: {true, false}){
+        for(unsigned int N: gridN){
+            for(float paDeg: gridPa){
+                buildMesh(bExact, N, paDeg, verts, inds);
+                fout << (bExact ? "exact " : "approx ") << N << ' ' << paDeg << ' ';
+                fout << verts.size() << ' ' << inds.size() << ' ' << std::hex;
+                fout << fnv1a(verts.data(), verts.size() * sizeof(float)) << ' ';
+                fout << fnv1a(inds.data(), inds.size() * sizeof(unsigned int)) << std::dec << '\n';
+                if(!refDir.empty() && !writeRef(refFileName(refDir, bExact, N, paDeg), verts, inds)){
+                    log << "can't write reference mesh to " << refDir << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return static_cast<bool>(fout);
+}
+
+int goldenCheck(const std::string &fileName, const std::string &refDir, float tolerance, std::ostream &log)
+{
+    std::ifstream fin(fileName);
+    if(!fin){
+        log << "can't read " << fileName << std::endl;
+        return 1;
+    }
+    std::vector<float> verts, refVerts;
+    std::vector<unsigned int> inds, refInds;
+    std::string line;
+    int failures = 0, cases = 0;
+
+    while(std::getline(fin, line)){
+        if(line.empty() || line[0] == '#') continue;
+        std::istringstream is(line);
+        std::string profile;
+        unsigned int N;
+        float paDeg;
+        std::size_t nv, ni;
+        std::uint64_t vHash, iHash;
+        if(!(is >> profile >> N >> paDeg >> nv >> ni >> std::hex >> vHash >> iHash)){
+            log << "bad line in " << fileName << ": " << line << std::endl;
+            ++failures;
+            continue;
+        }
+        ++cases;
+        const bool bExact = profile == "exact";
+        buildMesh(bExact, N, paDeg, verts, inds);
+        if(verts.size() == nv && inds.size() == ni &&
+           fnv1a(verts.data(), nv * sizeof(float)) == vHash &&
+           fnv1a(inds.data(), ni * sizeof(unsigned int)) == iHash) continue;
+
+        log << profile << " N=" << N << " pa=" << paDeg << ": ";
+        if(refDir.empty() || !readRef(refFileName(refDir, bExact, N, paDeg), refVerts, refInds)){
+            log << "hash mismatch, " << verts.size() << '/' << nv << " vertex floats, ";
+            log << inds.size() << '/' << ni << " indices, no reference mesh to measure" << std::endl;
+            ++failures;
+            continue;
+        }
+        const meshDiff d = compareMeshes(verts, inds, refVerts, refInds);
+        const bool bPass = tolerance > 0.0f && d.bSameSize && d.firstInd < 0 && d.maxDeviation <= tolerance;
+        log << (bPass ? "within tolerance" : "MISMATCH") << ", max vertex deviation " << std::setprecision(6) << d.maxDeviation;
+        if(d.firstVert >= 0) log << ", first differing vertex float " << d.firstVert << " (vertex " << d.firstVert / 6 << ")";
+        if(d.firstInd >= 0) log << ", first differing index " << d.firstInd;
+        if(!d.bSameSize) log << ", sizes differ";
+        log << std::endl;
+        if(!bPass) ++failures;
+    }
+    log << cases - failures << " of " << cases << " golden meshes match" << std::endl;
+    return failures;
+}
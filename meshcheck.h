@@ -0,0 +1,40 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef MESHCHECK_H
+#define MESHCHECK_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iosfwd>
+
+// Golden mesh regression checks, so a rewrite of the gear generator
+// can be shown to produce the same geometry as a trusted revision.
+// The golden file holds a hash of every mesh in the grid, a reference
+// directory optionally holds the meshes themselves so that a mismatch
+// can be measured, and tolerated when within a given deviation.
+
+std::uint64_t fnv1a(const void *data, std::size_t bytes);
+
+struct meshDiff
+{
+    bool bSameSize = true;
+    float maxDeviation = 0.0f; // largest absolute difference over all vertex floats
+    long long firstVert = -1;  // first differing vertex float, -1 if none
+    long long firstInd = -1;   // first differing index, -1 if none
+};
+
+meshDiff compareMeshes(const std::vector<float> &verts, const std::vector<unsigned int> &inds,
+                       const std::vector<float> &refVerts, const std::vector<unsigned int> &refInds);
+
+// writes the golden file, and the meshes to refDir if it isn't empty
+bool goldenWrite(const std::string &fileName, const std::string &refDir, std::ostream &log);
+
+// checks the current generator against the golden file, returns the number of failures.
+// With tolerance > 0 a mesh whose hash differs passes if its reference mesh
+// is found in refDir, the indices match, and no vertex float moved more than tolerance.
+int goldenCheck(const std::string &fileName, const std::string &refDir, float tolerance, std::ostream &log);
+
+#endif // MESHCHECK_H
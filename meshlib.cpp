@@ -0,0 +1,114 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+#include "gear.h"
+#include "gearpair.h"
+#include "meshlib.h"
+
+namespace {
+
+const char libMagic[8] = "GEARLIB";
+const std::uint32_t libByteOrder = 0x01020304;
+
+std::uint64_t alignUp(std::uint64_t x)
+{
+    return (x + meshLibAlign - 1) / meshLibAlign * meshLibAlign;
+}
+
+void pad(std::ofstream &fout, std::uint64_t to)
+{
+    static const char zeros[meshLibAlign] = {};
+    const std::uint64_t at = static_cast<std::uint64_t>(fout.tellp());
+    if(to > at) fout.write(zeros, to - at);
+}
+
+}
+
+const std::vector<unsigned int>& meshLibCatalogue()
+{
+    static const std::vector<unsigned int> teeth = {
+        8, 10, 12, 14, 15, 16, 18, 20, 24, 25, 28, 30, 32, 35, 36, 40, 45, 48, 50,
+        56, 60, 64, 70, 72, 75, 80, 90, 96, 100, 120, 127, 144, 150, 160, 180, 200};
+    return teeth;
+}
+
+std::string meshLibFileName(const std::string &dir, unsigned int N, float pa, bool bExact)
+{
+    std::ostringstream os;
+    // pressure angle in tenths of a degree
+    os << dir << '/' << (bExact ? "exact_" : "approx_") << N << '_' << std::lround(pa * 1800.0 / 3.14159265358979323846) << ".glib";
+    return os.str();
+}
+
+const meshLibHeader* meshLibCheck(const void *data, std::size_t size, unsigned int N, float pa, bool bExact)
+{
+    if(size < sizeof(meshLibHeader)) return nullptr;
+    const meshLibHeader *h = static_cast<const meshLibHeader*>(data);
+    if(std::memcmp(h->magic, libMagic, sizeof(libMagic)) != 0) return nullptr;
+    if(h->formatVersion != meshLibFormatVersion || h->generatorVersion != gearGeneratorVersion) return nullptr;
+    if(h->byteOrder != libByteOrder) return nullptr;
+    if(h->N != N || h->pa != pa || h->bExact != (bExact ? 1u : 0u)) return nullptr;
+    const std::uint64_t vBytes = 6ull * sizeof(float) * h->nVertices, iBytes = 4ull * h->nIndices;
+    for(auto off: h->vertOffset) if(off % meshLibAlign || off + vBytes > size) return nullptr;
+    if(h->indOffset % meshLibAlign || h->indOffset + iBytes > size) return nullptr;
+    return h;
+}
+
+bool meshLibWrite(const std::string &dir, unsigned int N, float pa, bool bExact)
+{
+    std::unique_ptr<gear> g[2] = {buildPairGear(N, pa, bExact, 0), buildPairGear(N, pa, bExact, 1)};
+    meshLibHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, libMagic, sizeof(libMagic));
+    h.formatVersion = meshLibFormatVersion;
+    h.generatorVersion = gearGeneratorVersion;
+    h.byteOrder = libByteOrder;
+    h.N = N;
+    h.pa = pa;
+    h.bExact = bExact ? 1 : 0;
+    h.nVertices = g[0] -> GetNverts();
+    h.nIndices = g[0] -> GetNInds();
+    h.n1indices = g[0] -> GetN1Inds();
+    const std::uint64_t vBytes = 6ull * sizeof(float) * h.nVertices;
+    h.vertOffset[0] = alignUp(sizeof(h));
+    h.vertOffset[1] = alignUp(h.vertOffset[0] + vBytes);
+    h.indOffset = alignUp(h.vertOffset[1] + vBytes);
+
+    // indices don't depend on rotation or thickness, so both roles share them
+    const std::string fileName = meshLibFileName(dir, N, pa, bExact);
+    std::ofstream fout(fileName, std::ios::binary);
+    fout.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    for(int i=0; i<2; ++i){
+        pad(fout, h.vertOffset[i]);
+        fout.write(reinterpret_cast<const char*>(g[i] -> GetVerts().data()), vBytes);
+    }
+    pad(fout, h.indOffset);
+    fout.write(reinterpret_cast<const char*>(g[0] -> GetInds().data()), 4ull * h.nIndices);
+    return static_cast<bool>(fout);
+}
+
+int meshLibPrebuild(const std::string &dir, const std::vector<unsigned int> &teeth, std::ostream &log)
+{
+    const float paDegrees[3] = {14.5f, 20.0f, 25.0f};
+    int count = 0;
+
+    for(unsigned int N: teeth){
+        for(float paDeg: paDegrees){
+            const float pa = static_cast<float>(paDeg * 3.14159265358979323846 / 180.0);
+            for(bool bExact: {true, false}){
+                if(meshLibWrite(dir, N, pa, bExact)) ++count;
+                else log << "failed writing " << meshLibFileName(dir, N, pa, bExact) << std::endl;
+            }
+        }
+    }
+    log << count << " gears written to " << dir << std::endl;
+    return count;
+}
@@ -0,0 +1,50 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef MESHLIB_H
+#define MESHLIB_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <iosfwd>
+
+// Prebuilt gear mesh library, one file per (N, pa, profile) holding the
+// gear already rotated into place for both roles of the pair. The file
+// is laid out to be memory mapped and handed to glBufferSubData as is:
+// header, gear a's vertices, gear b's vertices, then the shared indices,
+// each block starting on a meshLibAlign byte boundary.
+
+const std::uint32_t meshLibFormatVersion = 1;
+const std::size_t meshLibAlign = 64;
+
+struct meshLibHeader
+{
+    char magic[8];                  // "GEARLIB"
+    std::uint32_t formatVersion;    // meshLibFormatVersion
+    std::uint32_t generatorVersion; // gearGeneratorVersion
+    std::uint32_t byteOrder;        // 0x01020304 as written by the host
+    std::uint32_t N;
+    float pa;
+    std::uint32_t bExact;
+    std::uint32_t nVertices, nIndices, n1indices;
+    std::uint64_t vertOffset[2];    // bytes from the start of the file, gear a then gear b
+    std::uint64_t indOffset;
+};
+
+// the catalogue of standard tooth counts built by meshLibPrebuild
+const std::vector<unsigned int>& meshLibCatalogue();
+
+std::string meshLibFileName(const std::string &dir, unsigned int N, float pa, bool bExact);
+
+// checks a mapped file is complete, for this generator and host, and holds the wanted gear
+const meshLibHeader* meshLibCheck(const void *data, std::size_t size, unsigned int N, float pa, bool bExact);
+
+bool meshLibWrite(const std::string &dir, unsigned int N, float pa, bool bExact);
+
+// writes the catalogue for the three standard pressure angles and both profiles, returns files written
+int meshLibPrebuild(const std::string &dir, const std::vector<unsigned int> &teeth, std::ostream &log);
+
+#endif // MESHLIB_H
@@ -3,78 +3,432 @@
 
 #endif // MYSHADERS_H
 
-static const char *vertexShaderSourceNew = R"glsl(
+static const char *const vertexShaderSourceNew = R"glsl(
     #version 330
     layout (location = 0) in vec3 aPos;
     layout (location = 1) in vec3 aNormal;
+    // the outputs below captured by transform feedback, read instead of aPos and aNormal when cached
+    layout (location = 2) in vec3 cFragPos;
+    layout (location = 3) in vec3 cNormal;
+    layout (location = 4) in vec3 cLocal;
+    layout (location = 5) in vec2 cLocalNormal;
     out vec3 Normal, FragPos;
+    out vec3 Local; // on the spur mesh, z along the face, for the analytic flank normals
+    out vec2 LocalNormal;
     uniform mat4 matrix;
     uniform mat4 perspective;
     uniform mat4 rot;
+    uniform float twist; // helix, radians per unit z, 0 for a spur gear
+    uniform vec3 slice; // centre z of the first slice, z between slices, scale of the mesh's z
+    uniform int sliceBase;
+    uniform bool cached;
 
+    // a helical gear draws the spur mesh once per slice,
+    // squashed into the slice and turned by the twist at each z
     void main()
     {
-       gl_Position = perspective * matrix * vec4(aPos, 1.0);
-       Normal = vec3(rot * vec4(aNormal, 0.0));
-       FragPos = vec3(matrix * vec4(aPos, 1.0));
+       if(cached){
+          gl_Position = perspective * vec4(cFragPos, 1.0);
+          Normal = cNormal;
+          FragPos = cFragPos;
+          Local = cLocal;
+          LocalNormal = cLocalNormal;
+          return;
+       }
+       float z = slice.x + slice.y * float(gl_InstanceID + sliceBase) + slice.z * aPos.z;
+       float c = cos(twist * z), s = sin(twist * z);
+       vec4 pos = vec4(c * aPos.x - s * aPos.y, s * aPos.x + c * aPos.y, z, 1.0);
+       vec3 norm = vec3(c * aNormal.x - s * aNormal.y, s * aNormal.x + c * aNormal.y,
+                        aNormal.z - twist * (aPos.x * aNormal.y - aPos.y * aNormal.x));
+       gl_Position = perspective * matrix * pos;
+       Normal = vec3(rot * vec4(norm, 0.0));
+       FragPos = vec3(matrix * pos);
+       Local = vec3(aPos.xy, z);
+       LocalNormal = aNormal.xy;
     }
 )glsl";
 
-static const char *fragmentShaderSourceNew = R"glsl(
+// what a transform feedback capture of vertexShaderSourceNew keeps, interleaved, 11 floats a vertex
+static const char *const feedbackVaryings[4] = {"FragPos", "Normal", "Local", "LocalNormal"};
+
+static const char *const fragmentShaderSourceNew = R"glsl(
     #version 330
     in vec3 Normal;
     in vec3 FragPos;
+    in vec3 Local;
+    in vec2 LocalNormal;
     out vec4 outColor;
+    layout(location = 1) out uvec2 pickOut; // part and triangle, only the picking pass draws to it
     uniform vec3 triangleColor;
     uniform vec3 lightPos;
+    uniform mat4 rot;
+    uniform float twist;
+    uniform uint pickPart; // 2 gear + part + 1, 0 the background
+    uniform bool analytic; // the cut surface, normals of the flanks from the profile
+    uniform vec3 flank; // base circle radius, radius the flank starts at, approximating circle's radius or 0
+    uniform bool outline; // flat triangleColor, the wireframe pass
+    uniform bool contact; // the cut surface coloured by how often it's touched the other gear
+    uniform sampler2D heat; // contact counts on the flank map, gear a's lower half, b's upper
+    uniform sampler2D heatMax; // each half's largest count, a then b
+    uniform int contactGear;
+    uniform vec4 contactShape; // minor radius, major radius, tooth 0's angle, N
+    uniform float contactFace; // half the face width
+
+    // The involute's normal is tangent to the base circle, the approximating circle's
+    // passes through its centre on the base circle, so either follows from the radius
+    // alone. The interpolated vertex normal only picks the flank
+    vec3 flankNormal()
+    {
+        float r = length(Local.xy);
+        if(!analytic || r < flank.y) return Normal;
+        vec2 u = Local.xy / r;
+        float c = flank.z > 0.0 ? (r * r + flank.x * flank.x - flank.z * flank.z) / (2.0 * r * flank.x) : flank.x / r;
+        c = clamp(c, -1.0, 0.999999); // tangent to the base circle on it
+        float a = (r - flank.x * c) * (dot(LocalNormal, u) < 0.0 ? -1.0 : 1.0);
+        float b = flank.x * sqrt(1.0 - c * c) * (LocalNormal.y * u.x - LocalNormal.x * u.y < 0.0 ? -1.0 : 1.0);
+        vec2 n = a * u + b * vec2(-u.y, u.x);
+        float cz = cos(twist * Local.z), sz = sin(twist * Local.z);
+        vec3 norm = vec3(cz * n.x - sz * n.y, sz * n.x + cz * n.y, -twist * (Local.x * n.y - Local.y * n.x));
+        return vec3(rot * vec4(norm, 0.0));
+    }
+
+    // where Local falls on the flank map, across the tooth root to tip then tip to root, along the face
+    // up the half for contactGear, as contactGeometryShaderSource lays out the cut surface's triangles
+    vec2 flankMap()
+    {
+        float pitch = 6.2831853 / contactShape.w;
+        float phi = atan(Local.y, Local.x) - contactShape.z;
+        phi -= pitch * floor(phi / pitch + 0.5);
+        float u = clamp((length(Local.xy) - contactShape.x) / (contactShape.y - contactShape.x), 0.0, 1.0);
+        float v = clamp(0.5 + 0.5 * Local.z / contactFace, 0.0, 1.0);
+        return vec2(phi < 0.0 ? 0.5 * u : 1.0 - 0.5 * u, 0.5 * (float(contactGear) + v));
+    }
+
+    // blue through green and yellow to red
+    vec3 heatColour(float t)
+    {
+        return clamp(vec3(1.5 - abs(4.0 * t - 3.0), 1.5 - abs(4.0 * t - 2.0), 1.5 - abs(4.0 * t - 1.0)), 0.0, 1.0);
+    }
+
     void main()
     {
+        pickOut = uvec2(pickPart, uint(gl_PrimitiveID));
+        if(outline){
+            outColor = vec4(triangleColor, 1.0);
+            return;
+        }
         vec3 lightColor = vec3(0.9, 0.9, 0.9);
         float ambientStrength = 0.2;
         vec3 ambient = ambientStrength * lightColor;
         vec3 lightDir = normalize(lightPos - FragPos);
-        vec3 norm = normalize(Normal);
+        vec3 norm = normalize(flankNormal());
         float diff = max(dot(norm, lightDir), 0.0);
         vec3 diffuse = diff * lightColor;
-        vec3 result = (ambient + diffuse) * triangleColor;
+        vec3 colour = triangleColor;
+        if(contact){
+            float count = texture(heat, flankMap()).r;
+            if(count > 0.0) colour = heatColour(count / texelFetch(heatMax, ivec2(contactGear, 0), 0).r);
+        }
+        vec3 result = (ambient + diffuse) * colour;
         outColor = vec4(result, 1.0);
     }
 )glsl";
 
-static const char *vertexShaderSource = R"glsl(
+static const char *const vertexShaderSource = R"glsl(
     #version 130
     in vec3 aPos;
     in vec3 aNormal;
     out vec3 Normal, FragPos;
+    out vec3 Local; // on the spur mesh, z along the face, for the analytic flank normals
+    out vec2 LocalNormal;
     uniform mat4 matrix;
     uniform mat4 perspective;
     uniform mat4 rot;
+    uniform float twist; // helix, radians per unit z, 0 for a spur gear
+    uniform vec3 slice; // centre z of the first slice, z between slices, scale of the mesh's z
+    uniform int sliceBase;
 
+    // a helical gear draws the spur mesh once per slice,
+    // squashed into the slice and turned by the twist at each z
     void main()
     {
-       gl_Position = perspective * matrix * vec4(aPos, 1.0);
-       Normal = vec3(rot * vec4(aNormal, 0.0));
-       FragPos = vec3(matrix * vec4(aPos, 1.0));
+       float z = slice.x + slice.y * float(sliceBase) + slice.z * aPos.z;
+       float c = cos(twist * z), s = sin(twist * z);
+       vec4 pos = vec4(c * aPos.x - s * aPos.y, s * aPos.x + c * aPos.y, z, 1.0);
+       vec3 norm = vec3(c * aNormal.x - s * aNormal.y, s * aNormal.x + c * aNormal.y,
+                        aNormal.z - twist * (aPos.x * aNormal.y - aPos.y * aNormal.x));
+       gl_Position = perspective * matrix * pos;
+       Normal = vec3(rot * vec4(norm, 0.0));
+       FragPos = vec3(matrix * pos);
+       Local = vec3(aPos.xy, z);
+       LocalNormal = aNormal.xy;
     }
 )glsl";
 
-static const char *fragmentShaderSource = R"glsl(
+static const char *const fragmentShaderSource = R"glsl(
     #version 130
     in vec3 Normal;
     in vec3 FragPos;
+    in vec3 Local;
+    in vec2 LocalNormal;
     out vec4 outColor;
     uniform vec3 triangleColor;
     uniform vec3 lightPos;
+    uniform mat4 rot;
+    uniform float twist;
+    uniform bool analytic; // the cut surface, normals of the flanks from the profile
+    uniform vec3 flank; // base circle radius, radius the flank starts at, approximating circle's radius or 0
+    uniform bool outline; // flat triangleColor, the wireframe pass
+
+    // The involute's normal is tangent to the base circle, the approximating circle's
+    // passes through its centre on the base circle, so either follows from the radius
+    // alone. The interpolated vertex normal only picks the flank
+    vec3 flankNormal()
+    {
+        float r = length(Local.xy);
+        if(!analytic || r < flank.y) return Normal;
+        vec2 u = Local.xy / r;
+        float c = flank.z > 0.0 ? (r * r + flank.x * flank.x - flank.z * flank.z) / (2.0 * r * flank.x) : flank.x / r;
+        c = clamp(c, -1.0, 0.999999); // tangent to the base circle on it
+        float a = (r - flank.x * c) * (dot(LocalNormal, u) < 0.0 ? -1.0 : 1.0);
+        float b = flank.x * sqrt(1.0 - c * c) * (LocalNormal.y * u.x - LocalNormal.x * u.y < 0.0 ? -1.0 : 1.0);
+        vec2 n = a * u + b * vec2(-u.y, u.x);
+        float cz = cos(twist * Local.z), sz = sin(twist * Local.z);
+        vec3 norm = vec3(cz * n.x - sz * n.y, sz * n.x + cz * n.y, -twist * (Local.x * n.y - Local.y * n.x));
+        return vec3(rot * vec4(norm, 0.0));
+    }
+
     void main()
     {
+        if(outline){
+            outColor = vec4(triangleColor, 1.0);
+            return;
+        }
         vec3 lightColor = vec3(0.9, 0.9, 0.9);
         float ambientStrength = 0.2;
         vec3 ambient = ambientStrength * lightColor;
         vec3 lightDir = normalize(lightPos - FragPos);
-        vec3 norm = normalize(Normal);
+        vec3 norm = normalize(flankNormal());
         float diff = max(dot(norm, lightDir), 0.0);
         vec3 diffuse = diff * lightColor;
         vec3 result = (ambient + diffuse) * triangleColor;
         outColor = vec4(result, 1.0);
     }
 )glsl";
+
+// Raymarched mode, one triangle covers the screen and each pixel marches
+// through the two gears' distance fields (gearsdf.h), no vertex data at all
+static const char *const sdfVertexShaderSourceNew = R"glsl(
+    #version 330
+    out vec2 ndc;
+    void main()
+    {
+       ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+       gl_Position = vec4(ndc, 0.0, 1.0);
+    }
+)glsl";
+
+static const char *const sdfVertexShaderSource = R"glsl(
+    #version 130
+    out vec2 ndc;
+    void main()
+    {
+       ndc = vec2(float((gl_VertexID & 1) << 2) - 1.0, float((gl_VertexID & 2) << 1) - 1.0);
+       gl_Position = vec4(ndc, 0.0, 1.0);
+    }
+)glsl";
+
+static const char *const sdfFragmentHeaderNew = "#version 330\n";
+static const char *const sdfFragmentHeader = "#version 130\n";
+
+// the gears' signed distance fields, follows the version header
+static const char *const sdfGearFunctions = R"glsl(
+    uniform vec4 teeth[2]; // N, base circle radius, minor radius, major radius
+    uniform vec4 flank[2]; // half tooth angle at the base circle, tooth 0's angle, approximating circle's radius or 0, its centre's angle
+    uniform vec3 face[2]; // half the face width, twist, the Lipschitz bound the twist leaves
+    uniform float filletR;
+
+    float involute(float r, float rbc)
+    {
+        float a = acos(min(rbc / r, 1.0));
+        return tan(a) - a;
+    }
+
+    float roundUnion(float a, float b, float r)
+    {
+        return max(r, min(a, b)) - length(max(vec2(r - a, r - b), 0.0));
+    }
+
+    // gear g, folded onto the first half of tooth 0, see gearSdfDistance()
+    float gear2D(int g, vec2 p)
+    {
+        float r = length(p), pitch = 6.2831853 / teeth[g].x, rbc = teeth[g].y;
+        float phi = atan(p.y, p.x) - flank[g].y;
+        phi = abs(phi - pitch * floor(phi / pitch + 0.5));
+        float side;
+        if(r < rbc) side = r * sin(phi - flank[g].x);
+        else if(flank[g].z > 0.0) side = length(r * vec2(cos(phi), sin(phi)) - rbc * vec2(cos(flank[g].w), sin(flank[g].w))) - flank[g].z;
+        else side = rbc * (phi + involute(r, rbc) - flank[g].x);
+        return roundUnion(max(side, r - teeth[g].w), r - teeth[g].z, filletR);
+    }
+
+    float gear3D(int g, vec3 p)
+    {
+        float c = cos(face[g].y * p.z), s = sin(face[g].y * p.z);
+        vec2 q = vec2(c * p.x + s * p.y, -s * p.x + c * p.y);
+        vec2 w = vec2(length(q) - teeth[g].w, abs(p.z) - face[g].x);
+        if(w.x > 0.5) return length(max(w, 0.0)); // the bounding cylinder will do
+        w.x = gear2D(g, q) * face[g].z;
+        return min(max(w.x, w.y), 0.0) + length(max(w, 0.0));
+    }
+)glsl";
+
+// follows the version header and sdfGearFunctions
+static const char *const sdfFragmentShaderBody = R"glsl(
+    in vec2 ndc;
+    out vec4 outColor;
+    uniform mat4 perspective, invPerspective;
+    uniform mat4 toGear[2]; // eye space to each gear's own
+    uniform vec3 colours[4]; // blank then cut surface, gear a then b
+    uniform vec3 lightPos;
+
+    float scene(vec3 e, out int hit)
+    {
+        float da = gear3D(0, (toGear[0] * vec4(e, 1.0)).xyz);
+        float db = gear3D(1, (toGear[1] * vec4(e, 1.0)).xyz);
+        hit = da < db ? 0 : 1;
+        return min(da, db);
+    }
+
+    void main()
+    {
+        vec4 far = invPerspective * vec4(ndc, 1.0, 1.0), near = invPerspective * vec4(ndc, -1.0, 1.0);
+        vec3 e0 = near.xyz / near.w, dir = normalize(far.xyz / far.w - e0);
+        float t = 0.0, tMax = length(far.xyz / far.w - e0);
+        int hit = 0;
+        bool found = false;
+        for(int i=0; i<160 && t < tMax; ++i){
+            float d = scene(e0 + t * dir, hit);
+            if(d < 0.0005 * t + 0.001){
+                found = true;
+                break;
+            }
+            t += d;
+        }
+        if(!found) discard;
+        vec3 p = e0 + t * dir;
+        int h;
+        vec2 k = vec2(1.0, -1.0) * 0.0005 * t + vec2(0.0005, -0.0005);
+        vec3 norm = normalize(k.xyy * scene(p + k.xyy, h) + k.yyx * scene(p + k.yyx, h)
+                            + k.yxy * scene(p + k.yxy, h) + k.xxx * scene(p + k.xxx, h));
+        // faces and the outside diameter are the blank, the rest was cut
+        vec3 q = (toGear[hit] * vec4(p, 1.0)).xyz;
+        bool blank = abs(q.z) > face[hit].x - 0.01 || length(q.xy) > teeth[hit].w - 0.01;
+        vec3 triangleColor = colours[2 * hit + (blank ? 0 : 1)];
+        vec4 clip = perspective * vec4(p, 1.0);
+        gl_FragDepth = 0.5 * clip.z / clip.w + 0.5;
+
+        vec3 lightColor = vec3(0.9, 0.9, 0.9);
+        float ambientStrength = 0.2;
+        vec3 ambient = ambientStrength * lightColor;
+        vec3 lightDir = normalize(lightPos - p);
+        float diff = max(dot(norm, lightDir), 0.0);
+        vec3 diffuse = diff * lightColor;
+        vec3 result = (ambient + diffuse) * triangleColor;
+        outColor = vec4(result, 1.0);
+    }
+)glsl";
+
+// The contact pattern, each gear's cut surface drawn onto its flank map, where any tooth's
+// flank lies within contactTol of the other gear's distance field counting one a frame
+static const char *const contactVertexShaderSource = R"glsl(
+    #version 330
+    layout (location = 0) in vec3 aPos;
+    out vec3 Local, Other;
+    uniform mat4 toOther; // this gear's frame to the other's
+    uniform float twist;
+    uniform vec3 slice;
+
+    // the slices as vertexShaderSourceNew, placed on the map by the geometry shader
+    void main()
+    {
+       float z = slice.x + slice.y * float(gl_InstanceID) + slice.z * aPos.z;
+       float c = cos(twist * z), s = sin(twist * z);
+       Local = vec3(aPos.xy, z);
+       Other = vec3(toOther * vec4(c * aPos.x - s * aPos.y, s * aPos.x + c * aPos.y, z, 1.0));
+       gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+    }
+)glsl";
+
+// as flankMap() in fragmentShaderSourceNew, but which flank is taken from the triangle's
+// centre, so no triangle is split across the map. The top land and root fall on lines,
+// and only the few teeth reaching into the other gear's tip circle are drawn at all
+static const char *const contactGeometryShaderSource = R"glsl(
+    #version 330
+    layout (triangles) in;
+    layout (triangle_strip, max_vertices = 3) out;
+    in vec3 Local[], Other[];
+    out vec3 OtherPos;
+    uniform vec4 contactShape; // minor radius, major radius, tooth 0's angle, N
+    uniform float contactFace;
+    uniform vec4 teeth[2]; // as sdfGearFunctions
+    uniform int other;
+
+    void main()
+    {
+        float reach = teeth[other].w + 0.1;
+        if(length(Other[0].xy) > reach && length(Other[1].xy) > reach && length(Other[2].xy) > reach) return;
+        float pitch = 6.2831853 / contactShape.w;
+        vec3 centre = (Local[0] + Local[1] + Local[2]) / 3.0;
+        float phi = atan(centre.y, centre.x) - contactShape.z;
+        bool lower = phi - pitch * floor(phi / pitch + 0.5) < 0.0;
+        for(int i=0; i<3; ++i){
+            float u = clamp((length(Local[i].xy) - contactShape.x) / (contactShape.y - contactShape.x), 0.0, 1.0);
+            float v = clamp(0.5 + 0.5 * Local[i].z / contactFace, 0.0, 1.0);
+            gl_Position = vec4((lower ? u : 2.0 - u) - 1.0, 2.0 * v - 1.0, 0.0, 1.0);
+            OtherPos = Other[i];
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+)glsl";
+
+// follows the version header and sdfGearFunctions, blended GL_ONE, GL_ONE
+static const char *const contactFragmentShaderBody = R"glsl(
+    in vec3 OtherPos;
+    out vec4 outColor;
+    uniform int other;
+    const float contactTol = 0.01; // modules, a little over the meshes' chord error
+
+    void main()
+    {
+        if(gear3D(other, OtherPos) > contactTol) discard;
+        outColor = vec4(1.0);
+    }
+)glsl";
+
+// one point a count, onto gear a's pixel or b's, blended GL_MAX
+static const char *const contactMaxVertexShaderSource = R"glsl(
+    #version 330
+    out float count;
+    uniform sampler2D heat;
+
+    void main()
+    {
+        ivec2 size = textureSize(heat, 0);
+        ivec2 texel = ivec2(gl_VertexID % size.x, gl_VertexID / size.x);
+        count = texelFetch(heat, texel, 0).r;
+        gl_Position = vec4(2 * texel.y < size.y ? -0.5 : 0.5, 0.0, 0.0, 1.0);
+    }
+)glsl";
+
+static const char *const contactMaxFragmentShaderSource = R"glsl(
+    #version 330
+    in float count;
+    out vec4 outColor;
+
+    void main()
+    {
+        outColor = vec4(count);
+    }
+)glsl";
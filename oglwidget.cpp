@@ -4,6 +4,10 @@
 
 #include "oglwidget.h"
 #include "gear.h"
+#include "trace.h"
+#include "meshlib.h"
+#include "phasebatch.h"
+#include "helical.h"
 
 #include <QTextStream>
 #include <QMatrix4x4>
@@ -11,22 +15,48 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <future>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 #include<QApplication>
+#include <QFile>
+#include <QDir>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QWindow>
+#include <QScreen>
+#include <QToolTip>
 
 #include "myshaders.h"
 
 OGLWidget::OGLWidget(QWidget *parent)
     : QOpenGLWidget(parent)
 {
-
+    frameTimer = std::make_unique<QTimer>(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer.get(), &QTimer::timeout, this, [this]{ if(dirty && exposed()) update(); });
 }
 
 OGLWidget::~OGLWidget()
 {
     glDeleteProgram(shaderProgram);
-    glDeleteVertexArrays(1, &vao);
-    glDeleteBuffers(1, &vbo);
-    glDeleteBuffers(1, &ebo);
+    glDeleteProgram(sdfProgram);
+    glDeleteVertexArrays(1, &sdfVao);
+    glDeleteVertexArrays(1, &feedbackVao);
+    glDeleteBuffers(1, &feedbackVbo);
+    glDeleteFramebuffers(1, &pickFbo);
+    glDeleteRenderbuffers(2, pickRbo);
+    glDeleteProgram(contactProgram);
+    glDeleteProgram(contactMaxProgram);
+    glDeleteFramebuffers(2, contactFbo);
+    glDeleteTextures(2, contactTex);
+    for(auto &m: mesh){
+        glDeleteVertexArrays(1, &m.vao);
+        glDeleteBuffers(1, &m.vbo);
+        glDeleteBuffers(1, &m.ebo);
+    }
 }
 
 void OGLWidget::initializeGL()
@@ -38,51 +68,57 @@ void OGLWidget::initializeGL()
     //OGL_ver = std::stof(std::string((const char*) glGetString(GL_VERSION)));
     OGL_ver = std::stof(std::string((const char*) glGetString(GL_SHADING_LANGUAGE_VERSION)));
     if(OGL_ver >= 3.3f) newVer = true;
-    // Vertex Shader
+    bInstanced = newVer;
+    // the meshes' shaders
     {
-        // Create and compile the vertex shader
-        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-        if(newVer) glShaderSource(vertexShader, 1, &vertexShaderSourceNew, NULL);
-        else glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-        glCompileShader(vertexShader);
-        int success;
-        char infoLog[1024];
-        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-        if(!success){
-            glGetShaderInfoLog(vertexShader, 1024, NULL, infoLog);
-            std::string str = "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" + std::string(infoLog);
-            throw std::runtime_error(str);
-        }
-
-        if(!newVer){
-            glBindAttribLocation(vertexShader, 0, "aPos");
-            glBindAttribLocation(vertexShader, 1, "aNormal");
-            //std::cout << "glGetError = " << glGetError() << std::endl;
-        }
-
-        // Create and compile the fragment shader
-        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-        if(newVer) glShaderSource(fragmentShader, 1, &fragmentShaderSourceNew, NULL);
-        else glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-        glCompileShader(fragmentShader);
-        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-        if(!success){
-            glGetShaderInfoLog(fragmentShader, 1024, NULL, infoLog);
-            std::string str = "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" + std::string(infoLog);
-            throw std::runtime_error(str);
-        }
+        const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, {newVer ? vertexShaderSourceNew : vertexShaderSource}, "VERTEX");
+        const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, {newVer ? fragmentShaderSourceNew : fragmentShaderSource}, "FRAGMENT");
         // Link the vertex and fragment shader into a shader program
         shaderProgram = glCreateProgram();
         glAttachShader(shaderProgram, vertexShader);
         glAttachShader(shaderProgram, fragmentShader);
+        if(!newVer){ // the 330 shaders give their own layout
+            glBindAttribLocation(shaderProgram, 0, "aPos");
+            glBindAttribLocation(shaderProgram, 1, "aNormal");
+        }
         glBindFragDataLocation(shaderProgram, 0, "outColor");
+        if(newVer) glTransformFeedbackVaryings(shaderProgram, 4, feedbackVaryings, GL_INTERLEAVED_ATTRIBS);
         glLinkProgram(shaderProgram);
 
         glDeleteShader(fragmentShader);
         glDeleteShader(vertexShader);
-        glUseProgram(shaderProgram);
     }
+    // the raymarched mode's shaders, both versions share the fragment shader's body
+    {
+        const GLuint vertexShader = compileShader(GL_VERTEX_SHADER, {newVer ? sdfVertexShaderSourceNew : sdfVertexShaderSource}, "SDF_VERTEX");
+        const GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, {newVer ? sdfFragmentHeaderNew : sdfFragmentHeader, sdfGearFunctions, sdfFragmentShaderBody},
+                                                    "SDF_FRAGMENT");
+        sdfProgram = glCreateProgram();
+        glAttachShader(sdfProgram, vertexShader);
+        glAttachShader(sdfProgram, fragmentShader);
+        glBindFragDataLocation(sdfProgram, 0, "outColor");
+        glLinkProgram(sdfProgram);
+
+        glDeleteShader(fragmentShader);
+        glDeleteShader(vertexShader);
+        glGenVertexArrays(1, &sdfVao);
+        sdfPerspective = glGetUniformLocation(sdfProgram, "perspective");
+        sdfInvPerspective = glGetUniformLocation(sdfProgram, "invPerspective");
+        sdfToGear = glGetUniformLocation(sdfProgram, "toGear");
+        sdfTeeth = glGetUniformLocation(sdfProgram, "teeth");
+        sdfFlank = glGetUniformLocation(sdfProgram, "flank");
+        sdfFace = glGetUniformLocation(sdfProgram, "face");
+        sdfFilletR = glGetUniformLocation(sdfProgram, "filletR");
+        sdfColours = glGetUniformLocation(sdfProgram, "colours");
+        sdfLightPos = glGetUniformLocation(sdfProgram, "lightPos");
+        // as the meshes, blank then cut surface, gear a then b
+        const GLfloat colours[12] = {0.1f, 0.2f, 0.5f, 0.184314f, 0.309804f, 0.184314f, 0.1f, 0.1f, 0.4f, 0.25f, 0.25f, 0.25f};
+        glUseProgram(sdfProgram);
+        glUniform3fv(sdfColours, 4, colours);
+    }
+    glUseProgram(shaderProgram);
     buildGears();
+    buildSdf();
     // enable depth testing
     glEnable(GL_DEPTH_TEST);
     uniMat = glGetUniformLocation(shaderProgram, "matrix");
@@ -90,6 +126,64 @@ void OGLWidget::initializeGL()
     uniPerspective = glGetUniformLocation(shaderProgram, "perspective");
     uniLightPos = glGetUniformLocation(shaderProgram, "lightPos");
     uniColor = glGetUniformLocation(shaderProgram, "triangleColor");
+    uniTwist = glGetUniformLocation(shaderProgram, "twist");
+    uniSlice = glGetUniformLocation(shaderProgram, "slice");
+    uniSliceBase = glGetUniformLocation(shaderProgram, "sliceBase");
+    glUniform1i(uniSliceBase, 0);
+    uniAnalytic = glGetUniformLocation(shaderProgram, "analytic");
+    uniFlank = glGetUniformLocation(shaderProgram, "flank");
+    glUniform1i(uniAnalytic, 0);
+    uniOutline = glGetUniformLocation(shaderProgram, "outline");
+    uniCached = glGetUniformLocation(shaderProgram, "cached");
+    glUniform1i(uniOutline, 0);
+    glUniform1i(uniCached, 0);
+    uniPickPart = glGetUniformLocation(shaderProgram, "pickPart");
+    uniContact = glGetUniformLocation(shaderProgram, "contact");
+    uniContactGear = glGetUniformLocation(shaderProgram, "contactGear");
+    uniContactShape = glGetUniformLocation(shaderProgram, "contactShape");
+    glUniform1i(uniContact, 0);
+    glUniform1i(glGetUniformLocation(shaderProgram, "heat"), 1); // texture units, bound by startContact()
+    glUniform1i(glGetUniformLocation(shaderProgram, "heatMax"), 2);
+    uniContactFace = glGetUniformLocation(shaderProgram, "contactFace");
+    glUniform1f(uniContactFace, delZhelix);
+    if(newVer){ // the contact pattern's passes, the first evaluates the other gear's distance field
+        const GLuint shaders[5] = {
+            compileShader(GL_VERTEX_SHADER, {contactVertexShaderSource}, "CONTACT_VERTEX"),
+            compileShader(GL_GEOMETRY_SHADER, {contactGeometryShaderSource}, "CONTACT_GEOMETRY"),
+            compileShader(GL_FRAGMENT_SHADER, {sdfFragmentHeaderNew, sdfGearFunctions, contactFragmentShaderBody}, "CONTACT_FRAGMENT"),
+            compileShader(GL_VERTEX_SHADER, {contactMaxVertexShaderSource}, "CONTACT_MAX_VERTEX"),
+            compileShader(GL_FRAGMENT_SHADER, {contactMaxFragmentShaderSource}, "CONTACT_MAX_FRAGMENT")};
+        contactProgram = glCreateProgram();
+        for(int i=0; i<3; ++i) glAttachShader(contactProgram, shaders[i]);
+        glBindFragDataLocation(contactProgram, 0, "outColor");
+        glLinkProgram(contactProgram);
+        contactMaxProgram = glCreateProgram();
+        for(int i=3; i<5; ++i) glAttachShader(contactMaxProgram, shaders[i]);
+        glBindFragDataLocation(contactMaxProgram, 0, "outColor");
+        glLinkProgram(contactMaxProgram);
+        for(GLuint shader: shaders) glDeleteShader(shader);
+        contactToOther = glGetUniformLocation(contactProgram, "toOther");
+        contactTwist = glGetUniformLocation(contactProgram, "twist");
+        contactSlice = glGetUniformLocation(contactProgram, "slice");
+        contactShape = glGetUniformLocation(contactProgram, "contactShape");
+        contactOther = glGetUniformLocation(contactProgram, "other");
+        contactTeeth = glGetUniformLocation(contactProgram, "teeth");
+        contactFlank = glGetUniformLocation(contactProgram, "flank");
+        contactFace = glGetUniformLocation(contactProgram, "face");
+        contactFilletR = glGetUniformLocation(contactProgram, "filletR");
+        contactHalfFace = glGetUniformLocation(contactProgram, "contactFace");
+        glUseProgram(contactProgram);
+        glUniform1f(contactHalfFace, delZhelix);
+        glUseProgram(contactMaxProgram);
+        glUniform1i(glGetUniformLocation(contactMaxProgram, "heat"), 1);
+        glUseProgram(shaderProgram);
+    }
+    // the captured outputs are drawn with the meshes' indices, the buffer is sized by paintGL()
+    glGenVertexArrays(1, &feedbackVao);
+    glBindVertexArray(feedbackVao);
+    glGenBuffers(1, &feedbackVbo);
+    for(GLuint a=2; a<6; ++a) glEnableVertexAttribArray(a);
+    glBindVertexArray(mesh[bExact ? 0 : 1].vao);
     OGLVersionInfo = "OpenGL core profile version string: ";
     OGLVersionInfo += reinterpret_cast<const char*>(glGetString(GL_VERSION));
     ShaderVersionInfo = "OpenGL shading language version: ";
@@ -101,135 +195,454 @@ void OGLWidget::initializeGL()
 
 void  OGLWidget::buildGears(bool redo)
 {
-    // initialise gear objects, which provide vertices and indices
-    std::unique_ptr<gear> myGa, myGb;
+    TRACE_SCOPE("OGLWidget::buildGears");
+    const unsigned int shown = bExact ? 0 : 1;
+    const gearDetail detail = bAnalytic ? gearDetail::coarse : gearDetail::fine;
+
+    if(!redo){
+        for(auto &m: mesh){
+            // Create Vertex Array Object
+            glGenVertexArrays(1, &m.vao);
+            glBindVertexArray(m.vao);
+
+            // Create a Vertex Buffer Object and an element buffer object, data is copied by uploadMesh()
+            glGenBuffers(1, &m.vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+            glGenBuffers(1, &m.ebo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo);
+
+            // Specify the layout of the vertex data
+            // position attribute
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
+            glEnableVertexAttribArray(0);
+            // normal attribute
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+            glEnableVertexAttribArray(1);
+        }
+    }
+    if(pending.valid()){ // a stale background build, can't be cancelled, its pair mustn't be uploaded
+        pending.wait();
+        pending = {};
+    }
+    for(auto &m: mesh) m.bReady = false;
+    mesh[shown].key = pairKey{Na, Nb, pa, bExact, detail};
+    mesh[1 - shown].key = pairKey{Na, Nb, pa, !bExact, detail};
+    selGear = -1; // the teeth may not be there any more
+    bClearContact = true;
+    // a prebuilt library, when there is one, saves building anything, it only holds fine meshes
+    if(bAnalytic || !uploadLibraryMesh(shown, bExact)) uploadMesh(shown, *cache.get(mesh[shown].key));
+    if(bAnalytic || !uploadLibraryMesh(1 - shown, !bExact)){
+        // the other profile is built off the GUI thread, and uploaded by paintGL() once ready
+        pendingMesh = 1 - shown;
+        const pairKey other = mesh[pendingMesh].key;
+        pending = std::async(std::launch::async, [this, other]{ return cache.get(other); });
+    }
+    glBindVertexArray(mesh[shown].vao);
+    if(redo) setSeperation(delSeperation);
+}
+
+// copy a gear pair into the buffers of mesh[i]
+void OGLWidget::uploadMesh(unsigned int i, const gearPair &pair)
+{
+    TRACE_SCOPE("OGLWidget::uploadMesh");
+    meshBuffers &m = mesh[i];
+
+    glBindVertexArray(m.vao); // element buffer binding is part of the vao state
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+    m.Nind_a = pair.Nind_a;
+    m.Nind1_a = pair.Nind1_a;
+    m.Nind_b = pair.Nind_b;
+    m.Nind1_b = pair.Nind1_b;
+    m.Nverts_a = pair.Nverts_a;
+    m.Nverts = (GLuint) (pair.verts.size() / 6);
+    std::copy(pair.flank_a, pair.flank_a + 3, m.flank_a);
+    std::copy(pair.flank_b, pair.flank_b + 3, m.flank_b);
+    m.halfFace = pair.verts[6 * (std::size_t) (pair.Nverts_a - 2) + 2]; // the centres are each gear's last two vertices
+    m.gpuBytes = pair.gpuBytes();
+    peakBytes = pair.peakBytes;
+    m.bReady = true;
+    m.bvh = std::array<meshBvh, 2>();
+}
+
+// copy both gears of the pair for mesh[i] straight from the memory mapped
+// library files, false if either gear isn't there or was built by another generator
+bool OGLWidget::uploadLibraryMesh(unsigned int i, bool bEx)
+{
+    TRACE_SCOPE("OGLWidget::uploadLibraryMesh");
+    QString dir = QString::fromLocal8Bit(qgetenv("GEAR_LIBRARY"));
+    if(dir.isEmpty()) dir = QApplication::applicationDirPath() + "/gearlib";
+    if(!QDir(dir).exists()) return false;
+    QFile fa(QString::fromStdString(meshLibFileName(dir.toStdString(), Na, pa, bEx)));
+    QFile fb(QString::fromStdString(meshLibFileName(dir.toStdString(), Nb, pa, bEx)));
+    if(!fa.open(QIODevice::ReadOnly) || !fb.open(QIODevice::ReadOnly)) return false;
+    const uchar *dataA = fa.map(0, fa.size()), *dataB = fb.map(0, fb.size());
+    if(!dataA || !dataB) return false;
+    const meshLibHeader *ha = meshLibCheck(dataA, fa.size(), Na, pa, bEx);
+    const meshLibHeader *hb = meshLibCheck(dataB, fb.size(), Nb, pa, bEx);
+    if(!ha || !hb) return false;
+
+    meshBuffers &m = mesh[i];
+    const GLsizeiptr vBytesA = 6 * sizeof(GLfloat) * ha -> nVertices, vBytesB = 6 * sizeof(GLfloat) * hb -> nVertices;
+    const GLsizeiptr iBytesA = sizeof(GLuint) * ha -> nIndices, iBytesB = sizeof(GLuint) * hb -> nIndices;
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vBytesA + vBytesB, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vBytesA, dataA + ha -> vertOffset[0]);
+    glBufferSubData(GL_ARRAY_BUFFER, vBytesA, vBytesB, dataB + hb -> vertOffset[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, iBytesA + iBytesB, nullptr, GL_STATIC_DRAW);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, iBytesA, dataA + ha -> indOffset);
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, iBytesA, iBytesB, dataB + hb -> indOffset);
+    m.Nind_a = ha -> nIndices;
+    m.Nind1_a = ha -> n1indices;
+    m.Nind_b = hb -> nIndices;
+    m.Nind1_b = hb -> n1indices;
+    m.Nverts_a = ha -> nVertices;
+    m.Nverts = ha -> nVertices + hb -> nVertices;
+    m.halfFace = ((const GLfloat*) (dataA + ha -> vertOffset[0]))[6 * (std::size_t) (ha -> nVertices - 2) + 2];
+    m.gpuBytes = vBytesA + vBytesB + iBytesA + iBytesB;
+    peakBytes = 0; // mapped, nothing built
+    m.bReady = true;
+    m.bvh = std::array<meshBvh, 2>();
+    return true;
+}
 
-    if(bExact){
-        myGa = std::make_unique<gear>(Na, pa, 5.0f); // gear slightly thicker so it shows above any overlap
-        myGb = std::make_unique<gear>(Nb, pa, 5.0001f);
+// both gears' bvhs for mesh m, made at its first pick as most meshes are never picked. The
+// buffers are read back from the GPU for it, so neither upload keeps a CPU copy, library
+// meshes included. Gear b's indices count from its first vertex. The context must be current
+void OGLWidget::buildPick(meshBuffers &m)
+{
+    TRACE_SCOPE("OGLWidget::buildPick");
+    std::vector<GLfloat> verts(6 * (std::size_t) m.Nverts);
+    std::vector<GLuint> inds((std::size_t) m.Nind_a + m.Nind_b);
+    glBindVertexArray(m.vao); // element buffer binding is part of the vao state
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    glGetBufferSubData(GL_ARRAY_BUFFER, 0, verts.size() * sizeof(GLfloat), verts.data());
+    glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, inds.size() * sizeof(GLuint), inds.data());
+    m.bvh[0] = meshBvh(verts.data(), inds.data(), m.Nind_a / 3);
+    m.bvh[1] = meshBvh(verts.data() + 6 * (std::size_t) m.Nverts_a, inds.data() + m.Nind_a, m.Nind_b / 3);
+}
+
+std::size_t OGLWidget::getPickBytes() const
+{
+    std::size_t bytes = 0;
+    for(const auto &m: mesh) for(const auto &b: m.bvh) bytes += b.bytes();
+    return bytes;
+}
+
+// compiled, or throws with the log, the caller deletes it once linked
+GLuint OGLWidget::compileShader(GLenum type, std::vector<const char*> source, const std::string &what)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, (GLsizei) source.size(), source.data(), NULL);
+    glCompileShader(shader);
+    int success;
+    char infoLog[1024];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if(!success){
+        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+        throw std::runtime_error("ERROR::SHADER::" + what + "::COMPILATION_FAILED\n" + std::string(infoLog));
     }
-    else{
-        myGa = std::make_unique<gearApprox>(Na, pa, 5.0f); // gear slightly thicker so it shows above any overlap
-        myGb = std::make_unique<gearApprox>(Nb, pa, 5.0001f);
-    }
-
-    Nind_a = myGa -> GetNInds();
-    Nind1_a = myGa -> GetN1Inds();
-    Nind_b = myGb -> GetNInds();
-    Nind1_b = myGb -> GetN1Inds();
-    myGa -> RotateVerts(-90.0f);
-    myGb -> RotateVerts(90.0f);
-
-    // vertex data
-    std::vector<GLfloat> vertices, vbuff;
-    vertices = myGa -> GetVerts();
-    vbuff = myGb -> GetVerts();
-    vertices.insert(vertices.end(), vbuff.begin(), vbuff.end());
-    // index data
-    std::vector<GLuint> indices, ibuff;
-    indices = myGa -> GetInds();
-    ibuff = myGb -> GetInds();
-    GLuint nverts = myGa -> GetNverts();
-    for(auto &a: ibuff) a += nverts;
-    indices.insert(indices.end(), ibuff.begin(), ibuff.end());
-
-
-    if(redo){
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-        setSeperation(delSeperation);
+    return shader;
+}
+
+// point the vertex attributes at the vertex numbered base, the vao and vbo must be bound
+void OGLWidget::setVertexBase(GLuint base)
+{
+    const GLsizeiptr offset = base * 6 * sizeof(GLfloat);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+}
+
+// the meshes are always spur gears, a helix only changes how they're drawn
+void OGLWidget::setHelix(float x)
+{
+    helix = x;
+    slices = helixSlices(delZhelix, helix);
+    bClearContact = true; // the contact lines cross the face
+    requestFrame(dirtyScene);
+}
+
+// the meshes on screen are half a face width halfFace thick, which the slices, the
+// twist and the contact pattern's map along the face are scaled to
+void OGLWidget::setFace(GLfloat halfFace)
+{
+    delZhelix = halfFace;
+    slices = helixSlices(delZhelix, helix);
+    glUniform1f(uniContactFace, delZhelix);
+    if(contactProgram){
+        glUseProgram(contactProgram);
+        glUniform1f(contactHalfFace, delZhelix);
+        glUseProgram(shaderProgram);
     }
+    bClearContact = true;
+}
+
+// the spur mesh, faces at +-delZhelix, squashed into each of the slices and twisted
+void OGLWidget::setSlices(float twist)
+{
+    const float K = (float) slices;
+    glUniform1f(uniTwist, twist);
+    glUniform3f(uniSlice, delZhelix * (1.0f - 1.0f / K), -2.0f * delZhelix / K, 1.0f / K);
+}
+
+// count indices from first, once per slice
+void OGLWidget::drawSlices(GLsizei count, GLuint first)
+{
+    const GLvoid *offset = (GLvoid*)(first * sizeof(GLuint));
+    if(slices == 1) glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset);
+    else if(bInstanced) context() -> extraFunctions() -> glDrawElementsInstanced(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset, slices);
     else{
-        // Create Vertex Array Object
-        glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
-
-        // Create a Vertex Buffer Object and copy the vertex data to it
-        glGenBuffers(1, &vbo);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(), GL_STATIC_DRAW);
-
-        // Create an element buffer object and copy index data to it
-        glGenBuffers(1, &ebo); // and an element buffer object
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo); // element buffer object
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
-
-        // Specify the layout of the vertex data
-        // position attribute
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)0);
-        glEnableVertexAttribArray(0);
-        // normal attribute
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-        glEnableVertexAttribArray(1);
-    }
-}
-
-// find coords to bring involute curve to distance r from centre
-// theta inputs initial guess for its value, x and y input are garbage
-//float OGLWidget::NewtonRaphson(const unsigned int n, const unsigned int N, const float del)
-float OGLWidget::NewtonRaphson(const unsigned int n, const float rp, const float fac)
-{
-    float cost, sint;
-    float x, y;
-    float dx, dy, dr;
-    float rx;
-    float del_theta;
-    float theta = 0.05f;
-    //const float rp = 0.5 * (float) N;
-    //const float r = rp + del;
-    const float r = rp * fac;
-    const float sinpa = sin(pa), cospa = cos(pa);
-    const float rbc = rp * cospa;
-
-    for(unsigned int i=0; i<n; ++i){
-        cost = cos(pa + theta);
-        sint = sin(pa + theta);
-        x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
-        y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-        rx = sqrtf(x * x + y * y);
-        dx = -rbc * cost + rp * cospa * cost - rp * (sinpa + theta * cospa) * sint;
-        dy = -rbc * sint + rp * cospa * sint + rp * (sinpa + theta * cospa) * cost;
-        dr = x * dx + y * dy;
-        dr /= rx;
-        del_theta = (r - rx) / dr;
-        theta += del_theta;
-        //std::cout << "theta = " << theta << ", rx = " << rx << ", r = " << r << std::endl;
-    }
-    cost = cos(pa + theta);
-    sint = sin(pa + theta);
-    x = -rbc * sint + rp * (sinpa + theta * cospa) * cost;
-    y = rbc * cost + rp * (sinpa + theta * cospa) * sint;
-    return atan(x/y) * 180.0f / 3.141592654; // convert from
+        for(GLuint k=0; k<slices; ++k){
+            glUniform1i(uniSliceBase, k);
+            glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset);
+        }
+        glUniform1i(uniSliceBase, 0);
+    }
 }
 
+// the pair as distance fields, turned as buildPairGear() turns the meshes
+void OGLWidget::buildSdf()
+{
+    TRACE_SCOPE("OGLWidget::buildSdf");
+    for(unsigned int role=0; role<2; ++role){
+        const unsigned int N = role ? Nb : Na;
+        const float dZ = role ? delZhelix + 0.0001f : delZhelix; // as pairProfile(), b a hair thicker
+        std::unique_ptr<gear> g;
+        if(bExact) g = std::make_unique<gear>(N, pa, dZ, gearBuild::sectors);
+        else g = std::make_unique<gearApprox>(N, pa, dZ, gearBuild::sectors);
+        sdf[role] = gearSdfShape(*g, role ? 90.0f : -90.0f);
+    }
+    sdfKey = pairKey{Na, Nb, pa, bExact, gearDetail::fine};
+}
+
+pairKey OGLWidget::getShownPair() const
+{
+    return bSdf ? sdfKey : mesh[bExact ? 0 : 1].key;
+}
+
+// one triangle covering the viewport, the shader finds the gears along each pixel's ray
+void OGLWidget::paintSdf(const QMatrix4x4 &matrixA, const QMatrix4x4 &matrixB)
+{
+    GLfloat teeth[2][4], flank[2][4], face[2][3], toGear[32];
+    const QMatrix4x4 invA = matrixA.inverted(), invB = matrixB.inverted();
+
+    sdf[0].twist = 2.0f * std::tan(helix) / (float) Na; // as the meshes, tan(helix) / rp
+    sdf[1].twist = -2.0f * std::tan(helix) / (float) Nb;
+    for(int g=0; g<2; ++g) gearSdfUniforms(sdf[g], teeth[g], flank[g], face[g]);
+    std::copy(invA.constData(), invA.constData() + 16, toGear);
+    std::copy(invB.constData(), invB.constData() + 16, toGear + 16);
+    glUseProgram(sdfProgram);
+    glBindVertexArray(sdfVao);
+    glUniform3f(sdfLightPos, lightX, lightY, lightZ);
+    glUniformMatrix4fv(sdfToGear, 2, GL_FALSE, toGear);
+    glUniform4fv(sdfTeeth, 2, &teeth[0][0]);
+    glUniform4fv(sdfFlank, 2, &flank[0][0]);
+    glUniform3fv(sdfFace, 2, &face[0][0]);
+    glUniform1f(sdfFilletR, sdf[0].filletR);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glUseProgram(shaderProgram);
+}
+
+// Changes only ask for a frame, which is painted at the start of the next
+// refresh period after the last paint, so a burst of mouse events or a
+// light and a camera change together cost one paint. Nothing is painted while
+// the window is minimised, or covered where the platform reports that
+void OGLWidget::requestFrame(unsigned int why)
+{
+    ++counts.requested;
+    dirty |= why;
+    if(!exposed()){ // showEvent() paints what's pending once it's back
+        ++counts.hidden;
+        return;
+    }
+    if(frameTimer->isActive()){
+        ++counts.merged;
+        return;
+    }
+    const QWindow *w = window()->windowHandle();
+    const qreal hz = w && w->screen() && w->screen()->refreshRate() > 1.0 ? w->screen()->refreshRate() : 60.0;
+    const qint64 period = (qint64) (1000.0 / hz), since = lastPaint.isValid() ? lastPaint.elapsed() : period;
+    frameTimer->start((int) std::max<qint64>(0, period - since));
+}
+
+// on screen, and not minimised or wholly covered
+bool OGLWidget::exposed() const
+{
+    const QWindow *w = window()->windowHandle();
+    if(!isVisible() || visibleRegion().isEmpty()) return false;
+    return !w || (w->isExposed() && w->windowState() != Qt::WindowMinimized);
+}
+
+void OGLWidget::showEvent(QShowEvent *event)
+{
+    QOpenGLWidget::showEvent(event);
+    if(dirty) requestFrame(0);
+}
 
 void OGLWidget::setSeperation(const float del)
 {
+    TRACE_SCOPE("OGLWidget::setSeperation");
+    if(del != delSeperation) bClearContact = true; // the flanks touch elsewhere at another centre distance
     delSeperation = del;
-    float rpA, rpB, fac;
-
-    rpA = (float) Na * 0.5;
-    rpB = (float) Nb * 0.5;
-    fac = (rpA + rpB + del) / (rpA + rpB);
-    delTheta_a = NewtonRaphson(7, rpA, fac) + NewtonRaphson(7, rpB, fac) * (float) Nb / (float) Na;
+    delTheta_a = separationPhase(Na, Nb, pa, del);
 }
 
 void OGLWidget::mousePressEvent(QMouseEvent *event)
 {
-    lastPos = event->pos();
+    mousePress(event->pos(), event->buttons(), QApplication::keyboardModifiers());
+}
+
+void OGLWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    mouseMove(event->pos(), event->buttons(), QApplication::keyboardModifiers());
+}
+
+void OGLWidget::mousePress(QPoint pos, Qt::MouseButtons buttons, Qt::KeyboardModifiers modifiers)
+{
+    if(inputLog) inputLog -> add('p', pos.x(), pos.y(), (int) buttons, (int) modifiers);
+    lastPos = pos;
+    if((buttons & Qt::LeftButton) && Qt::ControlModifier == modifiers) pickTooth(pos);
 }
 
+// Ctrl+click highlights the tooth under the cursor and says which it is. The meshes'
+// bvhs answer in microseconds, but a helical pair is twisted by the vertex shader where
+// they can't follow, so then the pair is drawn into one pixel of part and triangle numbers.
+// That ID buffer needs the 330 shaders, without them a twisted pair can't be picked.
+// Raymarched, the meshes aren't rebuilt with the fields and may not be the gears on screen
+void OGLWidget::pickTooth(QPoint pos)
+{
+    TRACE_SCOPE("OGLWidget::pickTooth");
+    meshBuffers &m = mesh[bExact ? 0 : 1];
+    if(bSdf){
+        QToolTip::showText(mapToGlobal(pos), "no picking while raymarched", this);
+        return;
+    }
+    if(helix != 0.0f && !bInstanced){
+        QToolTip::showText(mapToGlobal(pos), "no picking on helical gears without GL 3.3", this);
+        return;
+    }
+    if(!m.bReady) return;
+    const bool bIds = helix != 0.0f;
+    unsigned int g = 0, tooth = 0;
+    float radius = 0.0f;
+    bool bHit;
+    double buildMs = 0.0;
+    makeCurrent();
+    if(!bIds && m.bvh[0].empty()){ // the first pick since the upload
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        const auto b0 = std::chrono::steady_clock::now();
+        buildPick(m);
+        buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - b0).count();
+        QApplication::restoreOverrideCursor();
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    if(bIds) bHit = pickIds(pos, g, tooth);
+    else bHit = pickBvh(pos, g, tooth, radius);
+    const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+    doneCurrent();
+    selGear = bHit ? (int) g : -1;
+    selTooth = tooth;
+    requestFrame(dirtyScene);
+    if(!bHit){
+        QToolTip::hideText();
+        return;
+    }
+    QString text = QString("gear %1, tooth %2 of %3").arg(g ? 'b' : 'a').arg(tooth).arg(g ? m.key.Nb : m.key.Na);
+    if(!bIds) text += QString(", radius %1").arg(radius, 0, 'f', 2);
+    text += QString("\n%1 in %2 ms").arg(bIds ? "ID buffer" : "ray cast").arg(dt.count(), 0, 'f', 3);
+    if(buildMs > 0.0) text += QString(", bvhs built in %1 ms").arg(buildMs, 0, 'f', 0);
+    QToolTip::showText(mapToGlobal(pos), text, this);
+}
+
+// the ray through the pixel's centre, taken into each gear's frame and cast against its
+// bvh, the nearer hit wins
+bool OGLWidget::pickBvh(QPoint pos, unsigned int &g, unsigned int &tooth, float &radius)
+{
+    const meshBuffers &m = mesh[bExact ? 0 : 1];
+    QMatrix4x4 proj;
+    proj.perspective(45.0f, perspective, 0.1f, 280.0f);
+    const float x = 2.0f * ((float) pos.x() + 0.5f) / (float) width() - 1.0f;
+    const float y = 1.0f - 2.0f * ((float) pos.y() + 0.5f) / (float) height();
+    float tNear = 2.0f; // along the ray from the near plane, 1 at the far plane
+    for(unsigned int k=0; k<2; ++k){
+        const QMatrix4x4 toGear = (proj * pickMatrix[k]).inverted();
+        const QVector3D p0 = toGear.map(QVector3D(x, y, -1.0f)), d = toGear.map(QVector3D(x, y, 1.0f)) - p0;
+        const float origin[3] = {p0.x(), p0.y(), p0.z()}, dir[3] = {d.x(), d.y(), d.z()};
+        bvhHit hit;
+        if(!m.bvh[k].intersect(origin, dir, hit) || hit.t >= tNear) continue;
+        const QVector3D p = p0 + hit.t * d;
+        tNear = hit.t;
+        g = k;
+        tooth = toothOfTriangle(hit.triangle, k ? m.key.Nb : m.key.Na, k ? m.Nind_b : m.Nind_a, k ? m.Nind1_b : m.Nind1_a);
+        radius = std::sqrt(p.x() * p.x() + p.y() * p.y());
+    }
+    return tNear < 2.0f;
+}
+
+// draw the pair with the perspective narrowed to the pixel, which then fills a one pixel
+// framebuffer, the fragment shader writing 2 gear + part + 1 and gl_PrimitiveID. Those
+// restart each instance, so each slice of a helical gear numbers its triangles alike
+bool OGLWidget::pickIds(QPoint pos, unsigned int &g, unsigned int &tooth)
+{
+    meshBuffers &m = mesh[bExact ? 0 : 1];
+    if(!pickFbo){
+        glGenFramebuffers(1, &pickFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, pickFbo);
+        glGenRenderbuffers(2, pickRbo);
+        glBindRenderbuffer(GL_RENDERBUFFER, pickRbo[0]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RG32UI, 1, 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, pickRbo[0]);
+        glBindRenderbuffer(GL_RENDERBUFFER, pickRbo[1]);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, pickRbo[1]);
+        const GLenum buffers[2] = {GL_NONE, GL_COLOR_ATTACHMENT1}; // outColor is dropped, pickOut kept
+        glDrawBuffers(2, buffers);
+        glReadBuffer(GL_COLOR_ATTACHMENT1);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, pickFbo);
+    glViewport(0, 0, 1, 1);
+    const GLuint background[4] = {0, 0, 0, 0};
+    glClearBufferuiv(GL_COLOR, 1, background);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    QMatrix4x4 proj, narrow;
+    proj.perspective(45.0f, perspective, 0.1f, 280.0f);
+    narrow.scale((float) width(), (float) height(), 1.0f);
+    narrow.translate(1.0f - 2.0f * ((float) pos.x() + 0.5f) / (float) width(), 2.0f * ((float) pos.y() + 0.5f) / (float) height() - 1.0f, 0.0f);
+    glUniformMatrix4fv(uniPerspective, 1, GL_FALSE, (narrow * proj).constData());
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    const int sel = selGear;
+    selGear = -1; // no highlight, its triangles would be numbered from 0
+    for(unsigned int k=0; k<2; ++k){
+        setGear(k, pickMatrix[k], QMatrix4x4());
+        drawGear(k, m, false, false);
+    }
+    selGear = sel;
+    glUniform1ui(uniPickPart, 0);
+    GLuint id[2] = {0, 0};
+    glReadPixels(0, 0, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, id);
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glUniformMatrix4fv(uniPerspective, 1, GL_FALSE, proj.constData());
+    if(!id[0]) return false;
+    g = (id[0] - 1) / 2;
+    const GLuint n1 = g ? m.Nind1_b : m.Nind1_a, n = g ? m.Nind_b : m.Nind_a;
+    tooth = toothOfTriangle((id[0] - 1) % 2 ? n1 / 3 + id[1] : id[1], g ? m.key.Nb : m.key.Na, n, n1);
+    return true;
+}
 
 // y axis on screen is upside down, so map y to -y for mouse movements
-void OGLWidget::mouseMoveEvent(QMouseEvent *event)
+void OGLWidget::mouseMove(QPoint pos, Qt::MouseButtons buttons, Qt::KeyboardModifiers modifiers)
 {
-    int x1 = event->x();
-    int y1 = -event->y();
+    if(inputLog) inputLog -> add('m', pos.x(), pos.y(), (int) buttons, (int) modifiers);
+    int x1 = pos.x();
+    int y1 = -pos.y();
     int x0 = lastPos.x();
     int y0 = -lastPos.y();
 
     // Is shift button being held down
-    if(Qt::ShiftModifier == QApplication::keyboardModifiers()){ // translate in x,y plane
+    if(Qt::ShiftModifier == modifiers){ // translate in x,y plane
         const float xmin = 10.0 * delZ;
         const float xmax = -xmin;
         const float ymin = xmin * (float) yCentre / (float) xCentre;
@@ -238,7 +651,7 @@ void OGLWidget::mouseMoveEvent(QMouseEvent *event)
         if(delX > xmax) delX = xmax;
         if(delY < ymin) delY = ymin;
         if(delY > ymax) delY = ymax;
-        if(event->buttons() & Qt::LeftButton){
+        if(buttons & Qt::LeftButton){
             QVector3D rv((float) (x1-x0), (float) (y1-y0), 0.0f);
             rv *= 0.0025; // magnitude for rotation
             float xt, yt;
@@ -247,21 +660,21 @@ void OGLWidget::mouseMoveEvent(QMouseEvent *event)
             if(xt < xmax && xt > xmin) delX = xt;
             if(yt < ymax && yt > ymin) delY = yt;
         }
-        else if(event->buttons() & Qt::RightButton){ // zoom in/out
+        else if(buttons & Qt::RightButton){ // zoom in/out
             float zt;
             zt = delZ - 0.001 * delZ * (float) (y1 - y0);
             if(zt < -5.0f && zt > -180.f) delZ = zt;
         }
     }
     // Global orientation is stored in the Quaternion OGLWidget::QuatOrient
-    else if(event->buttons() & Qt::LeftButton){ // roll, i.e. rotate around vector in x, y plane
+    else if(buttons & Qt::LeftButton){ // roll, i.e. rotate around vector in x, y plane
         QVector3D rv((float) (y0-y1), (float) (x1-x0), 0.0f); // orthogonal vector in plane
         float length = 0.0025 * rv.length(); // magnitude for rotation
         QQuaternion rot(cos(length), sin(length) * rv.normalized()); // rotation quaternion
         rot *= QuatOrient;
         QuatOrient = rot; // make a Left hand time ordered sequence, just like time dependent Quantum Mechanics
     }
-    else if(event->buttons() & Qt::RightButton){ // rotate around z
+    else if(buttons & Qt::RightButton){ // rotate around z
         // xCentre, yCentre
         QVector3D rv0((float)(x0 - xCentre), (float) (y0 + yCentre), 0.0f);
         QVector3D rv1((float)(x1 - xCentre), (float) (y1 + yCentre), 0.0f);
@@ -279,8 +692,20 @@ void OGLWidget::mouseMoveEvent(QMouseEvent *event)
             QuatOrient = rot;
         }
     }
-    lastPos = event->pos();
-    if(paused) update();
+    lastPos = pos;
+    if(paused) requestFrame(dirtyCamera);
+}
+
+// paint now rather than at the next refresh and wait for the GPU, for replays
+double OGLWidget::paintTimed()
+{
+    makeCurrent();
+    const auto t0 = std::chrono::steady_clock::now();
+    paintGL();
+    glFinish();
+    const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+    doneCurrent();
+    return dt.count();
 }
 
 void OGLWidget::incRotate()
@@ -291,17 +716,38 @@ void OGLWidget::incRotate()
 
 void OGLWidget::paintGL()
 {
+    TRACE_SCOPE("OGLWidget::paintGL");
+    dirty = 0;
+    ++counts.painted;
+    lastPaint.start();
     if(bSetPerspective){
         QMatrix4x4 matrix;
         matrix.perspective(45.0f, perspective, 0.1f, 280.0f);
         glUniformMatrix4fv(uniPerspective, 1, GL_FALSE, matrix.data());
+        glUseProgram(sdfProgram);
+        glUniformMatrix4fv(sdfPerspective, 1, GL_FALSE, matrix.data());
+        glUniformMatrix4fv(sdfInvPerspective, 1, GL_FALSE, matrix.inverted().data());
+        glUseProgram(shaderProgram);
         bSetPerspective = false;
     }
     glUniform3f(uniLightPos, lightX, lightY, lightZ); // position for light source
     if(rebuild_flg){
         rebuild_flg = false;
-        buildGears(true);
+        if(bSdf){ // no meshes to build, only the fields' few numbers
+            buildSdf();
+            setSeperation(delSeperation);
+        }
+        else buildGears(true);
+    }
+    meshBuffers &m = mesh[bExact ? 0 : 1];
+    if(pending.valid()){ // upload the background profile when done, or now if it's wanted on screen
+        if(!m.bReady || pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            uploadMesh(pendingMesh, *pending.get());
     }
+    if(m.bReady && m.halfFace != delZhelix) setFace(m.halfFace);
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    const GLuint Nind_a = m.Nind_a, Nind1_a = m.Nind1_a, Nind_b = m.Nind_b, Nind1_b = m.Nind1_b;
 
     const qreal retinaScale = devicePixelRatio();
     const float delXa = -((float) Nb + delSeperation) * 0.5f;
@@ -327,20 +773,230 @@ void OGLWidget::paintGL()
     matRotB = matRot;
     matRotB.rotate(theta_b, 0.0f, 0.0f, 1.0f);
 
-    // draw first gear
-    glUniformMatrix4fv(uniMat, 1, GL_FALSE, matrixA.data()); // transpose is set to true/false
-    glUniformMatrix4fv(uniRot, 1, GL_FALSE, matRotA.data());
-    glUniform3f(uniColor, 0.1f, 0.2f, 0.5f); // set color
-    glDrawElements(GL_TRIANGLES, Nind1_a, GL_UNSIGNED_INT, (void*)(0 * sizeof(GLuint)));
-    glUniform3f(uniColor, 0.184314, 0.309804, 0.184314); // dark green
-    glDrawElements(GL_TRIANGLES, Nind_a - Nind1_a, GL_UNSIGNED_INT, (void*)(Nind1_a * sizeof(GLuint)));
-
-    // draw second gear
-    glUniformMatrix4fv(uniMat, 1, GL_FALSE, matrixB.data()); // transpose is set to true/false
-    glUniformMatrix4fv(uniRot, 1, GL_FALSE, matRotB.data());
-    glUniform3f(uniColor, 0.1f, 0.1f, 0.4f); // set color
-    glDrawElements(GL_TRIANGLES, Nind1_b, GL_UNSIGNED_INT, (void*)(Nind_a * sizeof(GLuint)));
-    glUniform3f(uniColor, 0.25f, 0.25f, 0.25f); // grey
-    glDrawElements(GL_TRIANGLES, Nind_b - Nind1_b, GL_UNSIGNED_INT, (void*)((Nind_a + Nind1_b) * sizeof(GLuint)));
+    pickMatrix[0] = matrixA;
+    pickMatrix[1] = matrixB;
+    // the contact pattern gains a count wherever the flanks touch, once for each phase
+    if(bContact && bInstanced && !bSdf){
+        if(bClearContact) startContact();
+        if(theta_a != contactTheta) accumulateContact(m, matrixA, matrixB);
+    }
+    if(bSdf){
+        paintSdf(matrixA, matrixB);
+        return;
+    }
+    // with the outline there are two passes, cached the vertex shader runs once for both
+    const bool bCache = bOutline && bFeedback && bInstanced;
+    const QMatrix4x4 *matrices[2][2] = {{&matrixA, &matRotA}, {&matrixB, &matRotB}};
+    if(bCache){
+        const GLsizeiptr bytes = (GLsizeiptr) slices * m.Nverts * 11 * sizeof(GLfloat);
+        if(bytes != feedbackBytes){
+            glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedbackVbo);
+            glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY);
+            feedbackBytes = bytes;
+        }
+        glEnable(GL_RASTERIZER_DISCARD);
+        for(unsigned int g=0; g<2; ++g){
+            setGear(g, *matrices[g][0], *matrices[g][1]);
+            captureGear(g, m);
+        }
+        glDisable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(feedbackVao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m.ebo); // part of the vao state
+        glBindBuffer(GL_ARRAY_BUFFER, feedbackVbo);
+        glUniform1i(uniCached, 1);
+    }
+    else if(feedbackBytes){ // off, give the capture's memory back
+        glBindBuffer(GL_ARRAY_BUFFER, feedbackVbo);
+        glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+        feedbackBytes = 0;
+    }
+    for(unsigned int g=0; g<2; ++g){
+        setGear(g, *matrices[g][0], *matrices[g][1]);
+        drawGear(g, m, false, bCache);
+    }
+    if(bOutline){ // the edges, pulled forward so they pass the depth test over their faces
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        glEnable(GL_POLYGON_OFFSET_LINE);
+        glPolygonOffset(-1.0f, -1.0f);
+        glUniform1i(uniOutline, 1);
+        for(unsigned int g=0; g<2; ++g){
+            setGear(g, *matrices[g][0], *matrices[g][1]);
+            drawGear(g, m, true, bCache);
+        }
+        glUniform1i(uniOutline, 0);
+        glDisable(GL_POLYGON_OFFSET_LINE);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    }
+    if(bCache){
+        glUniform1i(uniCached, 0);
+        glBindVertexArray(m.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    }
+}
+
+// an empty contact pattern for the pair as it is now, its textures made the first time
+void OGLWidget::startContact()
+{
+    if(!contactFbo[0]){
+        glGenFramebuffers(2, contactFbo);
+        glGenTextures(2, contactTex);
+        for(int t=0; t<2; ++t){
+            glActiveTexture(GL_TEXTURE1 + t); // left bound, for the mesh shader and the second pass
+            glBindTexture(GL_TEXTURE_2D, contactTex[t]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, t ? 2 : contactCols, t ? 1 : contactRows, 0, GL_RED, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, t ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, t ? GL_NEAREST : GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glBindFramebuffer(GL_FRAMEBUFFER, contactFbo[t]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, contactTex[t], 0);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+    buildSdf(); // only kept up to date for the raymarched mode
+    const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for(GLuint fbo: contactFbo){
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glClearBufferfv(GL_COLOR, 0, zero);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    contactTheta = std::nan("");
+    bClearContact = false;
+}
+
+// Each gear's cut surface is laid out on its half of the flank map and counts one wherever
+// it's within a hair of the other gear's distance field, blended GL_ONE, GL_ONE in place of
+// atomic adds, which would need OpenGL 4.3. A point a count then finds each half's largest,
+// blended GL_MAX, to scale the overlay. Nothing comes back to the CPU
+void OGLWidget::accumulateContact(const meshBuffers &m, const QMatrix4x4 &matrixA, const QMatrix4x4 &matrixB)
+{
+    TRACE_SCOPE("OGLWidget::accumulateContact");
+    GLfloat teeth[2][4], flank[2][4], face[2][3];
+    const QMatrix4x4 toOther[2] = {matrixB.inverted() * matrixA, matrixA.inverted() * matrixB};
+    const float K = (float) slices;
+    GLint viewport[4]; // paintGL()'s, put back at the end
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    sdf[0].twist = 2.0f * std::tan(helix) / (float) Na; // as setGear()
+    sdf[1].twist = -2.0f * std::tan(helix) / (float) Nb;
+    for(int g=0; g<2; ++g) gearSdfUniforms(sdf[g], teeth[g], flank[g], face[g]);
+    glUseProgram(contactProgram);
+    glUniform4fv(contactTeeth, 2, &teeth[0][0]);
+    glUniform4fv(contactFlank, 2, &flank[0][0]);
+    glUniform3fv(contactFace, 2, &face[0][0]);
+    glUniform1f(contactFilletR, sdf[0].filletR);
+    glUniform3f(contactSlice, delZhelix * (1.0f - 1.0f / K), -2.0f * delZhelix / K, 1.0f / K);
+    glBindFramebuffer(GL_FRAMEBUFFER, contactFbo[0]);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    for(unsigned int g=0; g<2; ++g){
+        const GLuint first = g ? m.Nind_a : 0, n1 = g ? m.Nind1_b : m.Nind1_a, n = g ? m.Nind_b : m.Nind_a;
+        glViewport(0, g * contactRows / 2, contactCols, contactRows / 2);
+        glUniformMatrix4fv(contactToOther, 1, GL_FALSE, toOther[g].constData());
+        glUniform1f(contactTwist, sdf[g].twist);
+        glUniform4f(contactShape, sdf[g].rmin, sdf[g].rmaj, sdf[g].toothAngle, sdf[g].N);
+        glUniform1i(contactOther, 1 - g);
+        setVertexBase(g ? m.Nverts_a : 0);
+        drawSlices(n - n1, first + n1);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, contactFbo[1]);
+    glViewport(0, 0, 2, 1);
+    const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    glClearBufferfv(GL_COLOR, 0, zero);
+    glBlendEquation(GL_MAX);
+    glUseProgram(contactMaxProgram);
+    glBindVertexArray(sdfVao); // empty, the points come from gl_VertexID
+    glDrawArrays(GL_POINTS, 0, contactCols * contactRows);
+    glBlendEquation(GL_FUNC_ADD);
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glUseProgram(shaderProgram);
+    glBindVertexArray(m.vao);
+    contactTheta = theta_a;
+}
+
+// gear g's matrices and twist, tan(helix) / rp, gear b the opposite hand
+void OGLWidget::setGear(unsigned int g, const QMatrix4x4 &matrix, const QMatrix4x4 &matRot)
+{
+    setSlices(g ? -2.0f * std::tan(helix) / (float) Nb : 2.0f * std::tan(helix) / (float) Na);
+    glUniformMatrix4fv(uniMat, 1, GL_FALSE, matrix.constData());
+    glUniformMatrix4fv(uniRot, 1, GL_FALSE, matRot.constData());
+}
+
+// run the vertex shader over gear g's vertices once per slice, writing its outputs
+// to gear g's part of the feedback buffer, slice after slice
+void OGLWidget::captureGear(unsigned int g, const meshBuffers &m)
+{
+    const GLuint n = g ? m.Nverts - m.Nverts_a : m.Nverts_a;
+    const GLsizeiptr stride = 11 * sizeof(GLfloat);
+    glBindVertexArray(m.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m.vbo);
+    setVertexBase(g ? m.Nverts_a : 0);
+    glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackVbo, g ? slices * m.Nverts_a * stride : 0, slices * n * stride);
+    glBeginTransformFeedback(GL_POINTS);
+    if(slices == 1) glDrawArrays(GL_POINTS, 0, n);
+    else context() -> extraFunctions() -> glDrawArraysInstanced(GL_POINTS, 0, n, slices);
+    glEndTransformFeedback();
+}
+
+// gear g's blank then its cut surface, from the mesh or, cached, the captured outputs
+// of each slice with the same indices, the feedback vao and buffer must be bound
+void OGLWidget::drawGear(unsigned int g, const meshBuffers &m, bool outline, bool cached)
+{
+    const GLfloat colours[2][2][3] = {{{0.1f, 0.2f, 0.5f}, {0.184314f, 0.309804f, 0.184314f}}, // blue, dark green
+                                      {{0.1f, 0.1f, 0.4f}, {0.25f, 0.25f, 0.25f}}}; // blue, grey
+    const GLuint first = g ? m.Nind_a : 0, n1 = g ? m.Nind1_b : m.Nind1_a, n = g ? m.Nind_b : m.Nind_a;
+    const GLuint verts = g ? m.Nverts - m.Nverts_a : m.Nverts_a, base = g ? slices * m.Nverts_a : 0;
+
+    const bool contact = bContact && bInstanced && !outline && contactFbo[0];
+    auto draw = [&](GLsizei count, GLuint start){
+        if(!cached){
+            drawSlices(count, start);
+            return;
+        }
+        for(GLuint k=0; k<slices; ++k){
+            const GLsizeiptr offset = (GLsizeiptr) (base + k * verts) * 11 * sizeof(GLfloat);
+            const GLsizei stride = 11 * sizeof(GLfloat);
+            glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offset);
+            glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+            glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 6 * sizeof(GLfloat)));
+            glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 9 * sizeof(GLfloat)));
+            glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (GLvoid*)(start * sizeof(GLuint)));
+        }
+    };
+
+    if(!cached) setVertexBase(g ? m.Nverts_a : 0);
+    for(int part=0; part<2; ++part){
+        if(outline) glUniform3f(uniColor, 0.75f, 0.75f, 0.75f);
+        else glUniform3fv(uniColor, 1, colours[g][part]);
+        glUniform1ui(uniPickPart, 2 * g + part + 1);
+        glUniform1i(uniContact, part && contact);
+        if(part && contact){
+            glUniform1i(uniContactGear, g);
+            glUniform4f(uniContactShape, sdf[g].rmin, sdf[g].rmaj, sdf[g].toothAngle, sdf[g].N);
+        }
+        if(part){
+            glUniform1i(uniAnalytic, bAnalytic);
+            glUniform3fv(uniFlank, 1, g ? m.flank_b : m.flank_a);
+        }
+        draw(part ? n - n1 : n1, part ? first + n1 : first);
+    }
+    if(!outline && selGear == (int) g){ // the picked tooth's sectors again, over themselves
+        const GLuint N = g ? m.key.Nb : m.key.Na, blank = n1 / N, cut = (n - n1) / N;
+        glDepthFunc(GL_LEQUAL);
+        glUniform3f(uniColor, 0.9f, 0.55f, 0.1f); // orange
+        glUniform1i(uniAnalytic, 0);
+        glUniform1i(uniContact, 0);
+        draw(blank, first + selTooth * blank);
+        glUniform1i(uniAnalytic, bAnalytic);
+        draw(cut, first + n1 + selTooth * cut);
+        glDepthFunc(GL_LESS);
+    }
+    glUniform1i(uniAnalytic, 0);
+    glUniform1i(uniContact, 0);
 }
 
@@ -11,7 +11,29 @@
 #include <QMouseEvent>
 #include <QQuaternion>
 #include <QVector3D>
+#include <QMatrix4x4>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <memory>
+#include <future>
+#include <array>
+#include "gearpair.h"
+#include "meshcache.h"
+#include "gearsdf.h"
+#include "eventlog.h"
+#include "gearpick.h"
 
+// why a frame is wanted, requestFrame() merges them until the next refresh
+enum frameDirty : unsigned int { dirtyCamera = 1, dirtyLight = 2, dirtySeparation = 4, dirtyRotation = 8, dirtyScene = 16 };
+
+// what the frame scheduler did with the requests, avoided is merged + hidden
+struct frameCounts
+{
+    unsigned long long requested = 0, painted = 0;
+    unsigned long long merged = 0; // folded into a frame already waiting for the refresh
+    unsigned long long hidden = 0; // dropped, the window was minimised or covered
+    unsigned long long avoided() const { return merged + hidden; }
+};
 
 class OGLWidget : public QOpenGLWidget, protected QOpenGLFunctions_3_0
 {
@@ -25,28 +47,112 @@ public:
     void setNb(GLuint x) { Nb = x; }
     void rebuild() { rebuild_flg = true; }
     void setSpeed(float x){ speed = x * 12.0f / (float) Na; }
-    void setLightX(float x){ lightX = x; update(); }
-    void setLightY(float y){ lightY = y; update(); }
-    void setLightZ(float z){ lightZ = z; update(); }
-    void setBExact(bool x){ bExact = x; }
+    void setLightX(float x){ lightX = x; requestFrame(dirtyLight); }
+    void setLightY(float y){ lightY = y; requestFrame(dirtyLight); }
+    void setLightZ(float z){ lightZ = z; requestFrame(dirtyLight); }
+    void setBExact(bool x){ bExact = x; if(bSdf) rebuild_flg = true; bClearContact = true; requestFrame(dirtyScene); }
     void setSeperation(const float del);
+    void setHelix(float x); // radians, gear a right hand for positive, gear b the opposite hand
+    void setAnalytic(bool x){ bAnalytic = x; rebuild_flg = true; requestFrame(dirtyScene); } // coarse meshes, flank normals per fragment
+    void setRaymarch(bool x){ bSdf = x; rebuild_flg = true; requestFrame(dirtyScene); } // no meshes, the fragment shader marches the gears' distance fields
+    void setOutline(bool x){ bOutline = x; requestFrame(dirtyScene); } // a second pass draws the triangles' edges
+    void setFeedback(bool x){ bFeedback = x; requestFrame(dirtyScene); } // passes after the first read the vertex shader's captured outputs
+    bool hasFeedback() const { return bInstanced; } // needs the 330 shaders
+    void setContact(bool x){ bContact = x; bClearContact = true; requestFrame(dirtyScene); } // the cut surfaces coloured by where they've touched, from now on
+    bool hasContact() const { return bInstanced; } // a geometry shader and float blending, with the 330 shaders
     void setPerspective(float x) { perspective = x; bSetPerspective = true; }
-    void reset() { delX = delY = 0.0f; delZ = delZ0; QuatOrient = QQuaternion(); update(); }
+    void reset() { delX = delY = 0.0f; delZ = delZ0; QuatOrient = QQuaternion(); requestFrame(dirtyCamera); }
+    void requestFrame(unsigned int why); // frameDirty bits, at most one paint per display refresh
+    bool exposed() const;
+    const frameCounts& getFrameCounts() const { return counts; }
+    std::size_t getGpuBytes() const { return mesh[0].gpuBytes + mesh[1].gpuBytes + feedbackBytes + (contactFbo[0] ? 4 * (contactCols * contactRows + 2) : 0); }
+    std::size_t getPeakBytes() const { return peakBytes; } // building the last pair uploaded, 0 from the library
+    std::size_t getPickBytes() const; // both meshes' bvhs, once picked
+    void setEventLog(eventLog *x) { inputLog = x; } // mouse input is added while it's recording
+    void mousePress(QPoint pos, Qt::MouseButtons buttons, Qt::KeyboardModifiers modifiers); // Ctrl+left picks a tooth
+    void mouseMove(QPoint pos, Qt::MouseButtons buttons, Qt::KeyboardModifiers modifiers);
+    double paintTimed(); // ms
     void reZeroThetas() { theta_a = theta_b = 0.0; }
     std::string& getOGLVersionInfo(){ return OGLVersionInfo; }
     std::string& getShaderVersionInfo(){ return ShaderVersionInfo; }
+    meshCache& getCache(){ return cache; }
+    pairKey getShownPair() const; // the pair on screen, which may lag setNa(), setNb() and setPa() until it's rebuilt
 protected:
     void initializeGL();
     void paintGL();
     void mousePressEvent(QMouseEvent *event);
     void mouseMoveEvent(QMouseEvent *event);
+    void showEvent(QShowEvent *event);
     void buildGears(bool redo=false);
-    float NewtonRaphson(const unsigned int n, const float rp, const float fac);
+    void uploadMesh(unsigned int i, const gearPair &pair);
+    bool uploadLibraryMesh(unsigned int i, bool bEx);
+    void setVertexBase(GLuint base);
+    void setFace(GLfloat halfFace);
+    void setSlices(float twist);
+    void drawSlices(GLsizei count, GLuint first);
+    void buildSdf();
+    void paintSdf(const QMatrix4x4 &matrixA, const QMatrix4x4 &matrixB);
+    void pickTooth(QPoint pos);
+    bool pickBvh(QPoint pos, unsigned int &g, unsigned int &tooth, float &radius);
+    bool pickIds(QPoint pos, unsigned int &g, unsigned int &tooth);
+    GLuint compileShader(GLenum type, std::vector<const char*> source, const std::string &what);
+    void startContact();
     std::string OGLVersionInfo, ShaderVersionInfo;
     int rotate;
     GLuint shaderProgram;
-    GLuint vao, vbo, ebo;
+    // both profiles are kept resident, [0] exact involute, [1] circle approximation
+    struct meshBuffers{
+        GLuint vao, vbo, ebo;
+        GLuint Nind_a, Nind1_a, Nind_b, Nind1_b;
+        GLuint Nverts_a; // gear b's first vertex, its indices aren't rebased
+        GLuint Nverts; // both gears
+        GLfloat flank_a[3], flank_b[3]; // for the analytic flank normals, only of coarse meshes
+        GLfloat halfFace = 5.0f; // half the face width, gear a's centre vertex z, as built rather than assumed
+        GLsizeiptr gpuBytes = 0; // vertex and index buffers
+        bool bReady = false;
+        pairKey key{0, 0, 0.0f, true, gearDetail::fine}; // the pair it holds, or is waiting for
+        std::array<meshBvh, 2> bvh; // each gear's triangles in its own frame for picking, built at the first pick
+    } mesh[2];
+    void setGear(unsigned int g, const QMatrix4x4 &matrix, const QMatrix4x4 &matRot);
+    void captureGear(unsigned int g, const meshBuffers &m);
+    void drawGear(unsigned int g, const meshBuffers &m, bool outline, bool cached);
+    void buildPick(meshBuffers &m);
+    void accumulateContact(const meshBuffers &m, const QMatrix4x4 &matrixA, const QMatrix4x4 &matrixB);
+    meshCache cache;
+    std::future<std::shared_ptr<const gearPair>> pending; // the profile not on screen, built in the background
+    unsigned int pendingMesh;
+    std::size_t peakBytes = 0;
     GLint uniMat, uniRot, uniColor, uniPerspective, uniLightPos;
+    GLint uniTwist, uniSlice, uniSliceBase;
+    GLint uniAnalytic, uniFlank;
+    GLint uniOutline, uniCached;
+    GLint uniPickPart;
+    // the ID buffer picking pass, one pixel of part and triangle numbers, made at the first pick
+    GLuint pickFbo = 0, pickRbo[2] = {0, 0};
+    QMatrix4x4 pickMatrix[2]; // each gear's model view matrix, as last painted
+    // the contact pattern, counts on each gear's flank map added by blending as the gears turn, [0] gear a's
+    // lower half and b's upper, [1] each half's largest. Made when it's first turned on, never read back
+    static const GLsizei contactCols = 256, contactRows = 128; // across both flanks, along the face
+    GLuint contactProgram = 0, contactMaxProgram = 0, contactFbo[2] = {0, 0}, contactTex[2] = {0, 0};
+    GLint contactToOther, contactTwist, contactSlice, contactShape, contactOther, contactTeeth, contactFlank, contactFace, contactFilletR;
+    GLint uniContact, uniContactGear, uniContactShape, uniContactFace, contactHalfFace;
+    double contactTheta = 0.0; // theta_a when last added to
+    int selGear = -1; // the picked tooth, highlighted, -1 for none
+    unsigned int selTooth = 0;
+    // transform feedback, each gear's vertex shader outputs for every slice, gear a's then b's
+    GLuint feedbackVao, feedbackVbo;
+    GLsizeiptr feedbackBytes = 0;
+    // the raymarched mode, its vao is empty as the vertex shader makes the triangle
+    GLuint sdfProgram, sdfVao;
+    GLint sdfPerspective, sdfInvPerspective, sdfToGear, sdfTeeth, sdfFlank, sdfFace, sdfFilletR, sdfColours, sdfLightPos;
+    gearSdf sdf[2];
+    pairKey sdfKey{0, 0, 0.0f, true, gearDetail::fine}; // the pair the fields were made for
+    bool bInstanced = false; // glDrawElementsInstanced and gl_InstanceID, with the 330 shaders
+    std::unique_ptr<QTimer> frameTimer; // single shot, fires at the next refresh slot
+    QElapsedTimer lastPaint;
+    unsigned int dirty = 0; // frameDirty bits not yet painted
+    frameCounts counts;
+    eventLog *inputLog = nullptr;
     QPoint lastPos;
     bool paused = false;
     QQuaternion QuatOrient; // initialised to unit quaternion, stores the global orientation
@@ -54,9 +160,16 @@ protected:
     const float delZ0 = -125.0f;
     float delX =0.0f, delY = 0.0f, delZ = delZ0;
     float delSeperation = 0.0f, delTheta_a = 0.0f;
+    float helix = 0.0f;
+    float delZhelix = 5.0f; // half the face width of the meshes on screen, see setFace()
+    GLuint slices = 1; // a helical gear's spur mesh is drawn this many times along the face
     float pa;
-    GLuint Na, Nb, Nind_a, Nind1_a, Nind_b, Nind1_b;
+    GLuint Na, Nb;
     bool bExact = true, bSetPerspective = true;
+    bool bAnalytic = false; // coarse meshes, the fragment shader recomputes the flank normals
+    bool bSdf = false; // raymarched, changing N or the pressure angle only changes uniforms
+    bool bOutline = false, bFeedback = false;
+    bool bContact = false, bClearContact = false;
     const double delTheta = 0.1;
     double theta_a = 0.0, theta_b = 0.0;
     bool rebuild_flg = false;
@@ -0,0 +1,131 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "gear.h"
+#include "phasebatch.h"
+#include "trace.h"
+
+namespace {
+
+const float halfPi = 1.5707963267948966f;
+const float quarterPi = 0.7853981633974483f;
+const float twoOverPi = 0.6366197723675814f;
+// pi/2 split in two so k * pi/2 is subtracted without losing bits
+const float halfPiHi = 1.5703125f;
+const float halfPiLo = 4.8382679e-4f;
+
+// sin and cos of a > -pi/4, good to a float ulp or two for a up to a few hundred,
+// minimax polynomials on [-pi/4, pi/4] after removing quarter turns, with the
+// quadrant applied by arithmetic rather than branches so the lanes stay in step
+inline void sinCos(float a, float &s, float &c)
+{
+    const int q = static_cast<int>(a * twoOverPi + 0.5f);
+    const float k = static_cast<float>(q);
+    const float r = (a - k * halfPiHi) - k * halfPiLo;
+    const float z = r * r;
+    const float ps = r + r * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+    const float pc = 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+    const float swap = static_cast<float>(q & 1);
+    s = (1.0f - static_cast<float>(q & 2)) * (swap * pc + (1.0f - swap) * ps);
+    c = (1.0f - static_cast<float>((q + 1) & 2)) * (swap * ps + (1.0f - swap) * pc);
+}
+
+// atan to a float ulp or two, the argument folded into [-tan(pi/8), tan(pi/8)]
+inline float atanPoly(float x)
+{
+    const float ax = std::fabs(x);
+    const bool bBig = ax > 2.414213562373095f, bMid = ax > 0.4142135623730950f;
+    const float t = bBig ? -1.0f / ax : (bMid ? (ax - 1.0f) / (ax + 1.0f) : ax);
+    const float base = bBig ? halfPi : (bMid ? quarterPi : 0.0f);
+    const float z = t * t;
+    const float p = t + t * z * (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f);
+    const float y = base + p;
+    return x < 0.0f ? -y : y;
+}
+
+// one block of up to phaseLanes gears, each step is a loop across the lanes
+void phaseLanesBlock(unsigned int iters, const float *rpIn, const float *facIn, const float *paIn, float *out, std::size_t m)
+{
+    float rp[phaseLanes], r2[phaseLanes], pa[phaseLanes], sinpa[phaseLanes], cospa[phaseLanes], rbc[phaseLanes];
+    float theta[phaseLanes], x[phaseLanes], y[phaseLanes];
+
+    // idle lanes repeat the first gear so they stay finite
+    for(std::size_t l=0; l<phaseLanes; ++l){
+        const std::size_t i = l < m ? l : 0;
+        rp[l] = rpIn[i];
+        r2[l] = rpIn[i] * facIn[i] * rpIn[i] * facIn[i];
+        pa[l] = paIn[i];
+    }
+    for(std::size_t l=0; l<phaseLanes; ++l){
+        sinCos(pa[l], sinpa[l], cospa[l]);
+        rbc[l] = rp[l] * cospa[l];
+        theta[l] = 0.05f;
+    }
+    for(unsigned int it=0; it<iters; ++it){
+        for(std::size_t l=0; l<phaseLanes; ++l){
+            float sint, cost;
+            sinCos(pa[l] + theta[l], sint, cost);
+            const float u = rp[l] * (sinpa[l] + theta[l] * cospa[l]);
+            const float xl = -rbc[l] * sint + u * cost;
+            const float yl = rbc[l] * cost + u * sint;
+            const float dx = -rbc[l] * cost + rp[l] * cospa[l] * cost - u * sint;
+            const float dy = -rbc[l] * sint + rp[l] * cospa[l] * sint + u * cost;
+            // Newton on the squared radius, the same root without a square root
+            theta[l] += (r2[l] - (xl * xl + yl * yl)) / (2.0f * (xl * dx + yl * dy));
+        }
+    }
+    for(std::size_t l=0; l<phaseLanes; ++l){
+        float sint, cost;
+        sinCos(pa[l] + theta[l], sint, cost);
+        const float u = rp[l] * (sinpa[l] + theta[l] * cospa[l]);
+        x[l] = -rbc[l] * sint + u * cost;
+        y[l] = rbc[l] * cost + u * sint;
+    }
+    for(std::size_t l=0; l<phaseLanes; ++l) x[l] = atanPoly(x[l] / y[l]) * (180.0f / 3.141592654f);
+    std::copy(x, x + m, out);
+}
+
+}
+
+float separationPhase(unsigned int Na, unsigned int Nb, float pa, float del)
+{
+    const float rpA = (float) Na * 0.5f;
+    const float rpB = (float) Nb * 0.5f;
+    const float fac = (rpA + rpB + del) / (rpA + rpB);
+    return involutePhase(7, rpA, fac, pa) + involutePhase(7, rpB, fac, pa) * (float) Nb / (float) Na;
+}
+
+void involutePhaseBatch(unsigned int iters, const float *rp, const float *fac, const float *pa, float *phase, std::size_t n)
+{
+    for(std::size_t i=0; i<n; i+=phaseLanes){
+        phaseLanesBlock(iters, rp + i, fac + i, pa + i, phase + i, std::min(phaseLanes, n - i));
+    }
+}
+
+void separationPhaseBatch(const unsigned int *Na, const unsigned int *Nb, const float *pa, const float *del,
+                          float *delTheta_a, std::size_t n)
+{
+    TRACE_SCOPE("separationPhaseBatch");
+    // both gears of a pair go through the same kernel, a block of pairs at a time
+    const std::size_t block = 256;
+    std::vector<float> rp(2 * block), fac(2 * block), pas(2 * block), phase(2 * block);
+
+    for(std::size_t i0=0; i0<n; i0+=block){
+        const std::size_t m = std::min(block, n - i0);
+        for(std::size_t i=0; i<m; ++i){
+            const float rpA = (float) Na[i0+i] * 0.5f, rpB = (float) Nb[i0+i] * 0.5f;
+            rp[i] = rpA;
+            rp[m+i] = rpB;
+            fac[i] = fac[m+i] = (rpA + rpB + del[i0+i]) / (rpA + rpB);
+            pas[i] = pas[m+i] = pa[i0+i];
+        }
+        involutePhaseBatch(7, rp.data(), fac.data(), pas.data(), phase.data(), 2 * m);
+        for(std::size_t i=0; i<m; ++i){
+            delTheta_a[i0+i] = phase[i] + phase[m+i] * (float) Nb[i0+i] / (float) Na[i0+i];
+        }
+    }
+}
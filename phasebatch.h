@@ -0,0 +1,25 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef PHASEBATCH_H
+#define PHASEBATCH_H
+
+#include <cstddef>
+
+// phase offset (degrees) of gear a which keeps a pair meshing when their centres
+// are moved apart by del, what OGLWidget::setSeperation() needs
+float separationPhase(unsigned int Na, unsigned int Nb, float pa, float del);
+
+// the same for n pairs at once, as a structure of arrays: element i of each is
+// the pair Na[i], Nb[i] at pressure angle pa[i] (radians) and separation del[i]
+void separationPhaseBatch(const unsigned int *Na, const unsigned int *Nb, const float *pa, const float *del,
+                          float *delTheta_a, std::size_t n);
+
+// involutePhase() for n gears, the Newton iterations run phaseLanes gears abreast
+// with polynomial sin, cos and atan so the compiler can keep them in vector registers
+void involutePhaseBatch(unsigned int iters, const float *rp, const float *fac, const float *pa, float *phase, std::size_t n);
+
+const std::size_t phaseLanes = 8;
+
+#endif // PHASEBATCH_H
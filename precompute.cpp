@@ -0,0 +1,54 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include "precompute.h"
+
+Precomputer::~Precomputer()
+{
+    cancel();
+    wait();
+}
+
+// keys are in order of likelihood, most likely first
+void Precomputer::speculate(const std::vector<pairKey> &keys)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    queue.assign(keys.rbegin(), keys.rend());
+    bStop = false;
+    if(!bRunning){
+        wait(); // run() may be returning still
+        bRunning = true;
+        start(QThread::IdlePriority);
+    }
+}
+
+// the pair being built when called is still finished and cached, a gear can't be stopped part way
+void Precomputer::cancel()
+{
+    bStop = true;
+    std::lock_guard<std::mutex> lock(mtx);
+    queue.clear();
+}
+
+void Precomputer::run()
+{
+    for(;;){
+        pairKey key;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(bStop || queue.empty()){
+                bRunning = false;
+                return;
+            }
+            key = queue.back();
+            queue.pop_back();
+        }
+        try{
+            cache.get(key);
+        }
+        catch(...){ // out of memory or no thread to build on, a guess is only worth skipping
+        }
+    }
+}
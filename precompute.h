@@ -0,0 +1,33 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef PRECOMPUTE_H
+#define PRECOMPUTE_H
+
+#include <QThread>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "meshcache.h"
+
+// Builds guessed gear pairs into the mesh cache at idle priority,
+// so that a following rebuild only has to upload the buffers
+class Precomputer : public QThread
+{
+public:
+    explicit Precomputer(meshCache &icache) : cache(icache) {}
+    ~Precomputer();
+    void speculate(const std::vector<pairKey> &keys); // replaces any outstanding guesses
+    void cancel();
+protected:
+    void run() override;
+private:
+    meshCache &cache;
+    std::mutex mtx;
+    std::vector<pairKey> queue; // next guess at the back
+    std::atomic<bool> bStop{false};
+    bool bRunning = false; // guarded by mtx
+};
+
+#endif // PRECOMPUTE_H
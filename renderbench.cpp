@@ -0,0 +1,1092 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+// Frame times of the simulator's two render paths, the meshes against the
+// raymarched distance fields, for a sweep of tooth counts. Renders off screen
+// through EGL without a window, so on Linux with Mesa it runs on llvmpipe:
+//     LIBGL_ALWAYS_SOFTWARE=1 ./renderbench
+// usage: renderbench [--size WxH] [--frames n] [--teeth list] [--pa degrees]
+// --stress K[,K...] instead draws a K by K grid of meshing pairs, --pair Na,Nb,
+// through each --path draw, instanced or mdi (multi-draw indirect), or all
+// --passes P[,P...] draws each of the --teeth pairs P times a frame, running the
+// vertex shader every pass against once into a transform feedback buffer
+// --pick R picks the tooth under each of an R by R grid of pixels of the --teeth
+// pairs, by a ray cast against each gear's bvh and by a one pixel ID buffer pass
+// --contact F turns each of the --teeth pairs through one pitch in F frames,
+// accumulating the contact pattern on the GPU as the simulator's G key does
+// build with renderbench.pro
+
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "gear.h"
+#include "gearpair.h"
+#include "gearsdf.h"
+#include "phasebatch.h"
+#include "gearpick.h"
+#include "myshaders.h"
+
+namespace {
+
+const float pi = 3.1415926535897932f;
+
+// column major, as glUniformMatrix4fv wants
+struct mat4
+{
+    float m[16] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    float& at(int row, int col) { return m[4 * col + row]; }
+    float at(int row, int col) const { return m[4 * col + row]; }
+};
+
+mat4 operator*(const mat4 &a, const mat4 &b)
+{
+    mat4 c;
+    for(int i=0; i<4; ++i){
+        for(int j=0; j<4; ++j){
+            float s = 0.0f;
+            for(int k=0; k<4; ++k) s += a.at(i, k) * b.at(k, j);
+            c.at(i, j) = s;
+        }
+    }
+    return c;
+}
+
+// as QMatrix4x4::perspective
+mat4 perspective(float fovDeg, float aspect, float zNear, float zFar)
+{
+    mat4 p;
+    const float f = 1.0f / std::tan(0.5f * fovDeg * pi / 180.0f);
+    p.at(0, 0) = f / aspect;
+    p.at(1, 1) = f;
+    p.at(2, 2) = -(zFar + zNear) / (zFar - zNear);
+    p.at(2, 3) = -2.0f * zFar * zNear / (zFar - zNear);
+    p.at(3, 2) = -1.0f;
+    p.at(3, 3) = 0.0f;
+    return p;
+}
+
+mat4 inversePerspective(const mat4 &p)
+{
+    mat4 q;
+    q.at(0, 0) = 1.0f / p.at(0, 0);
+    q.at(1, 1) = 1.0f / p.at(1, 1);
+    q.at(2, 2) = 0.0f;
+    q.at(2, 3) = -1.0f;
+    q.at(3, 2) = 1.0f / p.at(2, 3);
+    q.at(3, 3) = p.at(2, 2) / p.at(2, 3);
+    return q;
+}
+
+mat4 translate(float x, float y, float z)
+{
+    mat4 t;
+    t.at(0, 3) = x;
+    t.at(1, 3) = y;
+    t.at(2, 3) = z;
+    return t;
+}
+
+// about axis 0 (x) or 2 (z)
+mat4 rotate(float deg, int axis)
+{
+    mat4 r;
+    const float c = std::cos(deg * pi / 180.0f), s = std::sin(deg * pi / 180.0f);
+    const int i = axis == 0 ? 1 : 0, j = i + 1;
+    r.at(i, i) = c;
+    r.at(i, j) = -s;
+    r.at(j, i) = s;
+    r.at(j, j) = c;
+    return r;
+}
+
+// rotation and translation only
+mat4 rigidInverse(const mat4 &a)
+{
+    mat4 b;
+    for(int i=0; i<3; ++i){
+        for(int j=0; j<3; ++j) b.at(i, j) = a.at(j, i);
+        b.at(i, 3) = -(a.at(0, i) * a.at(0, 3) + a.at(1, i) * a.at(1, 3) + a.at(2, i) * a.at(2, 3));
+    }
+    return b;
+}
+
+// 4.3 for glMultiDrawElementsIndirect where the driver has it, else 3.3 as the simulator
+bool contextEGL()
+{
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay dpy = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                                        : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor, nConfigs = 0;
+    if(dpy == EGL_NO_DISPLAY || !eglInitialize(dpy, &major, &minor) || !eglBindAPI(EGL_OPENGL_API)) return false;
+    const EGLint configAttribs[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config;
+    eglChooseConfig(dpy, configAttribs, &config, 1, &nConfigs);
+    EGLContext ctx = EGL_NO_CONTEXT;
+    const EGLint versions[2][2] = {{4, 3}, {3, 3}};
+    for(const auto &v: versions){
+        const EGLint contextAttribs[] = {EGL_CONTEXT_MAJOR_VERSION, v[0], EGL_CONTEXT_MINOR_VERSION, v[1],
+                                         EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT, EGL_NONE};
+        ctx = eglCreateContext(dpy, nConfigs ? config : EGLConfig(0), EGL_NO_CONTEXT, contextAttribs);
+        if(ctx != EGL_NO_CONTEXT) break;
+    }
+    return ctx != EGL_NO_CONTEXT && eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, ctx);
+}
+
+GLuint compileShader(GLenum type, std::vector<const char*> source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, (GLsizei) source.size(), source.data(), nullptr);
+    glCompileShader(shader);
+    int success;
+    char infoLog[1024];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if(!success){
+        glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+        std::cerr << "shader compilation failed\n" << infoLog << std::endl;
+        std::exit(1);
+    }
+    return shader;
+}
+
+// bFeedback to capture the mesh shader's outputs, as OGLWidget does
+GLuint linkProgram(GLuint vertexShader, GLuint fragmentShader, bool bFeedback = false)
+{
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glBindFragDataLocation(program, 0, "outColor");
+    if(bFeedback) glTransformFeedbackVaryings(program, 4, feedbackVaryings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    glDeleteShader(fragmentShader);
+    glDeleteShader(vertexShader);
+    return program;
+}
+
+struct frameStats
+{
+    double ms; // median frame
+    std::vector<unsigned char> pixels; // of the last frame
+};
+
+// the simulator's view of a pair: pulled back so the pair fills most of the
+// width whatever N, tilted to show the flanks, gears at phase theta
+struct pairView
+{
+    unsigned int Na, Nb;
+    float pa, aspect;
+    mat4 proj, matrixA, matrixB, rotA, rotB;
+
+    pairView(unsigned int iNa, unsigned int iNb, float ipa, float iaspect) : Na(iNa), Nb(iNb), pa(ipa), aspect(iaspect) {}
+    float distance() const { return 0.5f * (float) (Na + Nb + 4) / (0.8f * aspect * std::tan(22.5f * pi / 180.0f)); }
+    // the simulator's 280 far plane, pushed back for the big gears
+    void project() { proj = perspective(45.0f, aspect, 0.1f, std::max(280.0f, distance() + (float) (Na + Nb))); }
+    void at(float theta, float phaseA = 0.0f) // degrees, phaseA as OGLWidget's delTheta_a
+    {
+        const float dist = distance();
+        const mat4 view = translate(0.0f, 0.0f, -dist) * rotate(-30.0f, 0);
+        const float thetaB = -theta * (float) Na / (float) Nb;
+        matrixA = view * translate(-0.5f * (float) Nb, 0.0f, 0.0f) * rotate(theta + phaseA, 2);
+        matrixB = view * translate(0.5f * (float) Na, 0.0f, 0.0f) * rotate(thetaB, 2);
+        rotA = rotate(-30.0f, 0) * rotate(theta, 2);
+        rotB = rotate(-30.0f, 0) * rotate(thetaB, 2);
+    }
+};
+
+template<class F> frameStats timeFrames(unsigned int frames, int w, int h, F draw)
+{
+    frameStats st;
+    std::vector<double> times;
+    for(unsigned int f=0; f<=frames; ++f){ // the first is warm up, shader compiles are lazy
+        const auto t0 = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        draw(f);
+        glFinish();
+        const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+        if(f) times.push_back(dt.count());
+    }
+    std::sort(times.begin(), times.end());
+    st.ms = times[times.size() / 2];
+    st.pixels.resize(4 * (std::size_t) w * h);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, st.pixels.data());
+    return st;
+}
+
+// percentage of pixels more than 16 grey levels apart in any channel
+double percentDiffer(const std::vector<unsigned char> &a, const std::vector<unsigned char> &b)
+{
+    std::size_t differ = 0;
+    for(std::size_t i=0; i<a.size(); i+=4){
+        int d = 0;
+        for(int c=0; c<3; ++c) d = std::max(d, std::abs((int) a[i+c] - (int) b[i+c]));
+        if(d > 16) ++differ;
+    }
+    return 100.0 * differ / (a.size() / 4);
+}
+
+// the mesh shader with the pair's matrices per instance, not uniforms,
+// for the stress scene's instanced and indirect paths
+const char *stressVertexShaderSource = R"glsl(
+    #version 330
+    layout (location = 0) in vec3 aPos;
+    layout (location = 1) in vec3 aNormal;
+    layout (location = 2) in mat4 aMatrix; // 2 to 5
+    layout (location = 6) in mat4 aRot; // 6 to 9
+    out vec3 Normal, FragPos;
+    out vec3 Local;
+    out vec2 LocalNormal;
+    uniform mat4 perspective;
+
+    void main()
+    {
+       vec4 pos = vec4(aPos, 1.0);
+       gl_Position = perspective * aMatrix * pos;
+       Normal = vec3(aRot * vec4(aNormal, 0.0));
+       FragPos = vec3(aMatrix * pos);
+       Local = aPos;
+       LocalNormal = aNormal.xy;
+    }
+)glsl";
+
+enum class stressPath { draw, instanced, indirect };
+const char *stressPathName[] = {"draw", "instanced", "mdi"};
+
+// one of the grid's pairs, turned as OGLWidget::incRotate
+struct gridPair
+{
+    float x, y, speed;
+    double theta_a = 0.0, theta_b = 0.0;
+    void incRotate(unsigned int Na, unsigned int Nb)
+    {
+        const double delTheta = 0.1;
+        theta_a -= speed * delTheta;
+        theta_b += speed * delTheta * (double) Na / (double) Nb;
+    }
+};
+
+// a K by K grid of meshing pairs, all drawn from the one pair of meshes
+struct stressScene
+{
+    unsigned int K, Na, Nb;
+    float delTheta_a; // gear a's phase so the teeth mesh, as OGLWidget::setSeperation
+    mat4 proj, view, tilt;
+    std::vector<gridPair> pairs;
+    std::vector<mat4> instances; // matrix and rot of each gear a, then each gear b
+
+    stressScene(unsigned int k, unsigned int na, unsigned int nb, float pa, float aspect) :
+        K(k), Na(na), Nb(nb), delTheta_a(separationPhase(na, nb, pa, 0.0f)), tilt(rotate(-30.0f, 0))
+    {
+        const float cw = (float) (Na + Nb + 4), ch = (float) (std::max(Na, Nb) + 4), t = std::tan(22.5f * pi / 180.0f);
+        const float dist = std::max(0.5f * K * cw / (0.9f * aspect * t), 0.5f * K * ch / (0.9f * t));
+        proj = perspective(45.0f, aspect, 0.1f, dist + K * std::max(cw, ch));
+        view = translate(0.0f, 0.0f, -dist) * tilt;
+        for(unsigned int i=0; i<K*K; ++i){ // speeds as the speed bar's first few steps, so the pairs drift apart
+            gridPair p{((float) (i % K) - 0.5f * (K - 1)) * cw, ((float) (i / K) - 0.5f * (K - 1)) * ch,
+                       (1.0f + 0.25f * (i % 4)) * 12.0f / (float) Na};
+            pairs.push_back(p);
+        }
+        instances.resize(4 * pairs.size());
+    }
+    std::size_t size() const { return pairs.size(); }
+    // turn every pair a step and work out its matrices, a's then b's
+    void step()
+    {
+        const std::size_t n = pairs.size();
+        for(std::size_t i=0; i<n; ++i){
+            gridPair &p = pairs[i];
+            p.incRotate(Na, Nb);
+            const float ta = (float) p.theta_a + delTheta_a, tb = (float) p.theta_b;
+            instances[2 * i] = view * translate(p.x - 0.5f * Nb, p.y, 0.0f) * rotate(ta, 2);
+            instances[2 * i + 1] = tilt * rotate(ta, 2);
+            instances[2 * (n + i)] = view * translate(p.x + 0.5f * Na, p.y, 0.0f) * rotate(tb, 2);
+            instances[2 * (n + i) + 1] = tilt * rotate(tb, 2);
+        }
+    }
+};
+
+// as glMultiDrawElementsIndirect reads them
+struct drawCommand
+{
+    GLuint count, instanceCount, firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct stressStats
+{
+    double ms, submitMs; // median frame, and median time to issue its commands
+    unsigned int draws;
+    std::vector<unsigned char> pixels;
+};
+
+// times the grid through one path, the pairs start from rest each time so the last frames match
+stressStats timeStress(stressPath path, const stressScene &start, const gearPair &pair, GLuint vbo, unsigned int frames,
+                       int w, int h, GLuint meshProgram, GLuint stressProgram)
+{
+    stressScene s = start;
+    const std::size_t n = s.size();
+    const GLfloat colours[4][3] = {{0.1f, 0.2f, 0.5f}, {0.184314f, 0.309804f, 0.184314f}, {0.1f, 0.1f, 0.4f}, {0.25f, 0.25f, 0.25f}};
+    const GLuint count[4] = {pair.Nind1_a, pair.Nind_a - pair.Nind1_a, pair.Nind1_b, pair.Nind_b - pair.Nind1_b};
+    const GLuint first[4] = {0, pair.Nind1_a, pair.Nind_a, pair.Nind_a + pair.Nind1_b};
+    auto vertexBase = [](GLuint base){
+        const GLsizeiptr offset = base * 6 * sizeof(GLfloat);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+    };
+    auto instanceBase = [](std::size_t base){ // the matrix and rot columns of gear base onward
+        for(GLuint c=0; c<8; ++c){
+            const GLsizeiptr offset = (2 * base * 16 + 4 * c) * sizeof(GLfloat);
+            glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, 32 * sizeof(GLfloat), (GLvoid*)offset);
+        }
+    };
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    vertexBase(0);
+    GLuint instanceVbo = 0, indirect = 0;
+    const GLuint program = path == stressPath::draw ? meshProgram : stressProgram;
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "perspective"), 1, GL_FALSE, s.proj.m);
+    const GLint uniMat = glGetUniformLocation(program, "matrix"), uniRot = glGetUniformLocation(program, "rot");
+    const GLint uniColor = glGetUniformLocation(program, "triangleColor");
+    if(path != stressPath::draw){
+        glGenBuffers(1, &instanceVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, s.instances.size() * sizeof(mat4), nullptr, GL_STREAM_DRAW);
+        for(GLuint c=0; c<8; ++c){
+            glEnableVertexAttribArray(2 + c);
+            glVertexAttribDivisor(2 + c, 1);
+        }
+        instanceBase(0);
+    }
+    if(path == stressPath::indirect){ // one command per pair for each colour, 4 calls a frame
+        std::vector<drawCommand> commands;
+        for(GLuint part=0; part<4; ++part){
+            for(GLuint i=0; i<n; ++i)
+                commands.push_back({count[part], 1, first[part], part < 2 ? 0 : (GLint) pair.Nverts_a, part < 2 ? i : (GLuint) n + i});
+        }
+        glGenBuffers(1, &indirect);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(drawCommand), commands.data(), GL_STATIC_DRAW);
+    }
+
+    stressStats st;
+    std::vector<double> times, submits;
+    for(unsigned int f=0; f<=frames; ++f){
+        const auto t0 = std::chrono::steady_clock::now();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        s.step();
+        st.draws = 0;
+        if(path == stressPath::draw){ // as OGLWidget::paintGL, once per pair
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            for(std::size_t i=0; i<n; ++i){
+                for(int g=0; g<2; ++g){
+                    const std::size_t m = 2 * (g * n + i);
+                    vertexBase(g ? pair.Nverts_a : 0);
+                    glUniformMatrix4fv(uniMat, 1, GL_FALSE, s.instances[m].m);
+                    glUniformMatrix4fv(uniRot, 1, GL_FALSE, s.instances[m + 1].m);
+                    for(int part=2*g; part<2*g+2; ++part){
+                        glUniform3fv(uniColor, 1, colours[part]);
+                        glDrawElements(GL_TRIANGLES, count[part], GL_UNSIGNED_INT, (GLvoid*)(first[part] * sizeof(GLuint)));
+                        ++st.draws;
+                    }
+                }
+            }
+        }
+        else{
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, s.instances.size() * sizeof(mat4), s.instances.data());
+            for(int part=0; part<4; ++part){
+                glUniform3fv(uniColor, 1, colours[part]);
+                if(path == stressPath::indirect){
+                    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (GLvoid*)(part * n * sizeof(drawCommand)), (GLsizei) n, 0);
+                }
+                else{ // every gear a, then every gear b, in one draw each
+                    if(part == 0 || part == 2){
+                        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+                        instanceBase(part ? n : 0);
+                    }
+                    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count[part], GL_UNSIGNED_INT, (GLvoid*)(first[part] * sizeof(GLuint)),
+                                                      (GLsizei) n, part < 2 ? 0 : (GLint) pair.Nverts_a);
+                }
+                ++st.draws;
+            }
+        }
+        const std::chrono::duration<double, std::milli> submit = std::chrono::steady_clock::now() - t0;
+        glFinish();
+        const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+        if(f){
+            times.push_back(dt.count());
+            submits.push_back(submit.count());
+        }
+    }
+    std::sort(times.begin(), times.end());
+    std::sort(submits.begin(), submits.end());
+    st.ms = times[times.size() / 2];
+    st.submitMs = submits[submits.size() / 2];
+    st.pixels.resize(4 * (std::size_t) w * h);
+    glReadPixels(0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE, st.pixels.data());
+
+    if(path != stressPath::draw){
+        for(GLuint c=0; c<8; ++c){
+            glVertexAttribDivisor(2 + c, 0);
+            glDisableVertexAttribArray(2 + c);
+        }
+        glDeleteBuffers(1, &instanceVbo);
+    }
+    if(indirect) glDeleteBuffers(1, &indirect);
+    return st;
+}
+
+// each grid of pairs through each path, with the draw calls a frame and the triangles a second
+int stress(const std::vector<unsigned int> &grids, unsigned int Na, unsigned int Nb, const std::vector<stressPath> &paths,
+           unsigned int frames, int w, int h, float paDeg)
+{
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const bool bIndirect = major > 4 || (major == 4 && minor >= 3);
+    const GLuint meshProgram = linkProgram(compileShader(GL_VERTEX_SHADER, {vertexShaderSourceNew}),
+                                           compileShader(GL_FRAGMENT_SHADER, {fragmentShaderSourceNew}));
+    const GLuint stressProgram = linkProgram(compileShader(GL_VERTEX_SHADER, {stressVertexShaderSource}),
+                                             compileShader(GL_FRAGMENT_SHADER, {fragmentShaderSourceNew}));
+    for(GLuint program: {meshProgram, stressProgram}){
+        glUseProgram(program);
+        glUniform3f(glGetUniformLocation(program, "lightPos"), 0.0f, 0.0f, 250.0f);
+        glUniform1f(glGetUniformLocation(program, "twist"), 0.0f);
+        glUniform3f(glGetUniformLocation(program, "slice"), 0.0f, -10.0f, 1.0f);
+        glUniform1i(glGetUniformLocation(program, "sliceBase"), 0);
+        glUniform1i(glGetUniformLocation(program, "analytic"), 0);
+    }
+    const gearPair pair = buildGearPair(Na, Nb, paDeg * pi / 180.0f, true);
+    GLuint vao, vbo, ebo;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+
+    const std::size_t pairTriangles = (pair.Nind_a + pair.Nind_b) / 3;
+    std::cout << "stress grid of " << Na << "/" << Nb << " pairs, " << pairTriangles << " triangles a pair";
+    if(!bIndirect) std::cout << ", OpenGL " << major << "." << minor << " has no multi-draw indirect";
+    std::cout << std::endl;
+    std::cout << std::setw(6) << "K" << std::setw(8) << "pairs" << std::setw(11) << "path" << std::setw(8) << "draws";
+    std::cout << std::setw(12) << "triangles" << std::setw(10) << "ms" << std::setw(9) << "fps" << std::setw(11) << "submit ms";
+    std::cout << std::setw(12) << "Mtri/s" << std::setw(16) << "pixels differ" << std::endl;
+    for(unsigned int K: grids){
+        const stressScene scene(K, Na, Nb, paDeg * pi / 180.0f, (float) w / (float) h);
+        std::vector<unsigned char> reference; // the first path's last frame, the others should draw the same
+        for(stressPath path: paths){
+            if(path == stressPath::indirect && !bIndirect) continue;
+            const stressStats st = timeStress(path, scene, pair, vbo, frames, w, h, meshProgram, stressProgram);
+            if(reference.empty()) reference = st.pixels;
+            const std::size_t triangles = pairTriangles * scene.size();
+            std::cout << std::setw(6) << K << std::setw(8) << scene.size() << std::setw(11) << stressPathName[(int) path];
+            std::cout << std::setw(8) << st.draws << std::setw(12) << triangles << std::fixed << std::setprecision(2);
+            std::cout << std::setw(10) << st.ms << std::setw(9) << 1000.0 / st.ms << std::setw(11) << st.submitMs;
+            std::cout << std::setw(12) << 1e-3 * triangles / st.ms << std::setw(15) << percentDiffer(reference, st.pixels) << "%" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// The simulator's pair drawn in P passes a frame, the shaded faces then P - 1
+// wireframes standing in for outline, shadow or picking passes. Resubmitted,
+// every pass runs the mesh shader over every vertex; cached, one pass with the
+// rasteriser off captures its outputs by transform feedback and every pass reads them
+int passes(const std::vector<unsigned int> &teeth, const std::vector<unsigned int> &counts, unsigned int frames,
+           int w, int h, float paDeg)
+{
+    const GLuint program = linkProgram(compileShader(GL_VERTEX_SHADER, {vertexShaderSourceNew}),
+                                       compileShader(GL_FRAGMENT_SHADER, {fragmentShaderSourceNew}), true);
+    glUseProgram(program);
+    glUniform3f(glGetUniformLocation(program, "lightPos"), 0.0f, 0.0f, 250.0f);
+    glUniform1f(glGetUniformLocation(program, "twist"), 0.0f);
+    glUniform3f(glGetUniformLocation(program, "slice"), 0.0f, -10.0f, 1.0f);
+    glUniform1i(glGetUniformLocation(program, "sliceBase"), 0);
+    glUniform1i(glGetUniformLocation(program, "analytic"), 0);
+    const GLint uniMat = glGetUniformLocation(program, "matrix"), uniRot = glGetUniformLocation(program, "rot");
+    const GLint uniColor = glGetUniformLocation(program, "triangleColor"), uniPerspective = glGetUniformLocation(program, "perspective");
+    const GLint uniOutline = glGetUniformLocation(program, "outline"), uniCached = glGetUniformLocation(program, "cached");
+    const GLfloat colours[4][3] = {{0.1f, 0.2f, 0.5f}, {0.184314f, 0.309804f, 0.184314f}, {0.1f, 0.1f, 0.4f}, {0.25f, 0.25f, 0.25f}};
+    const GLsizei stride = 11 * sizeof(GLfloat);
+    GLuint vao, vbo, ebo, feedbackVao, feedbackVbo;
+    glGenVertexArrays(1, &vao);
+    glGenVertexArrays(1, &feedbackVao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glGenBuffers(1, &feedbackVbo);
+    auto vertexBase = [](GLuint base){
+        const GLsizeiptr offset = base * 6 * sizeof(GLfloat);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+    };
+    auto feedbackBase = [stride](GLuint base){
+        const GLsizeiptr offset = (GLsizeiptr) base * stride;
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offset);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 6 * sizeof(GLfloat)));
+        glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(offset + 9 * sizeof(GLfloat)));
+    };
+
+    std::cout << std::setw(6) << "N" << std::setw(12) << "vertices" << std::setw(8) << "passes" << std::setw(14) << "resubmit ms";
+    std::cout << std::setw(14) << "feedback ms" << std::setw(10) << "speedup" << std::setw(13) << "capture MB" << std::setw(16) << "pixels differ" << std::endl;
+    for(unsigned int N: teeth){
+        pairView v(N, N, paDeg * pi / 180.0f, (float) w / (float) h);
+        v.project();
+        const gearPair pair = buildGearPair(N, N, v.pa, true);
+        const GLuint Nverts = (GLuint) (pair.verts.size() / 6), Nverts_b = Nverts - pair.Nverts_a;
+        const GLuint count[4] = {pair.Nind1_a, pair.Nind_a - pair.Nind1_a, pair.Nind1_b, pair.Nind_b - pair.Nind1_b};
+        const GLuint first[4] = {0, pair.Nind1_a, pair.Nind_a, pair.Nind_a + pair.Nind1_b};
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(feedbackVao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        for(GLuint a=2; a<6; ++a) glEnableVertexAttribArray(a);
+        glBindBuffer(GL_ARRAY_BUFFER, feedbackVbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr) Nverts * stride, nullptr, GL_DYNAMIC_COPY);
+        glUniformMatrix4fv(uniPerspective, 1, GL_FALSE, v.proj.m);
+
+        // both gears, from the mesh or from the capture, gear b's vertices follow gear a's in either
+        auto drawPair = [&](bool cached, bool outline){
+            glUniform1i(uniOutline, outline);
+            for(int g=0; g<2; ++g){
+                glUniformMatrix4fv(uniMat, 1, GL_FALSE, g ? v.matrixB.m : v.matrixA.m);
+                glUniformMatrix4fv(uniRot, 1, GL_FALSE, g ? v.rotB.m : v.rotA.m);
+                if(cached) feedbackBase(g ? pair.Nverts_a : 0);
+                else vertexBase(g ? pair.Nverts_a : 0);
+                for(int part=2*g; part<2*g+2; ++part){
+                    if(outline) glUniform3f(uniColor, 0.75f, 0.75f, 0.75f);
+                    else glUniform3fv(uniColor, 1, colours[part]);
+                    glDrawElements(GL_TRIANGLES, count[part], GL_UNSIGNED_INT, (GLvoid*)(first[part] * sizeof(GLuint)));
+                }
+            }
+        };
+        auto frame = [&](unsigned int f, unsigned int P, bool cached){
+            v.at(0.5f * (float) f);
+            glBindVertexArray(vao);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+            if(cached){ // gear a's outputs then gear b's, in one capture
+                glEnable(GL_RASTERIZER_DISCARD);
+                glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackVbo);
+                glBeginTransformFeedback(GL_POINTS);
+                for(int g=0; g<2; ++g){
+                    glUniformMatrix4fv(uniMat, 1, GL_FALSE, g ? v.matrixB.m : v.matrixA.m);
+                    glUniformMatrix4fv(uniRot, 1, GL_FALSE, g ? v.rotB.m : v.rotA.m);
+                    vertexBase(g ? pair.Nverts_a : 0);
+                    glDrawArrays(GL_POINTS, 0, g ? Nverts_b : pair.Nverts_a);
+                }
+                glEndTransformFeedback();
+                glDisable(GL_RASTERIZER_DISCARD);
+                glBindVertexArray(feedbackVao);
+                glBindBuffer(GL_ARRAY_BUFFER, feedbackVbo);
+            }
+            glUniform1i(uniCached, cached);
+            drawPair(cached, false);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+            glEnable(GL_POLYGON_OFFSET_LINE);
+            glPolygonOffset(-1.0f, -1.0f);
+            for(unsigned int p=1; p<P; ++p) drawPair(cached, true);
+            glDisable(GL_POLYGON_OFFSET_LINE);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            glUniform1i(uniCached, 0);
+        };
+        for(unsigned int P: counts){
+            const frameStats plain = timeFrames(frames, w, h, [&](unsigned int f){ frame(f, P, false); });
+            const frameStats cached = timeFrames(frames, w, h, [&](unsigned int f){ frame(f, P, true); });
+            std::cout << std::setw(6) << N << std::setw(12) << Nverts << std::setw(8) << P << std::fixed << std::setprecision(2);
+            std::cout << std::setw(14) << plain.ms << std::setw(14) << cached.ms << std::setw(10) << plain.ms / cached.ms;
+            std::cout << std::setw(13) << 1e-6 * Nverts * stride << std::setw(15) << percentDiffer(plain.pixels, cached.pixels) << "%" << std::endl;
+        }
+    }
+    return 0;
+}
+
+// OGLWidget's two ways of picking a tooth on the simulator's view of each pair.
+// The ray through a pixel's centre is taken into each gear's frame and cast
+// against the gear's bvh, or the pair is drawn with the perspective narrowed to
+// the pixel into a one pixel framebuffer of part and triangle numbers and read back
+int pick(const std::vector<unsigned int> &teeth, unsigned int R, int w, int h, float paDeg)
+{
+    const GLuint program = linkProgram(compileShader(GL_VERTEX_SHADER, {vertexShaderSourceNew}),
+                                       compileShader(GL_FRAGMENT_SHADER, {fragmentShaderSourceNew}));
+    glUseProgram(program);
+    glUniform1f(glGetUniformLocation(program, "twist"), 0.0f);
+    glUniform3f(glGetUniformLocation(program, "slice"), 0.0f, -10.0f, 1.0f);
+    glUniform1i(glGetUniformLocation(program, "sliceBase"), 0);
+    const GLint uniMat = glGetUniformLocation(program, "matrix"), uniPerspective = glGetUniformLocation(program, "perspective");
+    const GLint uniPickPart = glGetUniformLocation(program, "pickPart");
+    GLuint pickFbo, pickRbo[2], vao, vbo, ebo;
+    glGenFramebuffers(1, &pickFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, pickFbo);
+    glGenRenderbuffers(2, pickRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, pickRbo[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RG32UI, 1, 1);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, pickRbo[0]);
+    glBindRenderbuffer(GL_RENDERBUFFER, pickRbo[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, pickRbo[1]);
+    const GLenum buffers[2] = {GL_NONE, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, buffers);
+    glReadBuffer(GL_COLOR_ATTACHMENT1);
+    glViewport(0, 0, 1, 1);
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindVertexArray(vao);
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    auto vertexBase = [](GLuint base){
+        const GLsizeiptr offset = base * 6 * sizeof(GLfloat);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+    };
+    auto map = [](const mat4 &a, const float p[4], float q[3]){ // and divide by w
+        float r[4];
+        for(int i=0; i<4; ++i) r[i] = a.at(i, 0) * p[0] + a.at(i, 1) * p[1] + a.at(i, 2) * p[2] + a.at(i, 3) * p[3];
+        for(int i=0; i<3; ++i) q[i] = r[i] / r[3];
+    };
+    auto median = [](std::vector<double> &t){
+        std::sort(t.begin(), t.end());
+        return t[t.size() / 2];
+    };
+
+    std::cout << std::setw(6) << "N" << std::setw(12) << "triangles" << std::setw(12) << "build ms" << std::setw(10) << "bvh MB";
+    std::cout << std::setw(10) << "ray us" << std::setw(14) << "ID buffer us" << std::setw(8) << "hits" << std::setw(14) << "teeth differ" << std::endl;
+    for(unsigned int N: teeth){
+        pairView v(N, N, paDeg * pi / 180.0f, (float) w / (float) h);
+        v.project();
+        v.at(10.0f);
+        const gearPair pair = buildGearPair(N, N, v.pa, true);
+        const GLuint first[4] = {0, pair.Nind1_a, pair.Nind_a, pair.Nind_a + pair.Nind1_b};
+        const GLuint count[4] = {pair.Nind1_a, pair.Nind_a - pair.Nind1_a, pair.Nind1_b, pair.Nind_b - pair.Nind1_b};
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+
+        const auto t0 = std::chrono::steady_clock::now();
+        const meshBvh bvh[2] = {meshBvh(pair.verts.data(), pair.inds.data(), pair.Nind_a / 3),
+                                meshBvh(pair.verts.data() + 6 * (std::size_t) pair.Nverts_a, pair.inds.data() + pair.Nind_a, pair.Nind_b / 3)};
+        const std::chrono::duration<double, std::milli> build = std::chrono::steady_clock::now() - t0;
+        const mat4 invProj = inversePerspective(v.proj), toGear[2] = {rigidInverse(v.matrixA), rigidInverse(v.matrixB)};
+        const mat4 *model[2] = {&v.matrixA, &v.matrixB};
+
+        std::vector<double> rayUs, idUs;
+        unsigned int hits = 0, differ = 0;
+        for(unsigned int j=0; j<R; ++j){
+            for(unsigned int i=0; i<R; ++i){
+                const int px = (int) ((i + 0.5f) * w / R), py = (int) ((j + 0.5f) * h / R); // y down, as mouse events
+                const float x = 2.0f * ((float) px + 0.5f) / (float) w - 1.0f, y = 1.0f - 2.0f * ((float) py + 0.5f) / (float) h;
+
+                auto t1 = std::chrono::steady_clock::now();
+                int rayGear = -1;
+                unsigned int rayTooth = 0;
+                float tNear = 2.0f;
+                const float ndc[2][4] = {{x, y, -1.0f, 1.0f}, {x, y, 1.0f, 1.0f}};
+                float eye[2][3];
+                for(int e=0; e<2; ++e) map(invProj, ndc[e], eye[e]);
+                for(int g=0; g<2; ++g){
+                    const float p0[4] = {eye[0][0], eye[0][1], eye[0][2], 1.0f}, p1[4] = {eye[1][0], eye[1][1], eye[1][2], 1.0f};
+                    float origin[3], end[3];
+                    map(toGear[g], p0, origin);
+                    map(toGear[g], p1, end);
+                    const float dir[3] = {end[0] - origin[0], end[1] - origin[1], end[2] - origin[2]};
+                    bvhHit hit;
+                    if(!bvh[g].intersect(origin, dir, hit) || hit.t >= tNear) continue;
+                    tNear = hit.t;
+                    rayGear = g;
+                    rayTooth = toothOfTriangle(hit.triangle, N, g ? pair.Nind_b : pair.Nind_a, g ? pair.Nind1_b : pair.Nind1_a);
+                }
+                std::chrono::duration<double, std::micro> dt = std::chrono::steady_clock::now() - t1;
+                rayUs.push_back(dt.count());
+
+                t1 = std::chrono::steady_clock::now();
+                const GLuint background[4] = {0, 0, 0, 0};
+                glClearBufferuiv(GL_COLOR, 1, background);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                mat4 narrow;
+                narrow.at(0, 0) = (float) w;
+                narrow.at(1, 1) = (float) h;
+                narrow.at(0, 3) = -(float) w * x;
+                narrow.at(1, 3) = -(float) h * y;
+                glUniformMatrix4fv(uniPerspective, 1, GL_FALSE, (narrow * v.proj).m);
+                for(int g=0; g<2; ++g){
+                    glUniformMatrix4fv(uniMat, 1, GL_FALSE, model[g]->m);
+                    vertexBase(g ? pair.Nverts_a : 0);
+                    for(int part=2*g; part<2*g+2; ++part){
+                        glUniform1ui(uniPickPart, part + 1);
+                        glDrawElements(GL_TRIANGLES, count[part], GL_UNSIGNED_INT, (GLvoid*)(first[part] * sizeof(GLuint)));
+                    }
+                }
+                GLuint id[2] = {0, 0};
+                glReadPixels(0, 0, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, id);
+                int idGear = -1;
+                unsigned int idTooth = 0;
+                if(id[0]){
+                    idGear = (int) (id[0] - 1) / 2;
+                    const GLuint n1 = idGear ? pair.Nind1_b : pair.Nind1_a, n = idGear ? pair.Nind_b : pair.Nind_a;
+                    idTooth = toothOfTriangle((id[0] - 1) % 2 ? n1 / 3 + id[1] : id[1], N, n, n1);
+                }
+                dt = std::chrono::steady_clock::now() - t1;
+                idUs.push_back(dt.count());
+
+                if(rayGear >= 0) ++hits;
+                if(rayGear != idGear || rayTooth != idTooth) ++differ;
+            }
+        }
+        std::size_t bytes = bvh[0].bytes() + bvh[1].bytes();
+        std::cout << std::setw(6) << N << std::setw(12) << (pair.Nind_a + pair.Nind_b) / 3 << std::fixed << std::setprecision(2);
+        std::cout << std::setw(12) << build.count() << std::setw(10) << 1e-6 * bytes << std::setprecision(1) << std::setw(10) << median(rayUs);
+        std::cout << std::setw(14) << median(idUs) << std::setw(8) << hits << std::setw(14) << differ << std::endl;
+    }
+    return 0;
+}
+
+// The contact pattern of each pair as OGLWidget::accumulateContact() builds it, over
+// one pitch of gear a, reading the counts back once at the end to compare the radii
+// each flank was touched over with the line of action's, from the start of active
+// profile to the tip
+int contact(const std::vector<unsigned int> &teeth, unsigned int frames, float paDeg)
+{
+    const GLuint program = glCreateProgram();
+    glAttachShader(program, compileShader(GL_VERTEX_SHADER, {contactVertexShaderSource}));
+    glAttachShader(program, compileShader(GL_GEOMETRY_SHADER, {contactGeometryShaderSource}));
+    glAttachShader(program, compileShader(GL_FRAGMENT_SHADER, {sdfFragmentHeaderNew, sdfGearFunctions, contactFragmentShaderBody}));
+    glBindFragDataLocation(program, 0, "outColor");
+    glLinkProgram(program);
+    const GLuint maxProgram = linkProgram(compileShader(GL_VERTEX_SHADER, {contactMaxVertexShaderSource}),
+                                          compileShader(GL_FRAGMENT_SHADER, {contactMaxFragmentShaderSource}));
+    const GLsizei cols = 256, rows = 128;
+    GLuint fbo[2], tex[2], vao, emptyVao, vbo, ebo;
+    glGenFramebuffers(2, fbo);
+    glGenTextures(2, tex);
+    for(int t=0; t<2; ++t){
+        glBindTexture(GL_TEXTURE_2D, tex[t]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, t ? 2 : cols, t ? 1 : rows, 0, GL_RED, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[t]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex[t], 0);
+    }
+    glBindTexture(GL_TEXTURE_2D, tex[0]);
+    glUseProgram(maxProgram);
+    glUniform1i(glGetUniformLocation(maxProgram, "heat"), 0);
+    glUseProgram(program);
+    glUniform3f(glGetUniformLocation(program, "slice"), 0.0f, -10.0f, 1.0f);
+    glUniform1f(glGetUniformLocation(program, "twist"), 0.0f);
+    glUniform1f(glGetUniformLocation(program, "contactFace"), 5.0f);
+    const GLint uniToOther = glGetUniformLocation(program, "toOther"), uniShape = glGetUniformLocation(program, "contactShape");
+    const GLint uniOther = glGetUniformLocation(program, "other");
+    glGenVertexArrays(1, &vao);
+    glGenVertexArrays(1, &emptyVao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+    glBindVertexArray(vao);
+    glEnableVertexAttribArray(0);
+    glDisable(GL_DEPTH_TEST);
+
+    std::cout << std::setw(6) << "N" << std::setw(9) << "frames" << std::setw(12) << "ms a frame" << std::setw(6) << "gear";
+    std::cout << std::setw(14) << "lit texels" << std::setw(22) << "touched r, drive" << std::setw(20) << "coast" << std::setw(20) << "line of action" << std::endl;
+    for(unsigned int N: teeth){
+        pairView v(N, N, paDeg * pi / 180.0f, 1.0f);
+        const gearPair pair = buildGearPair(N, N, v.pa, true);
+        const gear ga(N, v.pa, 5.0f, gearBuild::sectors), gb(N, v.pa, 5.0001f, gearBuild::sectors);
+        const gearSdf sdf[2] = {gearSdfShape(ga, -90.0f), gearSdfShape(gb, 90.0f)};
+        float teethU[2][4], flankU[2][4], faceU[2][3];
+        for(int g=0; g<2; ++g) gearSdfUniforms(sdf[g], teethU[g], flankU[g], faceU[g]);
+        glUseProgram(program);
+        glUniform4fv(glGetUniformLocation(program, "teeth"), 2, &teethU[0][0]);
+        glUniform4fv(glGetUniformLocation(program, "flank"), 2, &flankU[0][0]);
+        glUniform3fv(glGetUniformLocation(program, "face"), 2, &faceU[0][0]);
+        glUniform1f(glGetUniformLocation(program, "filletR"), sdf[0].filletR);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+        const GLfloat zero[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[0]);
+        glClearBufferfv(GL_COLOR, 0, zero);
+
+        const float phase = separationPhase(N, N, v.pa, 0.0f), pitchDeg = 360.0f / (float) N;
+        std::vector<double> times;
+        for(unsigned int f=0; f<frames; ++f){
+            v.at(pitchDeg * (float) f / (float) frames, phase);
+            const mat4 toOther[2] = {rigidInverse(v.matrixB) * v.matrixA, rigidInverse(v.matrixA) * v.matrixB};
+            const auto t0 = std::chrono::steady_clock::now();
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo[0]);
+            glUseProgram(program);
+            glBindVertexArray(vao);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            for(int g=0; g<2; ++g){
+                glViewport(0, g * rows / 2, cols, rows / 2);
+                glUniformMatrix4fv(uniToOther, 1, GL_FALSE, toOther[g].m);
+                glUniform4f(uniShape, sdf[g].rmin, sdf[g].rmaj, sdf[g].toothAngle, sdf[g].N);
+                glUniform1i(uniOther, 1 - g);
+                const GLsizeiptr offset = (g ? pair.Nverts_a : 0) * 6 * sizeof(GLfloat);
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+                const GLuint first = g ? pair.Nind_a : 0, n1 = g ? pair.Nind1_b : pair.Nind1_a, n = g ? pair.Nind_b : pair.Nind_a;
+                glDrawElements(GL_TRIANGLES, n - n1, GL_UNSIGNED_INT, (GLvoid*)((first + n1) * sizeof(GLuint)));
+            }
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo[1]);
+            glViewport(0, 0, 2, 1);
+            glClearBufferfv(GL_COLOR, 0, zero);
+            glBlendEquation(GL_MAX);
+            glUseProgram(maxProgram);
+            glBindVertexArray(emptyVao);
+            glDrawArrays(GL_POINTS, 0, cols * rows);
+            glBlendEquation(GL_FUNC_ADD);
+            glDisable(GL_BLEND);
+            glFinish();
+            const std::chrono::duration<double, std::milli> dt = std::chrono::steady_clock::now() - t0;
+            times.push_back(dt.count());
+        }
+        std::sort(times.begin(), times.end());
+
+        std::vector<float> counts((std::size_t) cols * rows), largest(2);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[0]);
+        glReadPixels(0, 0, cols, rows, GL_RED, GL_FLOAT, counts.data());
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo[1]);
+        glReadPixels(0, 0, 2, 1, GL_RED, GL_FLOAT, largest.data());
+        // the line of action runs from where it meets the other gear's tip circle to the tip
+        const float rb = 0.5f * (float) N * std::cos(v.pa), ra = sdf[0].rmaj, C = (float) N;
+        const float start = std::sqrt(rb * rb + std::pow(C * std::sin(v.pa) - std::sqrt(ra * ra - rb * rb), 2.0f));
+        for(int g=0; g<2; ++g){
+            std::size_t lit = 0;
+            float lo[2] = {1e9f, 1e9f}, hi[2] = {0.0f, 0.0f}, total = 0.0f;
+            for(GLsizei y=g*rows/2; y<(g+1)*rows/2; ++y){
+                for(GLsizei x=0; x<cols; ++x){
+                    const float c = counts[(std::size_t) y * cols + x];
+                    if(c <= 0.0f) continue;
+                    ++lit;
+                    total = std::max(total, c);
+                    const int side = 2 * x < cols ? 0 : 1;
+                    const float u = side ? 2.0f * (cols - x - 0.5f) / cols : 2.0f * (x + 0.5f) / cols;
+                    const float r = sdf[g].rmin + u * (sdf[g].rmaj - sdf[g].rmin);
+                    lo[side] = std::min(lo[side], r);
+                    hi[side] = std::max(hi[side], r);
+                }
+            }
+            std::cout << std::setw(6) << N << std::setw(9) << frames << std::fixed << std::setprecision(2) << std::setw(12) << times[times.size() / 2];
+            std::cout << std::setw(6) << (g ? 'b' : 'a') << std::setw(14) << lit;
+            for(int side=0; side<2; ++side){
+                std::ostringstream band;
+                if(hi[side] > 0.0f) band << std::fixed << std::setprecision(2) << lo[side] << " - " << hi[side];
+                else band << "none";
+                std::cout << std::setw(side ? 20 : 22) << band.str();
+            }
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(2) << start << " - " << ra;
+            std::cout << std::setw(20) << line.str();
+            if(total != largest[g]) std::cout << "  GPU max " << largest[g] << " against " << total;
+            std::cout << std::endl;
+        }
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int w = 640, h = 480;
+    unsigned int frames = 10;
+    float paDeg = 20.0f;
+    std::vector<unsigned int> teeth = {8, 32, 128, 200, 400, 800, 1600, 3200};
+    std::vector<unsigned int> grids; // stress scene sizes, none for the sweep
+    std::vector<unsigned int> passCounts; // passes a frame, none for the sweep
+    unsigned int pickGrid = 0; // pixels a side to pick, none for the sweep
+    unsigned int contactFrames = 0; // frames over a pitch, none for the sweep
+    unsigned int Na = 12, Nb = 24;
+    std::vector<stressPath> paths = {stressPath::draw, stressPath::instanced, stressPath::indirect};
+    auto list = [](const char *s){
+        std::vector<unsigned int> v;
+        std::istringstream is(s);
+        std::string n;
+        while(std::getline(is, n, ',')) v.push_back((unsigned int) std::stoul(n));
+        return v;
+    };
+
+    for(int i=1; i<argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--size" && i + 1 < argc){
+            char x;
+            std::istringstream(argv[++i]) >> w >> x >> h;
+        }
+        else if(arg == "--frames" && i + 1 < argc) frames = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--pa" && i + 1 < argc) paDeg = std::stof(argv[++i]);
+        else if(arg == "--teeth" && i + 1 < argc) teeth = list(argv[++i]);
+        else if(arg == "--stress" && i + 1 < argc) grids = list(argv[++i]);
+        else if(arg == "--passes" && i + 1 < argc){
+            passCounts = list(argv[++i]);
+            if(std::find(passCounts.begin(), passCounts.end(), 0u) != passCounts.end()){
+                std::cerr << "--passes wants at least 1 pass" << std::endl;
+                return 1;
+            }
+        }
+        else if(arg == "--pick" && i + 1 < argc) pickGrid = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--contact" && i + 1 < argc) contactFrames = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--pair" && i + 1 < argc){
+            const std::vector<unsigned int> n = list(argv[++i]);
+            if(n.size() != 2 || n[0] < 4 || n[1] < 4){
+                std::cerr << "--pair wants two tooth counts of at least 4" << std::endl;
+                return 1;
+            }
+            Na = n[0];
+            Nb = n[1];
+        }
+        else if(arg == "--path" && i + 1 < argc){
+            const std::string p = argv[++i];
+            if(p == "draw") paths = {stressPath::draw};
+            else if(p == "instanced") paths = {stressPath::instanced};
+            else if(p == "mdi") paths = {stressPath::indirect};
+            else if(p != "all"){
+                std::cerr << "--path is draw, instanced, mdi or all" << std::endl;
+                return 1;
+            }
+        }
+        else{
+            std::cerr << "usage: renderbench [--size WxH] [--frames n] [--teeth list] [--pa degrees]" << std::endl;
+            std::cerr << "       renderbench --stress K[,K...] [--pair Na,Nb] [--path draw|instanced|mdi|all]" << std::endl;
+            std::cerr << "       renderbench --passes P[,P...] [--teeth list]" << std::endl;
+            std::cerr << "       renderbench --pick R [--teeth list]" << std::endl;
+            std::cerr << "       renderbench --contact F [--teeth list]" << std::endl;
+            return 1;
+        }
+    }
+    if(!contextEGL()){
+        std::cerr << "can't make an OpenGL 3.3 context through EGL" << std::endl;
+        return 1;
+    }
+    std::cout << "renderer " << glGetString(GL_RENDERER) << ", " << w << "x" << h << ", median of " << frames << " frames" << std::endl;
+
+    // off screen target
+    GLuint fbo, colour, depth;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenRenderbuffers(1, &colour);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour);
+    glGenRenderbuffers(1, &depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    glViewport(0, 0, w, h);
+    glEnable(GL_DEPTH_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    if(!grids.empty()) return stress(grids, Na, Nb, paths, frames, w, h, paDeg);
+    if(!passCounts.empty()) return passes(teeth, passCounts, frames, w, h, paDeg);
+    if(pickGrid) return pick(teeth, pickGrid, w, h, paDeg);
+    if(contactFrames) return contact(teeth, contactFrames, paDeg);
+
+    const GLuint meshProgram = linkProgram(compileShader(GL_VERTEX_SHADER, {vertexShaderSourceNew}),
+                                           compileShader(GL_FRAGMENT_SHADER, {fragmentShaderSourceNew}));
+    const GLuint sdfProgram = linkProgram(compileShader(GL_VERTEX_SHADER, {sdfVertexShaderSourceNew}),
+                                          compileShader(GL_FRAGMENT_SHADER, {sdfFragmentHeaderNew, sdfGearFunctions, sdfFragmentShaderBody}));
+    GLuint vao, vbo, ebo, sdfVao;
+    glGenVertexArrays(1, &vao);
+    glGenVertexArrays(1, &sdfVao);
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    std::cout << std::setw(6) << "N" << std::setw(12) << "triangles" << std::setw(12) << "mesh ms" << std::setw(12) << "sdf ms";
+    std::cout << std::setw(16) << "pixels differ" << std::endl;
+    unsigned int crossover = 0;
+    for(unsigned int N: teeth){
+        pairView v(N, N, paDeg * pi / 180.0f, (float) w / (float) h);
+        v.project();
+        const gearPair pair = buildGearPair(N, N, v.pa, true);
+
+        // the mesh path, as OGLWidget::paintGL
+        glUseProgram(meshProgram);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, pair.verts.size() * sizeof(GLfloat), pair.verts.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, pair.inds.size() * sizeof(GLuint), pair.inds.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glUniformMatrix4fv(glGetUniformLocation(meshProgram, "perspective"), 1, GL_FALSE, v.proj.m);
+        glUniform3f(glGetUniformLocation(meshProgram, "lightPos"), 0.0f, 0.0f, 250.0f);
+        glUniform1f(glGetUniformLocation(meshProgram, "twist"), 0.0f);
+        glUniform3f(glGetUniformLocation(meshProgram, "slice"), 0.0f, -10.0f, 1.0f);
+        glUniform1i(glGetUniformLocation(meshProgram, "sliceBase"), 0);
+        glUniform1i(glGetUniformLocation(meshProgram, "analytic"), 0);
+        const GLint uniMat = glGetUniformLocation(meshProgram, "matrix"), uniRot = glGetUniformLocation(meshProgram, "rot");
+        const GLint uniColor = glGetUniformLocation(meshProgram, "triangleColor");
+        auto vertexBase = [](GLuint base){
+            const GLsizeiptr offset = base * 6 * sizeof(GLfloat);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)offset);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), (GLvoid*)(offset + 3 * sizeof(GLfloat)));
+        };
+        const frameStats mesh = timeFrames(frames, w, h, [&](unsigned int f){
+            v.at(0.5f * (float) f);
+            vertexBase(0);
+            glUniformMatrix4fv(uniMat, 1, GL_FALSE, v.matrixA.m);
+            glUniformMatrix4fv(uniRot, 1, GL_FALSE, v.rotA.m);
+            glUniform3f(uniColor, 0.1f, 0.2f, 0.5f);
+            glDrawElements(GL_TRIANGLES, pair.Nind1_a, GL_UNSIGNED_INT, (GLvoid*) 0);
+            glUniform3f(uniColor, 0.184314f, 0.309804f, 0.184314f);
+            glDrawElements(GL_TRIANGLES, pair.Nind_a - pair.Nind1_a, GL_UNSIGNED_INT, (GLvoid*)(pair.Nind1_a * sizeof(GLuint)));
+            vertexBase(pair.Nverts_a);
+            glUniformMatrix4fv(uniMat, 1, GL_FALSE, v.matrixB.m);
+            glUniformMatrix4fv(uniRot, 1, GL_FALSE, v.rotB.m);
+            glUniform3f(uniColor, 0.1f, 0.1f, 0.4f);
+            glDrawElements(GL_TRIANGLES, pair.Nind1_b, GL_UNSIGNED_INT, (GLvoid*)(pair.Nind_a * sizeof(GLuint)));
+            glUniform3f(uniColor, 0.25f, 0.25f, 0.25f);
+            glDrawElements(GL_TRIANGLES, pair.Nind_b - pair.Nind1_b, GL_UNSIGNED_INT, (GLvoid*)((pair.Nind_a + pair.Nind1_b) * sizeof(GLuint)));
+        });
+
+        // the raymarched path, the shape is uniforms only
+        const gear ga(N, v.pa, 5.0f, gearBuild::sectors), gb(N, v.pa, 5.0001f, gearBuild::sectors);
+        const gearSdf sdf[2] = {gearSdfShape(ga, -90.0f), gearSdfShape(gb, 90.0f)};
+        glUseProgram(sdfProgram);
+        glBindVertexArray(sdfVao);
+        float teethU[2][4], flankU[2][4], faceU[2][3];
+        for(int g=0; g<2; ++g) gearSdfUniforms(sdf[g], teethU[g], flankU[g], faceU[g]);
+        glUniform4fv(glGetUniformLocation(sdfProgram, "teeth"), 2, &teethU[0][0]);
+        glUniform4fv(glGetUniformLocation(sdfProgram, "flank"), 2, &flankU[0][0]);
+        glUniform3fv(glGetUniformLocation(sdfProgram, "face"), 2, &faceU[0][0]);
+        glUniform1f(glGetUniformLocation(sdfProgram, "filletR"), sdf[0].filletR);
+        const float colours[12] = {0.1f, 0.2f, 0.5f, 0.184314f, 0.309804f, 0.184314f, 0.1f, 0.1f, 0.4f, 0.25f, 0.25f, 0.25f};
+        glUniform3fv(glGetUniformLocation(sdfProgram, "colours"), 4, colours);
+        glUniform3f(glGetUniformLocation(sdfProgram, "lightPos"), 0.0f, 0.0f, 250.0f);
+        glUniformMatrix4fv(glGetUniformLocation(sdfProgram, "perspective"), 1, GL_FALSE, v.proj.m);
+        glUniformMatrix4fv(glGetUniformLocation(sdfProgram, "invPerspective"), 1, GL_FALSE, inversePerspective(v.proj).m);
+        const GLint uniTo = glGetUniformLocation(sdfProgram, "toGear");
+        const frameStats ray = timeFrames(frames, w, h, [&](unsigned int f){
+            v.at(0.5f * (float) f);
+            const mat4 to[2] = {rigidInverse(v.matrixA), rigidInverse(v.matrixB)};
+            glUniformMatrix4fv(uniTo, 2, GL_FALSE, to[0].m);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        });
+
+        std::cout << std::setw(6) << N << std::setw(12) << (pair.Nind_a + pair.Nind_b) / 3 << std::fixed << std::setprecision(2);
+        std::cout << std::setw(12) << mesh.ms << std::setw(12) << ray.ms << std::setw(15) << percentDiffer(mesh.pixels, ray.pixels) << "%" << std::endl;
+        if(!crossover && ray.ms < mesh.ms) crossover = N;
+    }
+    if(crossover) std::cout << "raymarching is quicker from N = " << crossover << std::endl;
+    else std::cout << "the meshes were quicker throughout" << std::endl;
+    return 0;
+}
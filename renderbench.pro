@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Frame times of the mesh and raymarched render paths, and of a grid of
+# pairs drawn per pair, instanced or indirect, no Qt needed,
+# renders off screen through EGL (Mesa, or LIBGL_ALWAYS_SOFTWARE=1 for llvmpipe)
+# qmake renderbench.pro && make, then ./renderbench
+#
+#-------------------------------------------------
+
+unix: QMAKE_CXXFLAGS += -std=c++14
+CONFIG += console release
+CONFIG -= qt app_bundle
+
+TARGET = renderbench
+TEMPLATE = app
+
+LIBS += -lEGL -lOpenGL
+
+SOURCES += renderbench.cpp\
+        gear.cpp\
+        gearpair.cpp\
+        gearsdf.cpp\
+        gearpick.cpp\
+        phasebatch.cpp\
+        trace.cpp
+
+HEADERS  += gear.h\
+        gearpair.h\
+        gearsdf.h\
+        gearpick.h\
+        myshaders.h\
+        phasebatch.h\
+        trace.h
@@ -0,0 +1,73 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include "trace.h"
+
+#ifdef GEAR_TRACE
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+
+namespace {
+
+struct traceEvent
+{
+    const char *name;
+    long long start, duration;
+    unsigned int tid;
+};
+
+// the latest events only, a long session overwrites its oldest
+const std::size_t traceCapacity = 1 << 16;
+std::mutex traceMtx;
+std::vector<traceEvent> traceEvents; // a ring once full, oldest at traceNext
+std::size_t traceNext = 0;
+std::atomic<unsigned int> nextTid{1};
+thread_local const unsigned int tid = nextTid++; // small ids read better than std::thread::id
+
+long long nowMicro()
+{
+    using namespace std::chrono;
+    static const steady_clock::time_point t0 = steady_clock::now();
+    return duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+
+}
+
+traceScope::traceScope(const char *iname) : name(iname), start(nowMicro())
+{
+}
+
+traceScope::~traceScope()
+{
+    const long long end = nowMicro();
+    std::lock_guard<std::mutex> lock(traceMtx);
+    const traceEvent e{name, start, end - start, tid};
+    if(traceEvents.size() < traceCapacity) traceEvents.push_back(e);
+    else traceEvents[traceNext] = e;
+    traceNext = (traceNext + 1) % traceCapacity;
+}
+
+bool traceWrite(const std::string &fileName)
+{
+    std::ofstream fout(fileName);
+    if(!fout) return false;
+
+    std::lock_guard<std::mutex> lock(traceMtx);
+    fout << "{\"traceEvents\":[\n";
+    const std::size_t n = traceEvents.size(), first = n < traceCapacity ? 0 : traceNext;
+    for(std::size_t i=0; i<n; ++i){
+        const traceEvent &e = traceEvents[(first + i) % n];
+        fout << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid;
+        fout << ",\"ts\":" << e.start << ",\"dur\":" << e.duration << "}";
+        fout << (i + 1 < n ? ",\n" : "\n");
+    }
+    fout << "],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(fout);
+}
+
+#endif // GEAR_TRACE
@@ -0,0 +1,45 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+
+// Scoped timing events, written out in the Chrome trace event format
+// (load into chrome://tracing or ui.perfetto.dev).
+// Only compiled in when GEAR_TRACE is defined, qmake CONFIG+=trace,
+// otherwise TRACE_SCOPE expands to nothing. Every scope takes one global
+// lock as it closes, so they're kept to whole gears rather than teeth.
+
+#ifdef GEAR_TRACE
+
+class traceScope
+{
+public:
+    explicit traceScope(const char *iname);
+    ~traceScope();
+    traceScope(const traceScope&) = delete;
+    traceScope& operator=(const traceScope&) = delete;
+private:
+    const char *name; // must be a string literal
+    long long start; // micro seconds
+};
+
+// writes the events recorded so far, the latest 65536 of them, returns false if file can't be written
+bool traceWrite(const std::string &fileName);
+
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+#define TRACE_SCOPE(name) traceScope TRACE_CAT(traceScope_, __LINE__)(name)
+
+#else
+
+inline bool traceWrite(const std::string &) { return false; }
+
+#define TRACE_SCOPE(name)
+
+#endif // GEAR_TRACE
+
+#endif // TRACE_H
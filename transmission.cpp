@@ -0,0 +1,194 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <chrono>
+#include <complex>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "gear.h"
+#include "interference.h"
+#include "transmission.h"
+#include "trace.h"
+
+namespace {
+
+const float pi = 3.1415926535897932f;
+const unsigned int backlashSteps = 8; // positions over the pitch for the backlash table
+
+// a pair of outlines at one centre distance, and where they sit at rest
+struct meshGeometry
+{
+    meshGeometry(const gearOutline &ia, const gearOutline &ib, float iC) : oa(ia), ob(ib), C(iC),
+        ratio((float) ia.GetN() / (float) ib.GetN())
+    {
+        restingPhase(oa, ob, baseA, baseB);
+    }
+    // Smallest turn of b, back against a's drive for sign 1 or ahead of it for -1,
+    // from the ideal ratio until the profiles touch. Polylines first touch where a
+    // vertex of one meets an edge of the other, and as b turns its own points move
+    // on circles about its centre, so each vertex gives its answer directly.
+    bool turn(float phi, float sign, float limit, float &delta) const
+    {
+        const float rotA = baseA + phi, rotB = baseB - phi * ratio;
+        const float ca = std::cos(rotA), sa = std::sin(rotA), cb = std::cos(rotB), sb = std::sin(rotB);
+        const unsigned int perA = oa.GetToothNpts(), perB = ob.GetToothNpts();
+        const std::vector<float> &xa = oa.GetX(), &ya = oa.GetY(), &xb = ob.GetX(), &yb = ob.GetY();
+        const float rbMin = ob.GetRmin(), rbMax = ob.GetRmax(), raMin = oa.GetRmin(), raMax = oa.GetRmax();
+        // turning b back only closes the gap on the anticlockwise side of a's teeth and b's,
+        // the second half of each tooth's outline, turning it ahead closes the first
+        const unsigned int half = sign > 0.0f ? perA / 2 : 0;
+        bool bFound = false;
+        float d;
+        int first, last;
+
+        // a's vertices, b's outline turns to them
+        oa.facingTeeth(rotA, rbMax, C, first, last);
+        for(int n=first; n<=last; ++n){
+            const unsigned int tooth = wrapTooth(n, oa.GetN());
+            for(unsigned int i=tooth*perA+half; i<tooth*perA+half+perA/2; ++i){
+                const float wx = ca * xa[i] - sa * ya[i] - C, wy = sa * xa[i] + ca * ya[i];
+                const float r2 = wx * wx + wy * wy;
+                if(r2 > rbMax * rbMax || r2 < rbMin * rbMin) continue;
+                const float theta = std::atan2(wy, wx) - rotB;
+                if(ob.turnToPoint(std::sqrt(r2), theta, sign, limit, d) && (!bFound || d < delta)){
+                    delta = d;
+                    bFound = true;
+                }
+            }
+        }
+        // b's vertices swing about b's centre onto a's outline, worked in a's frame
+        const float cx = ca * C, cy = -sa * C;
+        ob.facingTeeth(rotB - pi, raMax, C, first, last);
+        for(int n=first; n<=last; ++n){
+            const unsigned int tooth = wrapTooth(n, ob.GetN());
+            for(unsigned int i=tooth*perB+half; i<tooth*perB+half+perB/2; ++i){
+                const float wx = cb * xb[i] - sb * yb[i] + C, wy = sb * xb[i] + cb * yb[i];
+                const float r2 = wx * wx + wy * wy;
+                if(r2 > raMax * raMax || r2 < raMin * raMin) continue;
+                const float r = std::hypot(xb[i], yb[i]);
+                const float psi = std::atan2(yb[i], xb[i]) + rotB - rotA;
+                if(oa.turnPointTo(cx, cy, r, psi, sign, limit, d) && (!bFound || d < delta)){
+                    delta = d;
+                    bFound = true;
+                }
+            }
+        }
+        return bFound;
+    }
+    static unsigned int wrapTooth(int n, unsigned int N)
+    {
+        return static_cast<unsigned int>((n % (int) N + (int) N) % (int) N);
+    }
+    const gearOutline &oa, &ob;
+    const float C, ratio;
+    float baseA, baseB;
+};
+
+}
+
+transmissionReport sweepTransmission(gear &a, gear &b, const transmissionOptions &opt)
+{
+    TRACE_SCOPE("sweepTransmission");
+    const auto t0 = std::chrono::steady_clock::now();
+    transmissionReport r;
+    const gearOutline oa(a), ob(b);
+    const float Na = (float) a.GetN(), Nb = (float) b.GetN();
+    const float C0 = 0.5f * (Na + Nb);
+    const float pitchA = 2.0f * pi / Na, limit = pi / Nb, rpB = 0.5f * Nb;
+    const meshGeometry mesh(oa, ob, C0 + opt.separation);
+
+    r.samples = std::max(1u, opt.samples);
+    r.threads = opt.threads ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+    r.threads = std::min(r.threads, r.samples);
+    if(outlineOverlap(oa, mesh.baseA, ob, mesh.baseB, mesh.C) > 0.0f){
+        r.bJammed = true;
+        return r;
+    }
+
+    // samples are independent, each thread takes a run of them
+    r.te.resize(r.samples);
+    auto worker = [&](unsigned int first, unsigned int last){
+        for(unsigned int i=first; i<last; ++i){
+            float delta = limit;
+            mesh.turn(pitchA * (float) i / (float) r.samples, 1.0f, limit, delta);
+            r.te[i] = delta * rpB;
+        }
+    };
+    const auto tSolve = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    const unsigned int chunk = (r.samples + r.threads - 1) / r.threads;
+    for(unsigned int t=1; t<r.threads; ++t){
+        pool.emplace_back(worker, std::min(r.samples, t * chunk), std::min(r.samples, (t + 1) * chunk));
+    }
+    worker(0, std::min(r.samples, chunk));
+    for(auto &t: pool) t.join();
+    const double solveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tSolve).count();
+    r.samplesPerSecond = r.samples / std::max(1.0e-9, solveMs * 1.0e-3);
+
+    const auto mm = std::minmax_element(r.te.begin(), r.te.end());
+    r.teMin = *mm.first;
+    r.teMax = *mm.second;
+
+    // the samples cover exactly one mesh period, so its harmonics are plain DFT bins,
+    // the twiddles for every harmonic come from powers of the first
+    std::vector<std::complex<double>> X(opt.harmonics);
+    for(unsigned int i=0; i<r.samples; ++i){
+        const double theta = -2.0 * 3.14159265358979323846 * i / r.samples;
+        const std::complex<double> w1(std::cos(theta), std::sin(theta));
+        std::complex<double> w = w1;
+        for(auto &x: X){
+            x += (double) r.te[i] * w;
+            w *= w1;
+        }
+    }
+    for(const auto &x: X) r.harmonics.push_back(static_cast<float>(2.0 * std::abs(x) / r.samples));
+
+    // contact ratio, length of the path of contact over the base pitch
+    const float rbA = 0.5f * Na * std::cos(a.GetPa()), rbB = 0.5f * Nb * std::cos(b.GetPa());
+    const float raA = oa.GetRmax(), raB = ob.GetRmax(), C = mesh.C;
+    const float cosw = std::min(1.0f, (rbA + rbB) / C);
+    const float path = std::sqrt(std::max(0.0f, raA * raA - rbA * rbA)) + std::sqrt(std::max(0.0f, raB * raB - rbB * rbB))
+                       - C * std::sqrt(1.0f - cosw * cosw);
+    r.contactRatio = path / (pi * std::cos(a.GetPa()));
+
+    // backlash, b rocked between a's two flanks, the tightest place over the pitch
+    for(float offset: opt.offsets){
+        const meshGeometry m(oa, ob, C0 + offset);
+        float least = 2.0f * limit;
+        for(unsigned int k=0; k<backlashSteps; ++k){
+            const float phi = pitchA * (float) k / (float) backlashSteps;
+            float back = limit, ahead = limit;
+            if(outlineOverlap(oa, m.baseA + phi, ob, m.baseB - phi * m.ratio, m.C) > 0.0f){
+                least = 0.0f;
+                break;
+            }
+            m.turn(phi, 1.0f, limit, back);
+            m.turn(phi, -1.0f, limit, ahead);
+            least = std::min(least, back + ahead);
+        }
+        r.backlash.push_back({offset, least * rpB});
+    }
+    r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
+
+std::string transmissionDetail(const transmissionReport &r)
+{
+    std::ostringstream os;
+    if(r.bJammed) return "the profiles overlap at rest, increase the separation";
+    os << std::setprecision(4);
+    os << "transmission error " << r.teMax - r.teMin << " modules peak to peak (" << r.teMin << " to " << r.teMax << ")\n";
+    os << "contact ratio " << r.contactRatio << '\n';
+    os << "mesh harmonics:";
+    for(std::size_t k=0; k<r.harmonics.size(); ++k) os << (k % 8 ? " " : "\n  ") << r.harmonics[k];
+    os << "\nbacklash against centre distance offset:";
+    for(const auto &b: r.backlash) os << "\n  " << std::setw(6) << b.first << "  " << b.second;
+    os << std::fixed << std::setprecision(0) << '\n' << r.samples << " samples on " << r.threads << " threads, ";
+    os << r.samplesPerSecond << " samples/s, " << std::setprecision(1) << r.ms << " ms";
+    return os.str();
+}
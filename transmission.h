@@ -0,0 +1,42 @@
+// OpenGL Involute gear simulation
+// Stephen R Williams, Feb 2019
+// License: GPL V3
+
+#ifndef TRANSMISSION_H
+#define TRANSMISSION_H
+
+#include <vector>
+#include <utility>
+#include <string>
+
+class gear;
+
+struct transmissionOptions
+{
+    unsigned int samples = 4096; // positions of gear a over one pitch
+    unsigned int harmonics = 16; // of the tooth mesh frequency
+    unsigned int threads = 0; // 0 uses every core
+    float separation = 0.0f; // centre distance beyond the standard one
+    std::vector<float> offsets = {-0.1f, -0.05f, 0.0f, 0.05f, 0.1f, 0.2f, 0.3f, 0.5f}; // for the backlash table
+};
+
+// Gear a drives gear b anticlockwise through one pitch. Gear b is held back
+// against a's driving flanks, so its true angle is where the profiles touch.
+// Lengths are in modules.
+struct transmissionReport
+{
+    unsigned int samples = 0, threads = 0;
+    std::vector<float> te; // b's lag behind the ideal ratio at each sample, arc at b's pitch circle
+    float teMin = 0.0f, teMax = 0.0f; // peak to peak is the transmission error
+    std::vector<float> harmonics; // amplitude of each multiple of the tooth mesh frequency, from the first
+    float contactRatio = 0.0f; // from the generated tip radii and the working pressure angle
+    std::vector<std::pair<float, float>> backlash; // centre distance offset, smallest backlash over the pitch
+    bool bJammed = false; // the profiles overlap with no load, nothing to measure
+    double ms = 0.0, samplesPerSecond = 0.0;
+};
+
+transmissionReport sweepTransmission(gear &a, gear &b, const transmissionOptions &opt = transmissionOptions());
+
+std::string transmissionDetail(const transmissionReport &r);
+
+#endif // TRANSMISSION_H
@@ -1,6 +1,15 @@
+#include <vector>
+#include <iostream>
+#include <QFileDialog>
+#include <QLabel>
 #include "widget.h"
 #include "ui_widget.h"
 #include "scroller.h"
+#include "gear.h"
+#include "gearexport.h"
+#include "precompute.h"
+#include "interference.h"
+#include "trace.h"
 
 Widget::Widget(Scroller *iparent) :
     QWidget(iparent), ui(new Ui::Widget)
@@ -12,7 +21,18 @@ Widget::Widget(Scroller *iparent) :
     connect(timer.get(), SIGNAL(timeout()), this, SLOT(drawOpenGL()));
     connect(parent, SIGNAL(fullScreenExited()), this, SLOT(standardScreen()));
     connect(parent, SIGNAL(keyPressed(int)), this, SLOT(keySwitcher(int)));
-    timer->start(25); // delay in milli seconds
+    timer->start(tickMs); // delay in milli seconds
+    idleTimer = std::make_unique<QTimer>(this);
+    idleTimer->setSingleShot(true);
+    idleTimer->setInterval(400); // quiet time before guessing the next rebuild
+    connect(idleTimer.get(), SIGNAL(timeout()), this, SLOT(speculate()));
+    statsTimer = std::make_unique<QTimer>(this);
+    statsTimer->setInterval(1000);
+    connect(statsTimer.get(), SIGNAL(timeout()), this, SLOT(showFrameStats()));
+    precomputer = std::make_unique<Precomputer>(ui->myOGLWidget->getCache());
+    const int budgetMB = qEnvironmentVariableIntValue("GEAR_MEMORY_BUDGET"); // unset, 0 or negative is unlimited
+    memoryBudget = budgetMB > 0 ? (std::size_t) budgetMB * 1024 * 1024 : 0;
+    if(memoryBudget) ui->myOGLWidget->getCache().setByteLimit(memoryBudget / 4); // the cache's share
     ui->radioButton_14->setEnabled(false);
     ui->radioButton_20->setEnabled(false);
     ui->radioButton_25->setEnabled(false);
@@ -31,13 +51,15 @@ Widget::Widget(Scroller *iparent) :
     ui->toggleLabel->setAlignment(Qt::AlignHCenter);
     ui->toggleLabel->setTextFormat(Qt::RichText);
     ui->toggleLabel->setText("<span style='font-size:10.5pt; font-weight:600;'>Exact Involute</span>");
-    ui->toggleButton->setEnabled(false);
     wMax = QDesktopWidget().screenGeometry().size().width(); // get and store screen size
     hMax = QDesktopWidget().screenGeometry().size().height();
+    checkInterference();
 }
 
 Widget::~Widget()
 {
+    if(!recordFile.empty() && !inputLog.save(recordFile)) std::cerr << "failed writing event log " << recordFile << std::endl;
+    precomputer.reset(); // uses the cache owned by myOGLWidget
     delete ui;
 }
 
@@ -47,6 +69,183 @@ void Widget::speedChange(int ds)
     ui->speedScrollBar->setValue(speed);
 }
 
+// write both gears of the pair on screen, name.stl becomes name_Na.stl and name_Nb.stl,
+// just the one file for a spur pair of equal gears, name_Na_a.stl and name_Na_b.stl helical
+void Widget::exportGears()
+{
+    QString name = QFileDialog::getSaveFileName(this, "Export Gears", "gear.stl", "Meshes (*.stl *.obj *.ply)");
+    if(name.isEmpty()) return;
+    std::string fileName = name.toStdString();
+    meshFormat fmt;
+    if(!formatFromName(fileName, fmt)){
+        QMessageBox::warning(this, "Export Gears", "Please use a .stl, .obj or .ply file name");
+        return;
+    }
+    const pairKey shown = ui->myOGLWidget->getShownPair();
+    const std::size_t dot = fileName.rfind('.');
+    const float helix = helixDeg * M_PI / 180.0f;
+    const bool bSame = shown.Na == shown.Nb;
+    for(unsigned int role=0; role<2; ++role){
+        if(role && bSame && helix == 0.0f) break;
+        const unsigned int N = role ? shown.Nb : shown.Na;
+        const std::string hand = bSame && helix != 0.0f ? (role ? "_b" : "_a") : "";
+        const std::string out = fileName.substr(0, dot) + "_" + std::to_string(N) + hand + fileName.substr(dot);
+        bool bOk;
+        if(helix != 0.0f) bOk = exportHelical(N, shown.pa, shown.bExact, 5.0f, role ? -helix : helix, 0, fmt, out); // b is the opposite hand
+        else{
+            std::unique_ptr<gear> g;
+            if(shown.bExact) g = std::make_unique<gear>(N, shown.pa, 5.0f);
+            else g = std::make_unique<gearApprox>(N, shown.pa, 5.0f);
+            bOk = exportGear(*g, fmt, out);
+        }
+        if(!bOk){
+            QMessageBox::warning(this, "Export Gears", QString::fromStdString("Failed writing " + out));
+            return;
+        }
+    }
+}
+
+// D shows the frame scheduler's counts over the top left of the gears
+void Widget::toggleFrameStats()
+{
+    if(!statsLabel){
+        statsLabel = std::make_unique<QLabel>(ui->myOGLWidget);
+        statsLabel->setStyleSheet("QLabel { color: white; background-color: rgba(0, 0, 0, 128); padding: 4px; }");
+        statsLabel->move(8, 8);
+    }
+    if(statsTimer->isActive()){
+        statsTimer->stop();
+        statsLabel->hide();
+        return;
+    }
+    lastCounts = ui->myOGLWidget->getFrameCounts();
+    showFrameStats();
+    statsLabel->show();
+    statsTimer->start();
+}
+
+// frames painted in the last second, and every request so far and what became of it
+void Widget::showFrameStats()
+{
+    const frameCounts &c = ui->myOGLWidget->getFrameCounts();
+    const double MB = 1.0 / (1024.0 * 1024.0);
+    QString text = QString("%1 fps\n%2 requests, %3 painted\n%4 avoided, %5 merged, %6 hidden")
+            .arg(c.painted - lastCounts.painted).arg(c.requested).arg(c.painted)
+            .arg(c.avoided()).arg(c.merged).arg(c.hidden);
+    text += QString("\nmesh cache %1 MB, last build peak %2 MB\nGPU buffers %3 MB, pick bvhs %4 MB")
+            .arg(ui->myOGLWidget->getCache().bytes() * MB, 0, 'f', 2).arg(ui->myOGLWidget->getPeakBytes() * MB, 0, 'f', 2)
+            .arg(ui->myOGLWidget->getGpuBytes() * MB, 0, 'f', 2).arg(ui->myOGLWidget->getPickBytes() * MB, 0, 'f', 2);
+    if(memoryBudget) text += QString(", budget %1 MB").arg(memoryBudget * MB, 0, 'f', 0);
+    if(!budgetNote.isEmpty()) text += "\n" + budgetNote;
+    statsLabel->setText(text);
+    statsLabel->adjustSize();
+    lastCounts = c;
+}
+
+// a rebuild of the pair at detail, with both profiles on the GPU and their pick bvhs,
+// against GEAR_MEMORY_BUDGET less what's held besides, see budgetHeld(); over it detail
+// goes coarse, or if even that's too big it's refused
+bool Widget::withinBudget(unsigned int na, unsigned int nb, gearDetail &detail)
+{
+    const gearDetail wanted = detail;
+    const std::size_t held = budgetHeld(na, nb, detail);
+    const double MB = 1.0 / (1024.0 * 1024.0);
+    if(!fitMemoryBudget(na, nb, memoryBudget, 2, detail, held)){
+        const pairMemory m = estimatePairMemory(na, nb, gearDetail::coarse);
+        QMessageBox::warning(this, "Memory Budget", QString("%1 and %2 teeth need %3 MB even as coarse meshes, over the budget of %4 MB")
+                             .arg(na).arg(nb).arg((m.total(2) + held) * MB, 0, 'f', 1).arg(memoryBudget * MB, 0, 'f', 0));
+        return false;
+    }
+    if(detail != wanted)
+        budgetNote = QString("coarse meshes, fine would need %1 MB").arg((estimatePairMemory(na, nb, wanted).total(2) + held) * MB, 0, 'f', 1);
+    else budgetNote.clear();
+    return true;
+}
+
+// the mesh cache's share of the budget, which it's trimmed to, and a speculative
+// build of a neighbouring pair that may still be finishing when a rebuild starts
+std::size_t Widget::budgetHeld(unsigned int na, unsigned int nb, gearDetail detail) const
+{
+    if(!memoryBudget) return 0;
+    return memoryBudget / 4 + estimatePairMemory(na, nb, detail).peak;
+}
+
+void Widget::recordAction(widgetAction action, double value)
+{
+    if(!bInKey) inputLog.add('w', (int) action, 0, 0, 0, value);
+}
+
+// mouse, keys and the controls are logged from now, and saved to fileName on exit
+void Widget::record(const std::string &fileName)
+{
+    recordFile = fileName;
+    inputLog.startRecording();
+    ui->myOGLWidget->setEventLog(&inputLog);
+}
+
+// drives the logged session against a virtual clock, a tick of the animation timer
+// a frame, painting each frame at once and timing it, then prints the times and quits
+bool Widget::replay(const std::string &fileName, const std::string &timingsName)
+{
+    if(!inputLog.load(fileName)) return false;
+    timingsFile = timingsName;
+    timer->stop();
+    replayTimer = std::make_unique<QTimer>(this);
+    replayTimer->setSingleShot(true);
+    connect(replayTimer.get(), SIGNAL(timeout()), this, SLOT(replayStep()));
+    replayTimer->start(0);
+    return true;
+}
+
+void Widget::replayStep()
+{
+    if(!ui->myOGLWidget->isValid()){ // not initialised until it's first shown
+        replayTimer->start(20);
+        return;
+    }
+    virtualMs += tickMs;
+    inputEvent e;
+    while(inputLog.next(virtualMs, e)){
+        switch(e.kind){
+        case 'p': ui->myOGLWidget->mousePress(QPoint(e.a, e.b), Qt::MouseButtons(e.c), Qt::KeyboardModifiers(e.d)); break;
+        case 'm': ui->myOGLWidget->mouseMove(QPoint(e.a, e.b), Qt::MouseButtons(e.c), Qt::KeyboardModifiers(e.d)); break;
+        case 'k': keySwitcher(e.a); break;
+        case 'w': replayAction((widgetAction) e.a, e.value); break;
+        }
+    }
+    if(!bPause) ui->myOGLWidget->incRotate();
+    replayMs.push_back(ui->myOGLWidget->paintTimed());
+    if(!inputLog.finished()){
+        replayTimer->start(0);
+        return;
+    }
+    std::cout << frameTimeSummary(replayMs) << std::endl;
+    if(!timingsFile.empty() && !writeFrameTimes(timingsFile, replayMs, tickMs))
+        std::cerr << "failed writing frame times " << timingsFile << std::endl;
+    parent->close();
+}
+
+// as the user did it, the control set then its slot
+void Widget::replayAction(widgetAction action, double value)
+{
+    switch(action){
+    case widgetAction::pausePlay: on_pausePlayButton_clicked(); break;
+    case widgetAction::pa14: ui->radioButton_14->setChecked(true); on_radioButton_14_clicked(); break;
+    case widgetAction::pa20: ui->radioButton_20->setChecked(true); on_radioButton_20_clicked(); break;
+    case widgetAction::pa25: ui->radioButton_25->setChecked(true); on_radioButton_25_clicked(); break;
+    case widgetAction::teethA: ui->spinBox_Na->setValue((int) value); on_spinBox_Na_editingFinished(); break;
+    case widgetAction::teethB: ui->spinBox_Nb->setValue((int) value); on_spinBox_Nb_editingFinished(); break;
+    case widgetAction::speed: ui->speedScrollBar->setValue((int) value); break; // its slot follows the signal
+    case widgetAction::lightX: ui->lightPosX->setValue((int) value); on_lightPosX_editingFinished(); break;
+    case widgetAction::lightY: ui->lightPosY->setValue((int) value); on_lightPosY_editingFinished(); break;
+    case widgetAction::lightZ: ui->lightPosZ->setValue((int) value); on_lightPosZ_editingFinished(); break;
+    case widgetAction::separation: ui->SeperationSpinBox->setValue(value); break;
+    case widgetAction::reset: on_resetButton_clicked(); break;
+    case widgetAction::toggle: on_toggleButton_clicked(); break;
+    case widgetAction::fullScreen: on_fullScreenButton_clicked(); break;
+    }
+}
+
 void Widget::on_quitButton_clicked()
 {
     parent->close();
@@ -56,6 +255,11 @@ void Widget::on_quitButton_clicked()
 // also called by scroller oject's KeyPressEvent via key & slot
 void Widget::keySwitcher(int key)
 {
+    // not the keys that open dialogs, write files or quit, they'd stop a replay
+    const bool bReplayable = key != Qt::Key_A && key != Qt::Key_E && key != Qt::Key_I && key != Qt::Key_W
+                             && key != Qt::Key_Q && key != Qt::Key_Escape;
+    if(bReplayable) inputLog.add('k', key);
+    bInKey = true; // the slots a key calls aren't recorded as well
     switch(key)
     {
     case Qt::Key_Escape:
@@ -65,13 +269,45 @@ void Widget::keySwitcher(int key)
     case Qt::Key_A:
         on_aboutButton_clicked();
         break;
+    case Qt::Key_C:
+        if(!ui->myOGLWidget->hasFeedback()) break;
+        bFeedback = !bFeedback;
+        ui->myOGLWidget->setFeedback(bFeedback);
+        break;
+    case Qt::Key_D:
+        toggleFrameStats();
+        break;
+    case Qt::Key_E:
+        exportGears();
+        break;
     case Qt::Key_F:
         if(bFullScreen) parent->showNormal();
         else on_fullScreenButton_clicked();
         break;
+    case Qt::Key_G:
+        if(!ui->myOGLWidget->hasContact()) break;
+        bContact = !bContact;
+        ui->myOGLWidget->setContact(bContact);
+        break;
+    case Qt::Key_H:
+        helixDeg = helixDeg >= 45.0f ? 0.0f : helixDeg + 15.0f;
+        ui->myOGLWidget->setHelix(helixDeg * M_PI / 180.0f);
+        break;
     case Qt::Key_I:
         on_instructionsButton_clicked();
         break;
+    case Qt::Key_N:
+        if(bAnalytic){ // back to fine only if the budget has room for it
+            gearDetail detail = gearDetail::fine;
+            if(!withinBudget(Na, Nb, detail) || detail != gearDetail::fine) break;
+        }
+        bAnalytic = !bAnalytic;
+        ui->myOGLWidget->setAnalytic(bAnalytic);
+        break;
+    case Qt::Key_O:
+        bOutline = !bOutline;
+        ui->myOGLWidget->setOutline(bOutline);
+        break;
     case Qt::Key_P:
     case Qt::Key_Pause:
         on_pausePlayButton_clicked();
@@ -82,9 +318,16 @@ void Widget::keySwitcher(int key)
     case Qt::Key_R:
         on_resetButton_clicked();
         break;
+    case Qt::Key_S:
+        bRaymarch = !bRaymarch;
+        ui->myOGLWidget->setRaymarch(bRaymarch);
+        break;
     case Qt::Key_T:
         on_toggleButton_clicked();
         break;
+    case Qt::Key_W: // only does anything in a CONFIG+=trace build
+        traceWrite("gear_trace.json");
+        break;
     case Qt::Key_Plus:
     case Qt::Key_Right:
         speedChange(1);
@@ -94,6 +337,7 @@ void Widget::keySwitcher(int key)
         speedChange(-1);
         break;
     }
+    bInKey = false;
 }
 
 void Widget::keyPressEvent(QKeyEvent *event)
@@ -103,12 +347,21 @@ void Widget::keyPressEvent(QKeyEvent *event)
 
 void Widget::on_resetButton_clicked()
 {
+    recordAction(widgetAction::reset);
     ui->myOGLWidget->reset();
 }
 
 void Widget::on_pausePlayButton_clicked()
 {
+    recordAction(widgetAction::pausePlay);
+    userActivity();
     if(bPause && rebuildGears){
+        gearDetail detail = bAnalytic ? gearDetail::coarse : gearDetail::fine;
+        if(!withinBudget(ui->spinBox_Na->value(), ui->spinBox_Nb->value(), detail)) return;
+        if(detail == gearDetail::coarse && !bAnalytic){
+            bAnalytic = true;
+            ui->myOGLWidget->setAnalytic(true);
+        }
         Na = ui->spinBox_Na->value();
         ui->myOGLWidget->setNa(Na);
         float speed = (float) ui->speedScrollBar->value() * 0.25f;
@@ -118,7 +371,7 @@ void Widget::on_pausePlayButton_clicked()
         if(Nchange) ui->myOGLWidget->reZeroThetas();
         ui->pausePlayButton->setText("&Play");
         ui->myOGLWidget->rebuild();
-        ui->myOGLWidget->update();
+        ui->myOGLWidget->requestFrame(dirtyScene);
         rebuildGears = false;
         Nchange = false;
     }
@@ -130,8 +383,8 @@ void Widget::on_pausePlayButton_clicked()
         ui->radioButton_25->setEnabled(false);
         ui->spinBox_Na->setEnabled(false);
         ui->spinBox_Nb->setEnabled(false);
-        ui->toggleButton->setEnabled(false);
         bPause = false;
+        idleTimer->stop();
     }
     else{ // pause simulation
         ui->pausePlayButton->setText("&Play");
@@ -141,37 +394,48 @@ void Widget::on_pausePlayButton_clicked()
         ui->radioButton_25->setEnabled(true);
         ui->spinBox_Na->setEnabled(true);
         ui->spinBox_Nb->setEnabled(true);
-        ui->toggleButton->setEnabled(true);
         bPause = true;
+        idleTimer->start();
     }
 }
 
 void Widget::on_radioButton_14_clicked()
 {
+    recordAction(widgetAction::pa14);
+    userActivity();
     pa = 14.5f * M_PI / 180.0f;
     ui->myOGLWidget->setPa(pa);
+    checkInterference();
     rebuildGears = true;
     ui->pausePlayButton->setText("Rebuild");
 }
 
 void Widget::on_radioButton_20_clicked()
 {
+    recordAction(widgetAction::pa20);
+    userActivity();
     pa = 20.0f * M_PI / 180.0f;
     ui->myOGLWidget->setPa(pa);
+    checkInterference();
     rebuildGears = true;
     ui->pausePlayButton->setText("Rebuild");
 }
 
 void Widget::on_radioButton_25_clicked()
 {
+    recordAction(widgetAction::pa25);
+    userActivity();
     pa = 25.0f * M_PI / 180.0f;
     ui->myOGLWidget->setPa(pa);
+    checkInterference();
     rebuildGears = true;
     ui->pausePlayButton->setText("Rebuild");
 }
 
 void Widget::on_spinBox_Na_editingFinished()
 {
+    recordAction(widgetAction::teethA, ui->spinBox_Na->value());
+    userActivity();
     unsigned int N = ui->spinBox_Na->value();
     if(N != Na){
         rebuildGears = true;
@@ -182,6 +446,8 @@ void Widget::on_spinBox_Na_editingFinished()
 
 void Widget::on_spinBox_Nb_editingFinished()
 {
+    recordAction(widgetAction::teethB, ui->spinBox_Nb->value());
+    userActivity();
     unsigned int N = ui->spinBox_Nb->value();
     if(N != Nb){
         rebuildGears = true;
@@ -190,43 +456,118 @@ void Widget::on_spinBox_Nb_editingFinished()
     }
 }
 
+void Widget::on_spinBox_Na_valueChanged(int)
+{
+    userActivity();
+    checkInterference();
+}
+
+void Widget::on_spinBox_Nb_valueChanged(int)
+{
+    userActivity();
+    checkInterference();
+}
+
+// any input stops the speculative builds, they restart once the user goes quiet
+void Widget::userActivity()
+{
+    precomputer->cancel();
+    if(bPause) idleTimer->start();
+}
+
+// rerun the profile overlap sweep for whatever is in the spin boxes,
+// only the tooth templates are built so it's quick enough for every change
+void Widget::checkInterference()
+{
+    TRACE_SCOPE("Widget::checkInterference");
+    const unsigned int na = ui->spinBox_Na->value();
+    const unsigned int nb = ui->spinBox_Nb->value();
+    std::unique_ptr<gear> ga, gb;
+
+    if(bExact){
+        ga = std::make_unique<gear>(na, pa, 5.0f, gearBuild::sectors);
+        gb = std::make_unique<gear>(nb, pa, 5.0f, gearBuild::sectors);
+    }
+    else{
+        ga = std::make_unique<gearApprox>(na, pa, 5.0f, gearBuild::sectors);
+        gb = std::make_unique<gearApprox>(nb, pa, 5.0f, gearBuild::sectors);
+    }
+    const interferenceReport r = findInterference(*ga, *gb, 240, (float) ui->SeperationSpinBox->value());
+    ui->interferenceLabel->setText(QString::fromStdString(interferenceSummary(r)));
+    ui->interferenceLabel->setToolTip(QString::fromStdString(interferenceDetail(r)));
+}
+
+// queue the likely next rebuilds: the other profile, neighbouring tooth counts and
+// the other pressure angles, around whatever is currently in the spin boxes
+void Widget::speculate()
+{
+    if(!bPause) return;
+    const unsigned int na = ui->spinBox_Na->value();
+    const unsigned int nb = ui->spinBox_Nb->value();
+    const float pas[3] = {14.5f * M_PI / 180.0f, 20.0f * M_PI / 180.0f, 25.0f * M_PI / 180.0f};
+    std::vector<pairKey> keys;
+    auto add = [&](unsigned int a, unsigned int b, float p, bool e){
+        if((int) a < ui->spinBox_Na->minimum() || (int) a > ui->spinBox_Na->maximum()) return;
+        if((int) b < ui->spinBox_Nb->minimum() || (int) b > ui->spinBox_Nb->maximum()) return;
+        gearDetail detail = bAnalytic ? gearDetail::coarse : gearDetail::fine;
+        const gearDetail wanted = detail;
+        if(!fitMemoryBudget(a, b, memoryBudget, 2, detail, budgetHeld(a, b, detail)) || detail != wanted) return; // wouldn't be used
+        keys.push_back(pairKey{a, b, p, e, detail});
+    };
+
+    for(bool e: {bExact, !bExact}){
+        add(na, nb, pa, e);
+        add(na + 1, nb, pa, e);
+        add(na - 1, nb, pa, e);
+        add(na, nb + 1, pa, e);
+        add(na, nb - 1, pa, e);
+        for(float p: pas) if(p != pa) add(na, nb, p, e);
+    }
+    precomputer->speculate(keys);
+}
 
 void Widget::drawOpenGL()
 {
     if(!bPause){
-        ui->myOGLWidget->update();
+        ui->myOGLWidget->requestFrame(dirtyRotation);
         ui->myOGLWidget->incRotate();
     }
 }
 
 void Widget::on_speedScrollBar_valueChanged(int value)
 {
+    recordAction(widgetAction::speed, value);
     float speed = (float) value * 0.25f;
     ui->myOGLWidget->setSpeed(speed);
 }
 
 void Widget::on_lightPosX_editingFinished()
 {
+    recordAction(widgetAction::lightX, ui->lightPosX->value());
     float x = (float) ui->lightPosX->value();
     ui->myOGLWidget->setLightX(x);
 }
 
 void Widget::on_lightPosY_editingFinished()
 {
+    recordAction(widgetAction::lightY, ui->lightPosY->value());
     float y = (float) ui->lightPosY->value();
     ui->myOGLWidget->setLightY(y);
 }
 
 void Widget::on_lightPosZ_editingFinished()
 {
+    recordAction(widgetAction::lightZ, ui->lightPosZ->value());
     float z = (float) ui->lightPosZ->value();
     ui->myOGLWidget->setLightZ(z);
 }
 
 void Widget::on_SeperationSpinBox_valueChanged(double x)
 {
+    recordAction(widgetAction::separation, x);
     ui->myOGLWidget->setSeperation((float) x);
-    if(bPause) ui->myOGLWidget->update();
+    checkInterference();
+    if(bPause) ui->myOGLWidget->requestFrame(dirtySeparation);
 }
 
 void Widget::on_aboutButton_clicked()
@@ -258,34 +599,33 @@ void Widget::on_instructionsButton_clicked()
                       "• Left button to roll<br/>"
                       "• Right button to rotate<br/>"
                       "• Shift &amp; left button to translate<br/>"
-                      "• Shift &amp; right button to zoom</span></p></body></html>";
+                      "• Shift &amp; right button to zoom<br/>"
+                      "• Ctrl &amp; left button to pick a tooth</span></p></body></html>";
     msgBox.setTextFormat(Qt::RichText);
     msgBox.setText(msg.c_str());
     msgBox.exec();
 }
 
+// both profiles are resident on the GPU, so this just swaps which one is drawn
 void Widget::on_toggleButton_clicked()
 {
-    if(bPause){
-        rebuildGears = true;
-        ui->pausePlayButton->setText("Rebuild");
-
-        if(bExact){
-            ui->toggleLabel->setText("<span style='font-size:10.5pt; font-weight:600;'>Circle Approximation</span>");
-            bExact = false;
-        }
-        else{
-            ui->toggleLabel->setText("<span style='font-size:10.5pt; font-weight:600;'>Exact Involute</span>");
-            bExact = true;
-        }
-        ui->myOGLWidget->setBExact(bExact);
-        rebuildGears = true;
-        ui->pausePlayButton->setText("Rebuild");
+    recordAction(widgetAction::toggle);
+    userActivity();
+    if(bExact){
+        ui->toggleLabel->setText("<span style='font-size:10.5pt; font-weight:600;'>Circle Approximation</span>");
+        bExact = false;
+    }
+    else{
+        ui->toggleLabel->setText("<span style='font-size:10.5pt; font-weight:600;'>Exact Involute</span>");
+        bExact = true;
     }
+    ui->myOGLWidget->setBExact(bExact);
+    checkInterference();
 }
 
 void Widget::on_fullScreenButton_clicked()
 {
+    recordAction(widgetAction::fullScreen);
     if(bFullScreen){
         parent->showNormal();
         return;
@@ -321,6 +661,7 @@ void Widget::on_fullScreenButton_clicked()
     ui->label_10->hide();
     ui->label_11->hide();
     ui->toggleLabel->hide();
+    ui->interferenceLabel->hide();
     //vScrollBar->hide();
     auto w = QDesktopWidget().screenGeometry().size().width();
     auto h = QDesktopWidget().screenGeometry().size().height();
@@ -330,7 +671,7 @@ void Widget::on_fullScreenButton_clicked()
     resize(w, h);
     ui->myOGLWidget->resize(w, h);
     bFullScreen = true;
-    ui->myOGLWidget->update();
+    ui->myOGLWidget->requestFrame(dirtyCamera);
 }
 
 void Widget::standardScreen()
@@ -363,11 +704,12 @@ void Widget::standardScreen()
     ui->label_10->show();
     ui->label_11->show();
     ui->toggleLabel->show();
+    ui->interferenceLabel->show();
     ui->myOGLWidget->resize(1200, 900);
     ui->myOGLWidget->move(180, 10);
     ui->myOGLWidget->setPerspective(4.0f / 3.0f);
     resize(wMem, hMem);
     bFullScreen = false;
     parent->setSliderPositions();
-    ui->myOGLWidget->update();
+    ui->myOGLWidget->requestFrame(dirtyCamera);
 }
@@ -8,13 +8,23 @@
 #include <QRadioButton>
 #include <QtMath>
 #include <QDesktopWidget>
+#include <string>
+#include <vector>
+#include "oglwidget.h"
+#include "eventlog.h"
 
 class Scroller;
+class Precomputer;
+class QLabel;
 
 namespace Ui {
 class Widget;
 }
 
+// the controls' changes, as written to an event log
+enum class widgetAction { pausePlay, pa14, pa20, pa25, teethA, teethB, speed, lightX, lightY, lightZ, separation,
+                          reset, toggle, fullScreen };
+
 class Widget : public QWidget
 {
     Q_OBJECT
@@ -22,6 +32,8 @@ class Widget : public QWidget
 public:
     explicit Widget(Scroller *iparent = 0);
     ~Widget();
+    void record(const std::string &fileName);
+    bool replay(const std::string &fileName, const std::string &timingsName); // false if the log can't be read
 
 private slots:
     void on_quitButton_clicked();
@@ -33,6 +45,8 @@ private slots:
     void on_radioButton_25_clicked();
     void on_spinBox_Na_editingFinished();
     void on_spinBox_Nb_editingFinished();
+    void on_spinBox_Na_valueChanged(int);
+    void on_spinBox_Nb_valueChanged(int);
     void on_speedScrollBar_valueChanged(int value);
     void on_lightPosX_editingFinished();
     void on_lightPosY_editingFinished();
@@ -45,17 +59,48 @@ private slots:
     void on_fullScreenButton_clicked();
     void standardScreen();
     void keySwitcher(int key);
+    void speculate();
+    void showFrameStats();
+    void replayStep();
 
 private:
     void speedChange(int);
+    void exportGears();
+    void userActivity();
+    void checkInterference();
+    void toggleFrameStats();
+    bool withinBudget(unsigned int na, unsigned int nb, gearDetail &detail); // detail is made coarse if only that fits
+    std::size_t budgetHeld(unsigned int na, unsigned int nb, gearDetail detail) const;
+    void recordAction(widgetAction action, double value = 0.0);
+    void replayAction(widgetAction action, double value);
 
     Ui::Widget *ui;
     std::unique_ptr<QTimer> timer;
+    std::unique_ptr<QTimer> idleTimer; // starts speculative gear builds while paused
+    std::unique_ptr<Precomputer> precomputer;
+    std::unique_ptr<QTimer> replayTimer; // single shot, each replayed frame queues the next
+    std::unique_ptr<QTimer> statsTimer; // refreshes the frame stats overlay once a second
+    std::unique_ptr<QLabel> statsLabel;
+    frameCounts lastCounts;
+    std::size_t memoryBudget = 0; // bytes, 0 for none
+    QString budgetNote; // why the meshes were made coarse
+    const int tickMs = 25; // the animation timer's interval, and a replay's virtual frame
+    eventLog inputLog;
+    std::string recordFile, timingsFile;
+    bool bInKey = false; // in keySwitcher()
+    double virtualMs = 0.0;
+    std::vector<double> replayMs; // paint time of each replayed frame
     bool bPause = false, bFullScreen = false;
     float pa = 20.0f * M_PI / 180.0f;
     unsigned int Na, Nb;
     bool rebuildGears = false, Nchange = false;
     bool bExact = true;
+    float helixDeg = 0.0f; // H steps it, spur then 15, 30 and 45 degree helical gears
+    bool bAnalytic = false; // N toggles coarse meshes shaded with the analytic flank normals
+    bool bRaymarch = false; // S toggles raymarching the gears' distance fields, no meshes
+    bool bOutline = false; // O draws the triangles' edges over the meshes
+    bool bFeedback = false; // C feeds the outline pass from a transform feedback capture
+    bool bContact = false; // G colours the flanks by where they've touched the other gear
     int wMem, hMem; // remember parameters for exiting full screen
     int wMax, hMax; // screen size
     Scroller *parent;